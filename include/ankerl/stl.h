@@ -29,7 +29,9 @@
 #ifndef ANKERL_STL_H
 #define ANKERL_STL_H
 
+#include <algorithm>        // for min, max
 #include <array>            // for array
+#include <cstddef>          // for byte, ptrdiff_t
 #include <cstdint>          // for uint64_t, uint32_t, std::uint8_t, UINT64_C
 #include <cstring>          // for size_t, memcpy, memset
 #include <functional>       // for equal_to, hash
@@ -37,7 +39,9 @@
 #include <iterator>         // for pair, distance
 #include <limits>           // for numeric_limits
 #include <memory>           // for allocator, allocator_traits, shared_ptr
+#include <new>              // for placement new
 #include <optional>         // for optional
+#include <random>           // for random_device
 #include <stdexcept>        // for out_of_range
 #include <string>           // for basic_string
 #include <string_view>      // for basic_string_view, hash
@@ -46,6 +50,21 @@
 #include <utility>          // for forward, exchange, pair, as_const, piece...
 #include <vector>           // for vector
 
+#if defined(__has_include) && (__cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L))
+#    if __has_include(<span>)
+#        include <span> // for span
+#    endif
+#endif
+
+#if defined(ANKERL_UNORDERED_DENSE_STATS) && ANKERL_UNORDERED_DENSE_STATS
+#    include <chrono> // for steady_clock, nanoseconds
+#endif
+
+#if defined(ANKERL_UNORDERED_DENSE_HASH_CHECK) && ANKERL_UNORDERED_DENSE_HASH_CHECK
+#    include <atomic> // for atomic
+#    include <cstdio> // for fprintf, stderr
+#endif
+
 // <memory_resource> includes <mutex>, which fails to compile if
 // targeting GCC >= 13 with the (rewritten) win32 thread model, and
 // targeting Windows earlier than Vista (0x600).  GCC predefines
@@ -36,13 +36,40 @@
 
 // API versioning with inline namespace, see https://www.foonathan.net/2018/11/inline-namespaces/
 
+// Compile time opt-in for per table operation counters and a rehash callback.
+#if !defined(ANKERL_UNORDERED_DENSE_STATS)
 // NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
-#define ANKERL_UNORDERED_DENSE_VERSION_CONCAT1(major, minor, patch) v##major##_##minor##_##patch
+#    define ANKERL_UNORDERED_DENSE_STATS 0
+#endif
+
+// Compile time opt-in for the detection of bad hashes, see check_hash_quality().
+#if !defined(ANKERL_UNORDERED_DENSE_HASH_CHECK)
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#    define ANKERL_UNORDERED_DENSE_HASH_CHECK 0
+#endif
+
+// Both options change the table, so they also change the inline namespace. That way translation units compiled with
+// different options can be linked together without ODR violations.
+#if ANKERL_UNORDERED_DENSE_STATS && ANKERL_UNORDERED_DENSE_HASH_CHECK
+#    define ANKERL_UNORDERED_DENSE_NAMESPACE_SUFFIX _stats_hash_check // NOLINT(cppcoreguidelines-macro-usage)
+#elif ANKERL_UNORDERED_DENSE_STATS
+#    define ANKERL_UNORDERED_DENSE_NAMESPACE_SUFFIX _stats // NOLINT(cppcoreguidelines-macro-usage)
+#elif ANKERL_UNORDERED_DENSE_HASH_CHECK
+#    define ANKERL_UNORDERED_DENSE_NAMESPACE_SUFFIX _hash_check // NOLINT(cppcoreguidelines-macro-usage)
+#else
+#    define ANKERL_UNORDERED_DENSE_NAMESPACE_SUFFIX // NOLINT(cppcoreguidelines-macro-usage)
+#endif
+
 // NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
-#define ANKERL_UNORDERED_DENSE_VERSION_CONCAT(major, minor, patch) ANKERL_UNORDERED_DENSE_VERSION_CONCAT1(major, minor, patch)
-#define ANKERL_UNORDERED_DENSE_NAMESPACE   \
-    ANKERL_UNORDERED_DENSE_VERSION_CONCAT( \
-        ANKERL_UNORDERED_DENSE_VERSION_MAJOR, ANKERL_UNORDERED_DENSE_VERSION_MINOR, ANKERL_UNORDERED_DENSE_VERSION_PATCH)
+#define ANKERL_UNORDERED_DENSE_VERSION_CONCAT1(major, minor, patch, suffix) v##major##_##minor##_##patch##suffix
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#define ANKERL_UNORDERED_DENSE_VERSION_CONCAT(major, minor, patch, suffix) \
+    ANKERL_UNORDERED_DENSE_VERSION_CONCAT1(major, minor, patch, suffix)
+#define ANKERL_UNORDERED_DENSE_NAMESPACE                                                                     \
+    ANKERL_UNORDERED_DENSE_VERSION_CONCAT(ANKERL_UNORDERED_DENSE_VERSION_MAJOR,                              \
+                                          ANKERL_UNORDERED_DENSE_VERSION_MINOR,                              \
+                                          ANKERL_UNORDERED_DENSE_VERSION_PATCH,                              \
+                                          ANKERL_UNORDERED_DENSE_NAMESPACE_SUFFIX)
 
 #if defined(_MSVC_LANG)
 #    define ANKERL_UNORDERED_DENSE_CPP_VERSION _MSVC_LANG
@@ -113,6 +140,59 @@
 
 #    endif
 
+#    if ANKERL_UNORDERED_DENSE_CPP_VERSION >= 202002L && defined(__cpp_lib_span)
+#        define ANKERL_UNORDERED_DENSE_HAS_SPAN() 1 // NOLINT(cppcoreguidelines-macro-usage)
+#    else
+#        define ANKERL_UNORDERED_DENSE_HAS_SPAN() 0 // NOLINT(cppcoreguidelines-macro-usage)
+#    endif
+
+// AES-NI is detected at runtime, so only the functions that use it are compiled for the instruction set. Define
+// ANKERL_UNORDERED_DENSE_DISABLE_SIMD to leave out the AES and AVX code paths, and with them the intrinsics headers.
+#    if (defined(__x86_64__) || defined(_M_X64)) && !defined(ANKERL_UNORDERED_DENSE_DISABLE_SIMD)
+#        define ANKERL_UNORDERED_DENSE_HAS_AES_IMPL() 1 // NOLINT(cppcoreguidelines-macro-usage)
+#        if defined(__GNUC__) || defined(__clang__)
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#            define ANKERL_UNORDERED_DENSE_TARGET_AES __attribute__((target("aes,sse2")))
+#        else
+#            define ANKERL_UNORDERED_DENSE_TARGET_AES // NOLINT(cppcoreguidelines-macro-usage)
+#        endif
+#    else
+#        define ANKERL_UNORDERED_DENSE_HAS_AES_IMPL() 0 // NOLINT(cppcoreguidelines-macro-usage)
+#    endif
+
+// Same for AVX2 and AVX-512, used by hash_many.
+#    if (defined(__x86_64__) || defined(_M_X64)) && !defined(ANKERL_UNORDERED_DENSE_DISABLE_SIMD)
+#        define ANKERL_UNORDERED_DENSE_HAS_SIMD_IMPL() 1 // NOLINT(cppcoreguidelines-macro-usage)
+#        if defined(__GNUC__) || defined(__clang__)
+#            define ANKERL_UNORDERED_DENSE_TARGET_AVX2 __attribute__((target("avx2"))) // NOLINT(cppcoreguidelines-macro-usage)
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#            define ANKERL_UNORDERED_DENSE_TARGET_AVX512 __attribute__((target("avx512f")))
+#        else
+#            define ANKERL_UNORDERED_DENSE_TARGET_AVX2   // NOLINT(cppcoreguidelines-macro-usage)
+#            define ANKERL_UNORDERED_DENSE_TARGET_AVX512 // NOLINT(cppcoreguidelines-macro-usage)
+#        endif
+#    else
+#        define ANKERL_UNORDERED_DENSE_HAS_SIMD_IMPL() 0 // NOLINT(cppcoreguidelines-macro-usage)
+#    endif
+
+// Not in stl.h, because only these code paths need them, and because import std doesn't provide them.
+#    if ANKERL_UNORDERED_DENSE_HAS_SIMD_IMPL() || ANKERL_UNORDERED_DENSE_HAS_AES_IMPL()
+#        include <immintrin.h> // for _mm_aesenc_si128, _mm256_mul_epu32, _mm512_mul_epu32
+#    endif
+
+#    if ANKERL_UNORDERED_DENSE_STATS
+#        define ANKERL_UNORDERED_DENSE_STATS_ADD(counter, n) (m_stats.counter += (n)) // NOLINT(cppcoreguidelines-macro-usage)
+#    else
+#        define ANKERL_UNORDERED_DENSE_STATS_ADD(counter, n) static_cast<void>(0) // NOLINT(cppcoreguidelines-macro-usage)
+#    endif
+
+// Called with a poor_hash_report const& when ANKERL_UNORDERED_DENSE_HASH_CHECK detects a bad hash. Define this before
+// including the header to e.g. assert or throw instead of the default, which prints a warning to stderr.
+#    if ANKERL_UNORDERED_DENSE_HASH_CHECK && !defined(ANKERL_UNORDERED_DENSE_ON_POOR_HASH)
+#        define ANKERL_UNORDERED_DENSE_ON_POOR_HASH(report) \
+            ::ankerl::unordered_dense::detail::on_poor_hash(report) // NOLINT(cppcoreguidelines-macro-usage)
+#    endif
+
 namespace ankerl::unordered_dense {
 inline namespace ANKERL_UNORDERED_DENSE_NAMESPACE {
 
@@ -131,6 +211,12 @@ namespace detail {
 [[noreturn]] inline ANKERL_UNORDERED_DENSE_NOINLINE void on_error_too_many_elements() {
     throw std::out_of_range("ankerl::unordered_dense::map::replace(): too many elements");
 }
+[[noreturn]] inline ANKERL_UNORDERED_DENSE_NOINLINE void on_error_invalid_static_map() {
+    throw std::invalid_argument("ankerl::unordered_dense::static_map: wrong number of elements or duplicate key");
+}
+[[noreturn]] inline ANKERL_UNORDERED_DENSE_NOINLINE void on_error_index_out_of_range() {
+    throw std::out_of_range("ankerl::unordered_dense::map::at_index(): index out of range");
+}
 
 #    else
 
@@ -143,6 +229,12 @@ namespace detail {
 [[noreturn]] inline void on_error_too_many_elements() {
     abort();
 }
+[[noreturn]] inline void on_error_invalid_static_map() {
+    abort();
+}
+[[noreturn]] inline void on_error_index_out_of_range() {
+    abort();
+}
 
 #    endif
 
@@ -150,20 +242,55 @@ namespace detail {
 
 // hash ///////////////////////////////////////////////////////////////////////
 
+namespace detail {
+
+// Used to switch between a fast runtime implementation and a constexpr-friendly one. When there is no way to find out,
+// always use the constexpr-friendly implementation.
+[[nodiscard]] constexpr auto is_constant_evaluated() noexcept -> bool {
+#    if defined(__cpp_lib_is_constant_evaluated)
+    return std::is_constant_evaluated();
+#    elif defined(__GNUC__) && __GNUC__ >= 9
+    return __builtin_is_constant_evaluated();
+#    elif defined(__clang__) && __clang_major__ >= 9
+    return __builtin_is_constant_evaluated();
+#    elif defined(_MSC_VER) && _MSC_VER >= 1925
+    return __builtin_is_constant_evaluated();
+#    else
+    return true;
+#    endif
+}
+
+} // namespace detail
+
 // This is a stripped-down implementation of wyhash: https://github.com/wangyi-fudan/wyhash
-// No big-endian support (because different values on different machines don't matter),
-// hardcodes seed and the secret, reformats the code, and clang-tidy fixes.
+// Hardcodes seed and the secret, reformats the code, and clang-tidy fixes. Data is always read as little endian, so the
+// same value is produced at compile time and at runtime.
 namespace detail::wyhash {
 
-inline void mum(std::uint64_t* a, std::uint64_t* b) {
+inline constexpr auto secret = std::array{UINT64_C(0xa0761d6478bd642f),
+                                          UINT64_C(0xe7037ed1a0b428db),
+                                          UINT64_C(0x8ebc6af09c88c6e3),
+                                          UINT64_C(0x589965cc75374cc3)};
+
+#    if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+inline constexpr bool is_little_endian = false;
+#    else
+inline constexpr bool is_little_endian = true;
+#    endif
+
+constexpr void mum(std::uint64_t* a, std::uint64_t* b) {
 #    if defined(__SIZEOF_INT128__)
     __uint128_t r = *a;
     r *= *b;
     *a = static_cast<std::uint64_t>(r);
     *b = static_cast<std::uint64_t>(r >> 64U);
-#    elif defined(_MSC_VER) && defined(_M_X64)
-    *a = _umul128(*a, *b, b);
 #    else
+#        if defined(_MSC_VER) && defined(_M_X64)
+    if (!detail::is_constant_evaluated()) {
+        *a = _umul128(*a, *b, b);
+        return;
+    }
+#        endif
     std::uint64_t ha = *a >> 32U;
     std::uint64_t hb = *b >> 32U;
     std::uint64_t la = static_cast<std::uint32_t>(*a);
@@ -185,36 +312,68 @@ inline void mum(std::uint64_t* a, std::uint64_t* b) {
 }
 
 // multiply and xor mix function, aka MUM
-[[nodiscard]] inline auto mix(std::uint64_t a, std::uint64_t b) -> std::uint64_t {
+[[nodiscard]] constexpr auto mix(std::uint64_t a, std::uint64_t b) -> std::uint64_t {
     mum(&a, &b);
     return a ^ b;
 }
 
-// read functions. WARNING: we don't care about endianness, so results are different on big endian!
-[[nodiscard]] inline auto r8(const std::uint8_t* p) -> std::uint64_t {
-    std::uint64_t v{};
-    std::memcpy(&v, p, 8U);
-    return v;
+// Types that can be read bytewise in a constant expression, e.g. the CharT of a std::basic_string_view.
+template <typename CharT>
+constexpr bool is_byte_readable_v = std::is_integral_v<CharT> && !std::is_same_v<CharT, bool>;
+
+// Reads byte number idx, counted from p. For wider character types the bytes are taken in little endian order.
+template <typename CharT>
+[[nodiscard]] constexpr auto rbyte(CharT const* p, std::size_t idx) -> std::uint64_t {
+    if constexpr (sizeof(CharT) == 1) {
+        return static_cast<std::uint8_t>(p[idx]);
+    } else {
+        auto const c = static_cast<std::make_unsigned_t<CharT>>(p[idx / sizeof(CharT)]);
+        return static_cast<std::uint8_t>(c >> (8U * (idx % sizeof(CharT))));
+    }
 }
 
-[[nodiscard]] inline auto r4(const std::uint8_t* p) -> std::uint64_t {
-    std::uint32_t v{};
-    std::memcpy(&v, p, 4);
+// Reads num_bytes little endian bytes starting at byte number idx. This is the constexpr-friendly way.
+template <typename CharT>
+[[nodiscard]] constexpr auto rn(CharT const* p, std::size_t idx, std::size_t num_bytes) -> std::uint64_t {
+    auto v = std::uint64_t{};
+    for (std::size_t i = 0; i < num_bytes; ++i) {
+        v |= rbyte(p, idx + i) << (8U * i);
+    }
     return v;
 }
 
-// reads 1, 2, or 3 bytes
-[[nodiscard]] inline auto r3(const std::uint8_t* p, std::size_t k) -> std::uint64_t {
-    return (static_cast<std::uint64_t>(p[0]) << 16U) | (static_cast<std::uint64_t>(p[k >> 1U]) << 8U) | p[k - 1];
+// read functions. Use memcpy whenever possible, because that's by far the fastest.
+template <typename CharT>
+[[nodiscard]] constexpr auto r8(CharT const* p, std::size_t idx) -> std::uint64_t {
+    if (is_little_endian && !detail::is_constant_evaluated()) {
+        std::uint64_t v{};
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        std::memcpy(&v, reinterpret_cast<std::uint8_t const*>(p) + idx, 8U);
+        return v;
+    }
+    return rn(p, idx, 8U);
 }
 
-[[maybe_unused]] [[nodiscard]] inline auto hash(void const* key, std::size_t len) -> std::uint64_t {
-    static constexpr auto secret = std::array{UINT64_C(0xa0761d6478bd642f),
-                                              UINT64_C(0xe7037ed1a0b428db),
-                                              UINT64_C(0x8ebc6af09c88c6e3),
-                                              UINT64_C(0x589965cc75374cc3)};
+template <typename CharT>
+[[nodiscard]] constexpr auto r4(CharT const* p, std::size_t idx) -> std::uint64_t {
+    if (is_little_endian && !detail::is_constant_evaluated()) {
+        std::uint32_t v{};
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        std::memcpy(&v, reinterpret_cast<std::uint8_t const*>(p) + idx, 4U);
+        return v;
+    }
+    return rn(p, idx, 4U);
+}
+
+// reads 1, 2, or 3 bytes
+template <typename CharT>
+[[nodiscard]] constexpr auto r3(CharT const* p, std::size_t k) -> std::uint64_t {
+    return (rbyte(p, 0) << 16U) | (rbyte(p, k >> 1U) << 8U) | rbyte(p, k - 1);
+}
 
-    auto const* p = static_cast<std::uint8_t const*>(key);
+// Hashes len bytes, starting at p.
+template <typename CharT>
+[[nodiscard]] constexpr auto hash_bytes(CharT const* p, std::size_t len) -> std::uint64_t {
     std::uint64_t seed = secret[0];
     std::uint64_t a{};
     std::uint64_t b{};
@@ -222,8 +381,8 @@ inline void mum(std::uint64_t* a, std::uint64_t* b) {
         ANKERL_UNORDERED_DENSE_LIKELY_ATTR {
             if (ANKERL_UNORDERED_DENSE_LIKELY(len >= 4))
                 ANKERL_UNORDERED_DENSE_LIKELY_ATTR {
-                    a = (r4(p) << 32U) | r4(p + ((len >> 3U) << 2U));
-                    b = (r4(p + len - 4) << 32U) | r4(p + len - 4 - ((len >> 3U) << 2U));
+                    a = (r4(p, 0) << 32U) | r4(p, (len >> 3U) << 2U);
+                    b = (r4(p, len - 4) << 32U) | r4(p, len - 4 - ((len >> 3U) << 2U));
                 }
             else if (ANKERL_UNORDERED_DENSE_LIKELY(len > 0))
                 ANKERL_UNORDERED_DENSE_LIKELY_ATTR {
@@ -237,38 +396,224 @@ inline void mum(std::uint64_t* a, std::uint64_t* b) {
         }
     else {
         std::size_t i = len;
+        std::size_t idx = 0;
         if (ANKERL_UNORDERED_DENSE_UNLIKELY(i > 48))
             ANKERL_UNORDERED_DENSE_UNLIKELY_ATTR {
                 std::uint64_t see1 = seed;
                 std::uint64_t see2 = seed;
                 do {
-                    seed = mix(r8(p) ^ secret[1], r8(p + 8) ^ seed);
-                    see1 = mix(r8(p + 16) ^ secret[2], r8(p + 24) ^ see1);
-                    see2 = mix(r8(p + 32) ^ secret[3], r8(p + 40) ^ see2);
-                    p += 48;
+                    seed = mix(r8(p, idx) ^ secret[1], r8(p, idx + 8) ^ seed);
+                    see1 = mix(r8(p, idx + 16) ^ secret[2], r8(p, idx + 24) ^ see1);
+                    see2 = mix(r8(p, idx + 32) ^ secret[3], r8(p, idx + 40) ^ see2);
+                    idx += 48;
                     i -= 48;
                 } while (ANKERL_UNORDERED_DENSE_LIKELY(i > 48));
                 seed ^= see1 ^ see2;
             }
         while (ANKERL_UNORDERED_DENSE_UNLIKELY(i > 16))
             ANKERL_UNORDERED_DENSE_UNLIKELY_ATTR {
-                seed = mix(r8(p) ^ secret[1], r8(p + 8) ^ seed);
+                seed = mix(r8(p, idx) ^ secret[1], r8(p, idx + 8) ^ seed);
                 i -= 16;
-                p += 16;
+                idx += 16;
             }
-        a = r8(p + i - 16);
-        b = r8(p + i - 8);
+        a = r8(p, idx + i - 16);
+        b = r8(p, idx + i - 8);
     }
 
     return mix(secret[1] ^ len, mix(a ^ secret[1], b ^ seed));
 }
 
-[[nodiscard]] inline auto hash(std::uint64_t x) -> std::uint64_t {
+[[maybe_unused]] [[nodiscard]] inline auto hash(void const* key, std::size_t len) -> std::uint64_t {
+    return hash_bytes(static_cast<std::uint8_t const*>(key), len);
+}
+
+// Same as above, but usable in a constant expression. len is in bytes.
+template <typename CharT, std::enable_if_t<is_byte_readable_v<CharT>, bool> = true>
+[[nodiscard]] constexpr auto hash(CharT const* key, std::size_t len) -> std::uint64_t {
+    return hash_bytes(key, len);
+}
+
+[[nodiscard]] constexpr auto hash(std::uint64_t x) -> std::uint64_t {
     return detail::wyhash::mix(x, UINT64_C(0x9E3779B97F4A7C15));
 }
 
 } // namespace detail::wyhash
 
+namespace detail {
+
+struct nonesuch {};
+struct default_container_t {};
+
+template <class Default, class AlwaysVoid, template <class...> class Op, class... Args>
+struct detector {
+    using value_t = std::false_type;
+    using type = Default;
+};
+
+template <class Default, template <class...> class Op, class... Args>
+struct detector<Default, std::void_t<Op<Args...>>, Op, Args...> {
+    using value_t = std::true_type;
+    using type = Op<Args...>;
+};
+
+template <template <class...> class Op, class... Args>
+using is_detected = typename detail::detector<detail::nonesuch, void, Op, Args...>::value_t;
+
+template <template <class...> class Op, class... Args>
+constexpr bool is_detected_v = is_detected<Op, Args...>::value;
+
+template <typename T>
+using detect_avalanching = typename T::is_avalanching;
+
+template <typename T>
+using detect_is_transparent = typename T::is_transparent;
+
+template <typename T>
+using detect_seeded = typename T::is_seeded;
+
+template <typename T>
+using detect_iterator = typename T::iterator;
+
+template <typename T>
+using detect_reserve = decltype(std::declval<T&>().reserve(std::size_t{}));
+
+template <typename T>
+using detect_data = decltype(std::declval<T const&>().data());
+
+template <typename T>
+using detect_size = decltype(std::declval<T const&>().size());
+
+// Ranges with data() and size(), e.g. std::vector, std::array, std::span.
+template <typename Range, typename T, typename Enable = void>
+struct is_contiguous_range_of : std::false_type {};
+
+template <typename Range, typename T>
+struct is_contiguous_range_of<Range, T, std::void_t<detect_data<Range>, detect_size<Range>>>
+    : std::is_same<std::remove_cv_t<std::remove_pointer_t<detect_data<Range>>>, T> {};
+
+template <typename Range, typename T>
+constexpr bool is_contiguous_range_of_v = is_contiguous_range_of<Range, T>::value;
+
+template <typename T>
+constexpr bool is_contiguous_range_v = is_detected_v<detect_data, T> && is_detected_v<detect_size, T>;
+
+template <typename T>
+using detect_is_bytewise_hashable = typename T::is_bytewise_hashable;
+
+template <typename T>
+using detect_arrow = decltype(std::declval<T const&>().operator->());
+
+template <typename T>
+struct is_reference_wrapper : std::false_type {};
+
+template <typename T>
+struct is_reference_wrapper<std::reference_wrapper<T>> : std::true_type {};
+
+} // namespace detail
+
+// Opt-in for hashing a struct by its bytes, see hash<T>. Either add `using is_bytewise_hashable = void;` to the struct, or
+// specialize this for it. Only opt in when two objects are equal exactly when their bytes are equal: operator== has to
+// compare all the members and nothing else, and no member may refer to something that is compared by value.
+template <typename T, typename Enable = void>
+struct is_bytewise_hashable : std::bool_constant<detail::is_detected_v<detail::detect_is_bytewise_hashable, T>> {};
+
+namespace detail {
+
+// Structs without padding that opted in. Never wrappers that refer to another object like std::reference_wrapper, smart
+// pointers, or views like std::span, because equal objects can be stored at different addresses. Ranges like std::array
+// are hashed by their elements instead.
+template <typename T>
+constexpr bool is_bytewise_hashable_v = std::is_class_v<T> && std::has_unique_object_representations_v<T> &&
+                                        is_bytewise_hashable<T>::value && !is_reference_wrapper<T>::value &&
+                                        !is_detected_v<detect_arrow, T> && !is_contiguous_range_v<T>;
+
+} // namespace detail
+
+// Incrementally hashes data that arrives in pieces. The result is exactly the same as hashing the concatenated bytes with
+// ankerl::unordered_dense::hash<std::string_view>, so e.g. a key made of several parts can be looked up in a map of
+// std::string without creating the string first.
+class streaming_hash {
+    static constexpr std::size_t block_size = 48;
+    static constexpr std::size_t history_size = 16;
+
+    // The last 16 bytes of the data are always needed at the end, and they might already have been processed. So the buffer
+    // keeps them in front of the pending bytes.
+    std::array<std::uint8_t, history_size + block_size> m_buf{};
+    std::size_t m_num_pending = 0;
+    std::size_t m_len = 0;
+    std::uint64_t m_seed = detail::wyhash::secret[0];
+    std::uint64_t m_see1 = detail::wyhash::secret[0];
+    std::uint64_t m_see2 = detail::wyhash::secret[0];
+
+    void process_block() noexcept {
+        using namespace detail::wyhash;
+        auto const* p = m_buf.data() + history_size;
+        m_seed = mix(r8(p, 0) ^ secret[1], r8(p, 8) ^ m_seed);
+        m_see1 = mix(r8(p, 16) ^ secret[2], r8(p, 24) ^ m_see1);
+        m_see2 = mix(r8(p, 32) ^ secret[3], r8(p, 40) ^ m_see2);
+        std::memcpy(m_buf.data(), p + block_size - history_size, history_size);
+        m_num_pending = 0;
+    }
+
+public:
+    // Appends len bytes starting at data.
+    void update(void const* data, std::size_t len) noexcept {
+        auto const* p = static_cast<std::uint8_t const*>(data);
+        m_len += len;
+        while (len > 0) {
+            // A full block is only processed once we know more data follows, same as wyhash does.
+            if (m_num_pending == block_size) {
+                process_block();
+            }
+            auto const n = (std::min)(len, block_size - m_num_pending);
+            std::memcpy(m_buf.data() + history_size + m_num_pending, p, n);
+            m_num_pending += n;
+            p += n;
+            len -= n;
+        }
+    }
+
+    template <typename CharT>
+    void update(std::basic_string_view<CharT> sv) noexcept {
+        update(sv.data(), sizeof(CharT) * sv.size());
+    }
+
+    // Appends the object's bytes, e.g. for integers.
+    template <typename T, typename std::enable_if_t<std::has_unique_object_representations_v<T>, bool> = true>
+    void update_value(T const& obj) noexcept {
+        update(&obj, sizeof(T));
+    }
+
+    // Hash of all the bytes so far. More data can be added afterwards.
+    [[nodiscard]] auto finish() const noexcept -> std::uint64_t {
+        using namespace detail::wyhash;
+        auto const* p = m_buf.data() + history_size;
+        std::uint64_t seed = m_seed;
+        std::uint64_t a{};
+        std::uint64_t b{};
+        if (m_len <= 16) {
+            if (m_len >= 4) {
+                a = (r4(p, 0) << 32U) | r4(p, (m_len >> 3U) << 2U);
+                b = (r4(p, m_len - 4) << 32U) | r4(p, m_len - 4 - ((m_len >> 3U) << 2U));
+            } else if (m_len > 0) {
+                a = r3(p, m_len);
+            }
+        } else {
+            seed ^= m_see1 ^ m_see2;
+            std::size_t i = m_num_pending;
+            std::size_t idx = history_size;
+            while (i > 16) {
+                seed = mix(r8(m_buf.data(), idx) ^ secret[1], r8(m_buf.data(), idx + 8) ^ seed);
+                i -= 16;
+                idx += 16;
+            }
+            a = r8(m_buf.data(), idx + i - 16);
+            b = r8(m_buf.data(), idx + i - 8);
+        }
+        return mix(secret[1] ^ m_len, mix(a ^ secret[1], b ^ seed));
+    }
+};
+
 template <typename T, typename Enable = void>
 struct hash {
     auto operator()(T const& obj) const noexcept(noexcept(std::declval<std::hash<T>>().operator()(std::declval<T const&>())))
@@ -297,7 +642,7 @@ struct hash<std::basic_string<CharT>> {
 template <typename CharT>
 struct hash<std::basic_string_view<CharT>> {
     using is_avalanching = void;
-    auto operator()(std::basic_string_view<CharT> const& sv) const noexcept -> std::uint64_t {
+    constexpr auto operator()(std::basic_string_view<CharT> const& sv) const noexcept -> std::uint64_t {
         return detail::wyhash::hash(sv.data(), sizeof(CharT) * sv.size());
     }
 };
@@ -332,77 +677,336 @@ struct hash<std::shared_ptr<T>> {
 template <typename Enum>
 struct hash<Enum, typename std::enable_if_t<std::is_enum_v<Enum>>> {
     using is_avalanching = void;
-    auto operator()(Enum e) const noexcept -> std::uint64_t {
+    constexpr auto operator()(Enum e) const noexcept -> std::uint64_t {
         using underlying = std::underlying_type_t<Enum>;
         return detail::wyhash::hash(static_cast<underlying>(e));
     }
 };
 
-template <typename... Args>
-struct tuple_hash_helper {
-    // Converts the value into 64bit. If it is an integral type, just cast it. Mixing is doing the rest.
-    // If it isn't an integral we need to hash it.
-    template <typename Arg>
-    [[nodiscard]] constexpr static auto to64(Arg const& arg) -> std::uint64_t {
-        if constexpr (std::is_integral_v<Arg> || std::is_enum_v<Arg>) {
-            return static_cast<std::uint64_t>(arg);
+// Hashes the object representation in a single pass, for plain structs that opted in with is_bytewise_hashable.
+template <typename T>
+struct hash<T, typename std::enable_if_t<detail::is_bytewise_hashable_v<T>>> {
+    using is_avalanching = void;
+    auto operator()(T const& obj) const noexcept -> std::uint64_t {
+        return detail::wyhash::hash(&obj, sizeof(T));
+    }
+};
+
+#    if defined(__SIZEOF_INT128__)
+namespace detail {
+__extension__ using int128_t = __int128;           // NOLINT(google-runtime-int)
+__extension__ using uint128_t = unsigned __int128; // NOLINT(google-runtime-int)
+} // namespace detail
+
+template <>
+struct hash<detail::int128_t> {
+    using is_avalanching = void;
+    auto operator()(detail::int128_t const& obj) const noexcept -> std::uint64_t {
+        return detail::wyhash::hash(&obj, sizeof(obj));
+    }
+};
+
+template <>
+struct hash<detail::uint128_t> {
+    using is_avalanching = void;
+    auto operator()(detail::uint128_t const& obj) const noexcept -> std::uint64_t {
+        return detail::wyhash::hash(&obj, sizeof(obj));
+    }
+};
+#    endif
+
+template <typename T>
+struct hash<std::optional<T>> {
+    using is_avalanching = void;
+    auto operator()(std::optional<T> const& opt) const noexcept(noexcept(hash<T>{}(std::declval<T const&>())))
+        -> std::uint64_t {
+        if (!opt) {
+            return UINT64_C(0x6b0a1e7e3c0e2b1d);
+        }
+        if constexpr (detail::is_detected_v<detail::detect_avalanching, hash<T>>) {
+            return hash<T>{}(*opt);
         } else {
-            return hash<Arg>{}(arg);
+            return detail::wyhash::hash(static_cast<std::uint64_t>(hash<T>{}(*opt)));
         }
     }
+};
 
-    [[nodiscard]] ANKERL_UNORDERED_DENSE_DISABLE_UBSAN_UNSIGNED_INTEGER_CHECK static auto mix64(std::uint64_t state,
-                                                                                                std::uint64_t v)
-        -> std::uint64_t {
-        return detail::wyhash::mix(state + v, std::uint64_t{0x9ddfea08eb382d69});
+namespace detail {
+
+// Members that can be copied into the hash buffer as they are. Everything else is hashed and its 64bit hash is copied.
+// Structs only when they opted in with is_bytewise_hashable, otherwise their operator== might not be bytewise.
+template <typename T>
+constexpr bool is_packable_v =
+    std::has_unique_object_representations_v<T> &&
+    (std::is_integral_v<T> || std::is_enum_v<T> || std::is_pointer_v<T> || is_bytewise_hashable_v<T>);
+
+template <typename T>
+constexpr std::size_t packed_size_v = is_packable_v<T> ? sizeof(T) : sizeof(std::uint64_t);
+
+template <typename T>
+struct is_string_like : std::false_type {};
+
+template <typename CharT>
+struct is_string_like<std::basic_string<CharT>> : std::true_type {
+    using view_type = std::basic_string_view<CharT>;
+};
+
+template <typename CharT>
+struct is_string_like<std::basic_string_view<CharT>> : std::true_type {
+    using view_type = std::basic_string_view<CharT>;
+};
+
+// Hash used for an element of type T. Strings are hashed through their string_view, which gives the same hash and also
+// accepts anything convertible to it.
+template <typename T, typename Enable = void>
+struct element_hash {
+    using type = hash<T>;
+};
+
+template <typename T>
+struct element_hash<T, std::enable_if_t<is_string_like<T>::value>> {
+    using type = hash<typename is_string_like<T>::view_type>;
+};
+
+// Whether an element of type Arg can be used for lookup of an element of type T, because it gives the same hash.
+template <typename T, typename Arg, typename Enable = void>
+struct is_hash_compatible : std::is_same<T, Arg> {};
+
+template <typename T, typename Arg>
+struct is_hash_compatible<T, Arg, std::enable_if_t<is_string_like<T>::value>>
+    : std::is_convertible<Arg const&, typename is_string_like<T>::view_type> {};
+
+// Whether each element of the pair or tuple Arg is compatible with the element of the pair or tuple T.
+template <typename T, typename Arg, typename Enable = void>
+struct is_tuple_hash_compatible : std::false_type {};
+
+template <typename T, typename Arg, std::size_t... Idx>
+constexpr auto tuple_elements_compatible(std::index_sequence<Idx...> /*unused*/) -> bool {
+    return (is_hash_compatible<std::tuple_element_t<Idx, T>, std::tuple_element_t<Idx, Arg>>::value && ...);
+}
+
+template <typename T, typename Arg>
+struct is_tuple_hash_compatible<T, Arg, std::enable_if_t<std::tuple_size<Arg>::value == std::tuple_size<T>::value>>
+    : std::bool_constant<tuple_elements_compatible<T, Arg>(std::make_index_sequence<std::tuple_size<T>::value>{})> {};
+
+// Writes the argument at byte offset `offset` into the words, laid out as if it had type T. Small arguments are or'ed into
+// whole words, because writing single bytes and then reading them as words stalls the CPU (failed store forwarding).
+template <typename T, typename Arg, std::size_t N>
+void pack(std::array<std::uint64_t, N>& words, std::size_t offset, Arg const& arg) noexcept {
+    static_assert(is_hash_compatible<T, Arg>::value);
+    if constexpr (packed_size_v<T> <= sizeof(std::uint64_t)) {
+        auto v = std::uint64_t{};
+        if constexpr (is_packable_v<T>) {
+            std::memcpy(&v, &arg, sizeof(T));
+        } else {
+            v = static_cast<std::uint64_t>(typename element_hash<T>::type{}(arg));
+        }
+        auto const shift = 8U * (offset % 8U);
+        words[offset / 8U] |= v << shift;
+        if (shift != 0U && shift + 8U * packed_size_v<T> > 64U) {
+            words[offset / 8U + 1U] |= v >> (64U - shift);
+        }
+    } else {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        std::memcpy(reinterpret_cast<std::uint8_t*>(words.data()) + offset, &arg, sizeof(T));
     }
+}
+
+// Packs all the data from each argument into a buffer. If possible the data is copied directly. If not, we hash the object
+// and use this for the buffer. Size of the buffer is known at compile time, so filling the buffer is highly efficient.
+// Finally, hash the buffer once. Up to 16 bytes this is the last step of wyhash directly on the words, which saves wyhash's
+// overlapping reads.
+// The arguments are hashed as if they had the types Ts, see is_hash_compatible.
+template <typename... Ts, typename... Args>
+[[nodiscard]] auto hash_packed_as(Args const&... args) noexcept -> std::uint64_t {
+    constexpr auto num_bytes = (packed_size_v<Ts> + ... + std::size_t{});
+    auto words = std::array<std::uint64_t, (num_bytes + 7U) / 8U>{};
+    auto offset = std::size_t{};
+    ((pack<Ts>(words, offset, args), offset += packed_size_v<Ts>), ...);
+
+    if constexpr (words.size() == 0U) {
+        return wyhash::hash(std::uint64_t{});
+    } else if constexpr (words.size() == 1U) {
+        return wyhash::mix(wyhash::secret[1] ^ num_bytes, wyhash::mix(words[0] ^ wyhash::secret[1], wyhash::secret[0]));
+    } else if constexpr (words.size() == 2U) {
+        return wyhash::mix(wyhash::secret[1] ^ num_bytes,
+                           wyhash::mix(words[0] ^ wyhash::secret[1], words[1] ^ wyhash::secret[0]));
+    } else {
+        return wyhash::hash(static_cast<void const*>(words.data()), num_bytes);
+    }
+}
+
+template <typename... Args>
+[[nodiscard]] auto hash_packed(Args const&... args) noexcept -> std::uint64_t {
+    return hash_packed_as<Args...>(args...);
+}
+
+} // namespace detail
 
-    // Creates a buffer that holds all the data from each element of the tuple. If possible we memcpy the data directly. If
-    // not, we hash the object and use this for the array. Size of the array is known at compile time, and memcpy is optimized
-    // away, so filling the buffer is highly efficient. Finally, call wyhash with this buffer.
+template <typename... Args>
+struct tuple_hash_helper {
+    // t can be any pair or tuple whose elements are compatible with Args
     template <typename T, std::size_t... Idx>
     [[nodiscard]] static auto calc_hash(T const& t, std::index_sequence<Idx...> /*unused*/) noexcept -> std::uint64_t {
-        auto h = std::uint64_t{};
-        ((h = mix64(h, to64(std::get<Idx>(t)))), ...);
-        return h;
+        return detail::hash_packed_as<Args...>(std::get<Idx>(t)...);
     }
 };
 
+// Transparent: a pair or tuple with e.g. std::string_view instead of std::string elements gives the same hash. Use together
+// with tuple_equal for heterogeneous lookup.
 template <typename... Args>
 struct hash<std::tuple<Args...>> : tuple_hash_helper<Args...> {
     using is_avalanching = void;
+    using is_transparent = void;
+
     auto operator()(std::tuple<Args...> const& t) const noexcept -> std::uint64_t {
         return tuple_hash_helper<Args...>::calc_hash(t, std::index_sequence_for<Args...>{});
     }
+
+    template <typename T,
+              typename std::enable_if_t<detail::is_tuple_hash_compatible<std::tuple<Args...>, T>::value, bool> = true>
+    auto operator()(T const& t) const noexcept -> std::uint64_t {
+        return tuple_hash_helper<Args...>::calc_hash(t, std::index_sequence_for<Args...>{});
+    }
 };
 
 template <typename A, typename B>
 struct hash<std::pair<A, B>> : tuple_hash_helper<A, B> {
     using is_avalanching = void;
+    using is_transparent = void;
+
     auto operator()(std::pair<A, B> const& t) const noexcept -> std::uint64_t {
         return tuple_hash_helper<A, B>::calc_hash(t, std::index_sequence_for<A, B>{});
     }
+
+    template <typename T, typename std::enable_if_t<detail::is_tuple_hash_compatible<std::pair<A, B>, T>::value, bool> = true>
+    auto operator()(T const& t) const noexcept -> std::uint64_t {
+        return tuple_hash_helper<A, B>::calc_hash(t, std::index_sequence_for<A, B>{});
+    }
+};
+
+// Transparent equality for pairs and tuples, compares element by element. Unlike std::equal_to<> this also works for
+// std::pair with different element types, e.g. std::pair<std::string, int> and std::pair<std::string_view, int>.
+struct tuple_equal {
+    using is_transparent = void;
+
+    template <typename A, typename B>
+    auto operator()(A const& a, B const& b) const -> bool {
+        static_assert(std::tuple_size<A>::value == std::tuple_size<B>::value, "pair or tuple sizes differ");
+        return equal(a, b, std::make_index_sequence<std::tuple_size<A>::value>{});
+    }
+
+private:
+    template <typename A, typename B, std::size_t... Idx>
+    static auto equal(A const& a, B const& b, std::index_sequence<Idx...> /*unused*/) -> bool {
+        return ((std::get<Idx>(a) == std::get<Idx>(b)) && ...);
+    }
+};
+
+// Hashes the given members of T like a tuple of them, e.g. `member_hash<&point::x, &point::y>`.
+template <auto... Members>
+struct member_hash {
+    using is_avalanching = void;
+    template <typename T>
+    auto operator()(T const& obj) const noexcept -> std::uint64_t {
+        return detail::hash_packed(obj.*Members...);
+    }
 };
 
+// Specializes ankerl::unordered_dense::hash for an aggregate by listing its members, e.g.
+// `ANKERL_UNORDERED_DENSE_HASH_MEMBERS(point, &point::x, &point::y);`. Use it in the global namespace.
 // NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
-#    define ANKERL_UNORDERED_DENSE_HASH_STATICCAST(T)                         \
-        template <>                                                           \
-        struct hash<T> {                                                      \
-            using is_avalanching = void;                                      \
-            auto operator()(T const& obj) const noexcept -> std::uint64_t {   \
-                return detail::wyhash::hash(static_cast<std::uint64_t>(obj)); \
-            }                                                                 \
-        }
+#    define ANKERL_UNORDERED_DENSE_HASH_MEMBERS(T, ...) \
+        template <>                                     \
+        struct ankerl::unordered_dense::hash<T> : ankerl::unordered_dense::member_hash<__VA_ARGS__> {}
 
-#    if defined(__GNUC__) && !defined(__clang__)
-#        pragma GCC diagnostic push
-#        pragma GCC diagnostic ignored "-Wuseless-cast"
-#    endif
-// see https://en.cppreference.com/w/cpp/utility/hash
-ANKERL_UNORDERED_DENSE_HASH_STATICCAST(bool);
-ANKERL_UNORDERED_DENSE_HASH_STATICCAST(char);
-ANKERL_UNORDERED_DENSE_HASH_STATICCAST(signed char);
-ANKERL_UNORDERED_DENSE_HASH_STATICCAST(unsigned char);
+namespace detail {
+
+// The bytes of the elements are hashed directly, so the elements have to be packable.
+template <typename T>
+[[nodiscard]] auto hash_contiguous(T const* data, std::size_t size) noexcept -> std::uint64_t {
+    static_assert(is_packable_v<T>, "elements must have a unique object representation");
+    return wyhash::hash(static_cast<void const*>(data), sizeof(T) * size);
+}
+
+} // namespace detail
+
+template <typename T, std::size_t N>
+struct hash<std::array<T, N>, typename std::enable_if_t<detail::is_packable_v<T>>> {
+    using is_avalanching = void;
+    auto operator()(std::array<T, N> const& arr) const noexcept -> std::uint64_t {
+        return detail::hash_contiguous(arr.data(), arr.size());
+    }
+};
+
+// Only for vectors with a data(), std::vector<bool> stores bits and keeps using std::hash.
+template <typename T, typename Allocator>
+struct hash<std::vector<T, Allocator>,
+            typename std::enable_if_t<detail::is_packable_v<T> && detail::is_contiguous_range_v<std::vector<T, Allocator>>>> {
+    using is_avalanching = void;
+    auto operator()(std::vector<T, Allocator> const& vec) const noexcept -> std::uint64_t {
+        return detail::hash_contiguous(vec.data(), vec.size());
+    }
+};
+
+#    if ANKERL_UNORDERED_DENSE_HAS_SPAN()
+template <typename T, std::size_t Extent>
+struct hash<std::span<T, Extent>, typename std::enable_if_t<detail::is_packable_v<std::remove_cv_t<T>>>> {
+    using is_avalanching = void;
+    auto operator()(std::span<T, Extent> const& s) const noexcept -> std::uint64_t {
+        return detail::hash_contiguous<std::remove_cv_t<T>>(s.data(), s.size());
+    }
+};
+#    endif
+
+// Transparent hash for any contiguous range of T. Gives the same hash as ankerl::unordered_dense::hash<std::vector<T>> and
+// hash<std::span<T const>>, so e.g. a map with std::vector<int> keys can be queried with a std::span<int const> or a
+// std::array<int, N> without creating a vector. Use together with contiguous_equal.
+template <typename T>
+struct contiguous_hash {
+    using is_transparent = void;
+    using is_avalanching = void;
+
+    template <typename Range, typename std::enable_if_t<detail::is_contiguous_range_of_v<Range, T>, bool> = true>
+    auto operator()(Range const& range) const noexcept -> std::uint64_t {
+        return detail::hash_contiguous<T>(range.data(), range.size());
+    }
+};
+
+// Transparent equality for any two contiguous ranges of T, see contiguous_hash.
+template <typename T>
+struct contiguous_equal {
+    using is_transparent = void;
+
+    template <typename RangeA,
+              typename RangeB,
+              typename std::enable_if_t<detail::is_contiguous_range_of_v<RangeA, T>, bool> = true,
+              typename std::enable_if_t<detail::is_contiguous_range_of_v<RangeB, T>, bool> = true>
+    auto operator()(RangeA const& a, RangeB const& b) const noexcept -> bool {
+        // same as the hash: elements are equal when their bytes are equal
+        return a.size() == b.size() && (a.size() == 0 || 0 == std::memcmp(a.data(), b.data(), sizeof(T) * a.size()));
+    }
+};
+
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#    define ANKERL_UNORDERED_DENSE_HASH_STATICCAST(T)                                 \
+        template <>                                                                   \
+        struct hash<T> {                                                              \
+            using is_avalanching = void;                                              \
+            constexpr auto operator()(T const& obj) const noexcept -> std::uint64_t { \
+                return detail::wyhash::hash(static_cast<std::uint64_t>(obj));         \
+            }                                                                         \
+        }
+
+#    if defined(__GNUC__) && !defined(__clang__)
+#        pragma GCC diagnostic push
+#        pragma GCC diagnostic ignored "-Wuseless-cast"
+#    endif
+// see https://en.cppreference.com/w/cpp/utility/hash
+ANKERL_UNORDERED_DENSE_HASH_STATICCAST(bool);
+ANKERL_UNORDERED_DENSE_HASH_STATICCAST(char);
+ANKERL_UNORDERED_DENSE_HASH_STATICCAST(signed char);
+ANKERL_UNORDERED_DENSE_HASH_STATICCAST(unsigned char);
 #    if ANKERL_UNORDERED_DENSE_CPP_VERSION >= 202002L && defined(__cpp_char8_t)
 ANKERL_UNORDERED_DENSE_HASH_STATICCAST(char8_t);
 #    endif
@@ -422,6 +1026,475 @@ ANKERL_UNORDERED_DENSE_HASH_STATICCAST(unsigned long long);
 #        pragma GCC diagnostic pop
 #    endif
 
+// Alternatives to hash for integer keys, with different trade-offs between speed and quality. hash itself does a full
+// 64x64->128bit multiplication, which is a good default for any kind of key.
+
+// Uses the key as it is and claims to be avalanching, so the map doesn't mix it either. Only use this when the keys are
+// already uniformly distributed over all 64 bits, e.g. ids that are hashes themselves. Small or sequential keys all end up
+// in the same few buckets, which makes the map extremely slow.
+template <typename T>
+struct hash_identity_avalanching {
+    static_assert(std::is_integral_v<T> || std::is_enum_v<T>, "only for integers");
+    using is_avalanching = void;
+
+    constexpr auto operator()(T const& obj) const noexcept -> std::uint64_t {
+        return static_cast<std::uint64_t>(obj);
+    }
+};
+
+// A single 64bit multiplication with a xor-shift to bring the well mixed upper bits down. Cheaper than hash where there is
+// no fast 64x64->128bit multiplication, e.g. on 32bit CPUs. On x86-64 the difference is small. Good for sequential and
+// strided keys, but bit i of the result only depends on bits 0 to i+32 of the key, so keys that only differ in their
+// uppermost bits can collide.
+template <typename T>
+struct hash_multiply_shift {
+    static_assert(std::is_integral_v<T> || std::is_enum_v<T>, "only for integers");
+    using is_avalanching = void;
+
+    ANKERL_UNORDERED_DENSE_DISABLE_UBSAN_UNSIGNED_INTEGER_CHECK constexpr auto operator()(T const& obj) const noexcept
+        -> std::uint64_t {
+        auto const h = static_cast<std::uint64_t>(obj) * UINT64_C(0x9E3779B97F4A7C15);
+        return h ^ (h >> 32U);
+    }
+};
+
+namespace detail::aes {
+
+#    if ANKERL_UNORDERED_DENSE_HAS_AES_IMPL()
+
+[[nodiscard]] inline auto cpu_has_aes() -> bool {
+    static bool const has_aes = [] {
+#        if defined(_MSC_VER) && !defined(__clang__)
+        int info[4] = {};
+        __cpuid(info, 1);
+        return 0 != (static_cast<unsigned>(info[2]) & (1U << 25U));
+#        else
+        __builtin_cpu_init();
+        return 0 != __builtin_cpu_supports("aes");
+#        endif
+    }();
+    return has_aes;
+}
+
+[[nodiscard]] ANKERL_UNORDERED_DENSE_TARGET_AES inline auto make_key(std::uint64_t hi, std::uint64_t lo) -> __m128i {
+    return _mm_set_epi64x(static_cast<long long>(hi), static_cast<long long>(lo)); // NOLINT(google-runtime-int)
+}
+
+[[nodiscard]] ANKERL_UNORDERED_DENSE_TARGET_AES inline auto load(std::uint8_t const* p) -> __m128i {
+    return _mm_loadu_si128(reinterpret_cast<__m128i const*>(p)); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+// One AES round per 16 bytes of input, the data is used as the round key. Processed in 8 independent lanes so the latency
+// of aesenc is hidden. The final rounds make sure each input bit affects all output bits, so this is avalanching.
+// Requires len > 16.
+[[nodiscard]] ANKERL_UNORDERED_DENSE_TARGET_AES inline auto hash_long(void const* data, std::size_t len) -> std::uint64_t {
+    auto const* p = static_cast<std::uint8_t const*>(data);
+    auto const* const end = p + len;
+    auto const k0 = make_key(wyhash::secret[0], wyhash::secret[1]);
+    auto const k1 = make_key(wyhash::secret[2], wyhash::secret[3]);
+
+    // The length is mixed in at the end, otherwise it could cancel out with the data of the first block.
+    auto s = k0;
+    if (len > 128) {
+        auto const k2 = make_key(wyhash::secret[1], wyhash::secret[2]);
+        auto const k3 = make_key(wyhash::secret[3], wyhash::secret[0]);
+        auto s1 = k1;
+        auto s2 = k2;
+        auto s3 = k3;
+        auto s4 = _mm_xor_si128(k0, k1);
+        auto s5 = _mm_xor_si128(k1, k2);
+        auto s6 = _mm_xor_si128(k2, k3);
+        auto s7 = _mm_xor_si128(k3, k0);
+        do {
+            s = _mm_aesenc_si128(s, load(p));
+            s1 = _mm_aesenc_si128(s1, load(p + 16));
+            s2 = _mm_aesenc_si128(s2, load(p + 32));
+            s3 = _mm_aesenc_si128(s3, load(p + 48));
+            s4 = _mm_aesenc_si128(s4, load(p + 64));
+            s5 = _mm_aesenc_si128(s5, load(p + 80));
+            s6 = _mm_aesenc_si128(s6, load(p + 96));
+            s7 = _mm_aesenc_si128(s7, load(p + 112));
+            p += 128;
+        } while (end - p > 128);
+
+        // The last block of each lane went through only a single round, which spreads each byte over only 4 bytes. Another
+        // round per lane before merging, otherwise differences in two lanes can cancel out.
+        s = _mm_aesenc_si128(s, k0);
+        s1 = _mm_aesenc_si128(s1, k1);
+        s2 = _mm_aesenc_si128(s2, k2);
+        s3 = _mm_aesenc_si128(s3, k3);
+        s4 = _mm_aesenc_si128(s4, k0);
+        s5 = _mm_aesenc_si128(s5, k1);
+        s6 = _mm_aesenc_si128(s6, k2);
+        s7 = _mm_aesenc_si128(s7, k3);
+        s = _mm_aesenc_si128(s, s1);
+        s2 = _mm_aesenc_si128(s2, s3);
+        s4 = _mm_aesenc_si128(s4, s5);
+        s6 = _mm_aesenc_si128(s6, s7);
+        s = _mm_aesenc_si128(_mm_aesenc_si128(s, s2), _mm_aesenc_si128(s4, s6));
+    }
+
+    // 17 to 128 bytes left. Process 16 byte blocks, the last one overlaps with the previous one.
+    while (end - p > 16) {
+        s = _mm_aesenc_si128(s, load(p));
+        p += 16;
+    }
+    s = _mm_aesenc_si128(s, load(end - 16));
+
+    s = _mm_aesenc_si128(s, _mm_xor_si128(k1, make_key(len, len)));
+    s = _mm_aesenc_si128(s, k0);
+    s = _mm_aesenc_si128(s, k1);
+    auto const lo = static_cast<std::uint64_t>(_mm_cvtsi128_si64(s));
+    auto const hi = static_cast<std::uint64_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(s, s)));
+    return lo ^ hi;
+}
+
+#    endif
+
+} // namespace detail::aes
+
+// Alternative to hash for strings. Uses AES-NI instructions when the CPU supports them, which is detected at runtime, and
+// falls back to wyhash otherwise. This is much faster for long strings. Note that the hash values depend on the CPU, so
+// don't persist them.
+template <typename T, typename Enable = void>
+struct hash_aes;
+
+template <typename CharT>
+struct hash_aes<std::basic_string_view<CharT>> {
+    using is_avalanching = void;
+    // Below this size wyhash is faster, the latency of the aesenc rounds dominates.
+    static constexpr std::size_t min_aes_bytes = 256;
+
+    auto operator()(std::basic_string_view<CharT> const& sv) const noexcept -> std::uint64_t {
+        auto const num_bytes = sizeof(CharT) * sv.size();
+#    if ANKERL_UNORDERED_DENSE_HAS_AES_IMPL()
+        if (num_bytes > min_aes_bytes && detail::aes::cpu_has_aes()) {
+            return detail::aes::hash_long(sv.data(), num_bytes);
+        }
+#    endif
+        return detail::wyhash::hash(sv.data(), num_bytes);
+    }
+};
+
+template <typename CharT>
+struct hash_aes<std::basic_string<CharT>> : hash_aes<std::basic_string_view<CharT>> {
+    using is_avalanching = void;
+    auto operator()(std::basic_string<CharT> const& str) const noexcept -> std::uint64_t {
+        return hash_aes<std::basic_string_view<CharT>>::operator()(str);
+    }
+};
+
+namespace detail {
+
+// Key types for which hash<T> is wyhash::hash of the key converted to a 64bit word, see ANKERL_UNORDERED_DENSE_HASH_STATICCAST
+// and the hashes for enums and pointers. Wider integers like __int128 are hashed bytewise instead.
+template <typename T>
+constexpr bool is_word_hashable_v = (std::is_integral_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>) &&
+                                    sizeof(T) <= sizeof(std::uint64_t);
+
+// The integer type with the same representation as T, that hash<T> converts to std::uint64_t.
+template <typename T, typename Enable = void>
+struct hash_word {
+    using type = T;
+};
+
+template <typename T>
+struct hash_word<T, std::enable_if_t<std::is_enum_v<T>>> {
+    using type = std::underlying_type_t<T>;
+};
+
+template <typename T>
+struct hash_word<T, std::enable_if_t<std::is_pointer_v<T>>> {
+    using type = std::uintptr_t;
+};
+
+template <>
+struct hash_word<bool> {
+    using type = std::uint8_t;
+};
+
+template <typename T>
+using hash_word_t = typename hash_word<T>::type;
+
+} // namespace detail
+
+namespace detail::simd {
+
+#    if ANKERL_UNORDERED_DENSE_HAS_SIMD_IMPL()
+
+struct cpu_features {
+    bool avx2 = false;
+    bool avx512 = false;
+};
+
+[[nodiscard]] inline auto cpu() -> cpu_features const& {
+    static auto const features = [] {
+        auto f = cpu_features{};
+#        if defined(_MSC_VER) && !defined(__clang__)
+        // The CPU has to support the instructions, and the OS has to save the registers: OSXSAVE, and XCR0 has the bits
+        // for the ymm registers (1, 2) and for the zmm registers (5, 6, 7).
+        int info[4] = {};
+        __cpuid(info, 1);
+        auto const ecx = static_cast<unsigned>(info[2]);
+        if (0 == (ecx & (1U << 27U)) || 0 == (ecx & (1U << 28U))) {
+            return f;
+        }
+        auto const xcr0 = _xgetbv(0);
+        __cpuidex(info, 7, 0);
+        auto const ebx = static_cast<unsigned>(info[1]);
+        f.avx2 = 0x6U == (xcr0 & 0x6U) && 0 != (ebx & (1U << 5U));
+        f.avx512 = 0xE6U == (xcr0 & 0xE6U) && 0 != (ebx & (1U << 16U));
+#        else
+        __builtin_cpu_init();
+        f.avx2 = 0 != __builtin_cpu_supports("avx2");
+        f.avx512 = 0 != __builtin_cpu_supports("avx512f");
+#        endif
+        return f;
+    }();
+    return features;
+}
+
+// Same as wyhash::hash(std::uint64_t) for 4 words at once. AVX2 can only multiply 32x32->64bit, so the 64x64->128bit
+// product is assembled from 4 partial products. The middle sum has at most 34 bits, so no carry handling is necessary.
+[[nodiscard]] ANKERL_UNORDERED_DENSE_TARGET_AVX2 inline auto hash4(__m256i x) -> __m256i {
+    auto const lo32 = _mm256_set1_epi64x(INT64_C(0xFFFFFFFF));
+    auto const b_lo = _mm256_set1_epi64x(INT64_C(0x7F4A7C15));
+    auto const b_hi = _mm256_set1_epi64x(INT64_C(0x9E3779B9));
+
+    auto const x_hi = _mm256_srli_epi64(x, 32);
+    auto const ll = _mm256_mul_epu32(x, b_lo);
+    auto const hl = _mm256_mul_epu32(x_hi, b_lo);
+    auto const lh = _mm256_mul_epu32(x, b_hi);
+    auto const hh = _mm256_mul_epu32(x_hi, b_hi);
+
+    auto const mid = _mm256_add_epi64(_mm256_add_epi64(_mm256_srli_epi64(ll, 32), _mm256_and_si256(hl, lo32)),
+                                      _mm256_and_si256(lh, lo32));
+    auto const lo = _mm256_or_si256(_mm256_slli_epi64(mid, 32), _mm256_and_si256(ll, lo32));
+    auto const hi = _mm256_add_epi64(_mm256_add_epi64(hh, _mm256_srli_epi64(mid, 32)),
+                                     _mm256_add_epi64(_mm256_srli_epi64(hl, 32), _mm256_srli_epi64(lh, 32)));
+    return _mm256_xor_si256(lo, hi);
+}
+
+// Some GCC versions warn about _mm512_undefined_epi32() inside the AVX-512 intrinsics.
+#        if defined(__GNUC__) && !defined(__clang__)
+#            pragma GCC diagnostic push
+#            pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#            pragma GCC diagnostic ignored "-Wuninitialized"
+#        endif
+
+// Same as hash4, for 8 words.
+[[nodiscard]] ANKERL_UNORDERED_DENSE_TARGET_AVX512 inline auto hash8(__m512i x) -> __m512i {
+    auto const lo32 = _mm512_set1_epi64(INT64_C(0xFFFFFFFF));
+    auto const b_lo = _mm512_set1_epi64(INT64_C(0x7F4A7C15));
+    auto const b_hi = _mm512_set1_epi64(INT64_C(0x9E3779B9));
+
+    auto const x_hi = _mm512_srli_epi64(x, 32);
+    auto const ll = _mm512_mul_epu32(x, b_lo);
+    auto const hl = _mm512_mul_epu32(x_hi, b_lo);
+    auto const lh = _mm512_mul_epu32(x, b_hi);
+    auto const hh = _mm512_mul_epu32(x_hi, b_hi);
+
+    auto const mid = _mm512_add_epi64(_mm512_add_epi64(_mm512_srli_epi64(ll, 32), _mm512_and_si512(hl, lo32)),
+                                      _mm512_and_si512(lh, lo32));
+    auto const lo = _mm512_or_si512(_mm512_slli_epi64(mid, 32), _mm512_and_si512(ll, lo32));
+    auto const hi = _mm512_add_epi64(_mm512_add_epi64(hh, _mm512_srli_epi64(mid, 32)),
+                                     _mm512_add_epi64(_mm512_srli_epi64(hl, 32), _mm512_srli_epi64(lh, 32)));
+    return _mm512_xor_si512(lo, hi);
+}
+
+// Loads 4 integers of type Int and widens them to 64bit the same way static_cast<std::uint64_t> does.
+template <typename Int>
+[[nodiscard]] ANKERL_UNORDERED_DENSE_TARGET_AVX2 inline auto load4(std::uint8_t const* p) -> __m256i {
+    // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+    if constexpr (sizeof(Int) == 8) {
+        return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p));
+    } else if constexpr (sizeof(Int) == 4) {
+        auto const x = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p));
+        return std::is_signed_v<Int> ? _mm256_cvtepi32_epi64(x) : _mm256_cvtepu32_epi64(x);
+    } else if constexpr (sizeof(Int) == 2) {
+        auto const x = _mm_loadl_epi64(reinterpret_cast<__m128i const*>(p));
+        return std::is_signed_v<Int> ? _mm256_cvtepi16_epi64(x) : _mm256_cvtepu16_epi64(x);
+    } else {
+        static_assert(sizeof(Int) == 1);
+        std::int32_t v{};
+        std::memcpy(&v, p, sizeof(v));
+        auto const x = _mm_cvtsi32_si128(v);
+        return std::is_signed_v<Int> ? _mm256_cvtepi8_epi64(x) : _mm256_cvtepu8_epi64(x);
+    }
+    // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+// Same as load4, for 8 integers.
+template <typename Int>
+[[nodiscard]] ANKERL_UNORDERED_DENSE_TARGET_AVX512 inline auto load8(std::uint8_t const* p) -> __m512i {
+    // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+    if constexpr (sizeof(Int) == 8) {
+        return _mm512_loadu_si512(p);
+    } else if constexpr (sizeof(Int) == 4) {
+        auto const x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p));
+        return std::is_signed_v<Int> ? _mm512_cvtepi32_epi64(x) : _mm512_cvtepu32_epi64(x);
+    } else if constexpr (sizeof(Int) == 2) {
+        auto const x = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p));
+        return std::is_signed_v<Int> ? _mm512_cvtepi16_epi64(x) : _mm512_cvtepu16_epi64(x);
+    } else {
+        static_assert(sizeof(Int) == 1);
+        auto const x = _mm_loadl_epi64(reinterpret_cast<__m128i const*>(p));
+        return std::is_signed_v<Int> ? _mm512_cvtepi8_epi64(x) : _mm512_cvtepu8_epi64(x);
+    }
+    // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+// Hashes n integers of type Int in blocks of 4, returns how many were hashed. The rest is left for the scalar code. The
+// data is only read through the load intrinsics, so it doesn't matter what type is actually stored there.
+template <typename Int>
+ANKERL_UNORDERED_DENSE_TARGET_AVX2 inline auto hash_ints_avx2(void const* data, std::size_t n, std::uint64_t* out)
+    -> std::size_t {
+    auto const* p = static_cast<std::uint8_t const*>(data);
+    std::size_t i = 0;
+    // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+    // two independent blocks per iteration so the multiplications can overlap
+    for (; i + 8 <= n; i += 8) {
+        auto const h0 = hash4(load4<Int>(p + (i * sizeof(Int))));
+        auto const h1 = hash4(load4<Int>(p + ((i + 4) * sizeof(Int))));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), h0);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i + 4), h1);
+    }
+    if (i + 4 <= n) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), hash4(load4<Int>(p + (i * sizeof(Int)))));
+        i += 4;
+    }
+    // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+    return i;
+}
+
+// Same as hash_ints_avx2, in blocks of 8.
+template <typename Int>
+ANKERL_UNORDERED_DENSE_TARGET_AVX512 inline auto hash_ints_avx512(void const* data, std::size_t n, std::uint64_t* out)
+    -> std::size_t {
+    auto const* p = static_cast<std::uint8_t const*>(data);
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        auto const h0 = hash8(load8<Int>(p + (i * sizeof(Int))));
+        auto const h1 = hash8(load8<Int>(p + ((i + 8) * sizeof(Int))));
+        _mm512_storeu_si512(out + i, h0);
+        _mm512_storeu_si512(out + i + 8, h1);
+    }
+    if (i + 8 <= n) {
+        _mm512_storeu_si512(out + i, hash8(load8<Int>(p + (i * sizeof(Int)))));
+        i += 8;
+    }
+    return i;
+}
+
+#        if defined(__GNUC__) && !defined(__clang__)
+#            pragma GCC diagnostic pop
+#        endif
+
+#    endif
+
+} // namespace detail::simd
+
+// Hashes n keys at once and writes hash<Key>{}(keys[i]) to out[i]. For integers, enums and pointers. With AVX-512 or AVX2,
+// which is detected at runtime, 8 or 4 keys are hashed per instruction, otherwise one at a time. The results are exactly the
+// same either way, so they can be used e.g. to prefetch or shard keys before inserting them into a map that uses hash<Key>.
+template <typename Key, std::enable_if_t<detail::is_word_hashable_v<Key>, bool> = true>
+void hash_many(Key const* keys, std::size_t n, std::uint64_t* out) noexcept {
+    std::size_t i = 0;
+#    if ANKERL_UNORDERED_DENSE_HAS_SIMD_IMPL()
+    using word_t = detail::hash_word_t<Key>;
+    if (n >= 4) {
+        auto const& cpu = detail::simd::cpu();
+        if (cpu.avx512) {
+            i = detail::simd::hash_ints_avx512<word_t>(keys, n, out);
+        }
+        if (cpu.avx2) {
+            i += detail::simd::hash_ints_avx2<word_t>(keys + i, n - i, out + i);
+        }
+    }
+#    endif
+    for (; i < n; ++i) {
+        out[i] = hash<Key>{}(keys[i]);
+    }
+}
+
+namespace detail {
+
+// 128 bits from std::random_device, read once per process. Without them the seeds would only depend on addresses and a
+// counter, which can be reproduced with ASLR off or after an address leak.
+[[nodiscard]] inline auto process_secret() -> std::array<std::uint64_t, 2> const& {
+    static auto const secret = [] {
+        auto device = std::random_device();
+        auto word = [&device] {
+            return (std::uint64_t{device()} << 32U) ^ std::uint64_t{device()};
+        };
+        return std::array<std::uint64_t, 2>{word(), word()};
+    }();
+    return secret;
+}
+
+// A different seed for each call. Combines the process secret with a per thread counter and the addresses of the counter
+// and of the object that gets the seed, so it's neither predictable from the outside nor derivable from earlier seeds.
+// Being thread_local the counter needs no atomic.
+[[nodiscard]] inline auto random_seed(void const* object) -> std::uint64_t {
+    thread_local auto counter = std::uint64_t{};
+    // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+    auto const counter_address = std::uint64_t{reinterpret_cast<std::uintptr_t>(&counter)};
+    auto const object_address = std::uint64_t{reinterpret_cast<std::uintptr_t>(object)};
+    // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+    auto const& secret = process_secret();
+    return wyhash::mix(++counter ^ object_address ^ secret[0], counter_address ^ secret[1]);
+}
+
+} // namespace detail
+
+// Wraps Hash and adds a per instance random seed, which the table folds into mixed_hash() with wyhash's mix, one 64x64 to
+// 128bit multiplication and an xor.
+// Each table default constructs its own hasher, so each table gets its own seed. This makes it impossible to predict
+// which keys collide in the buckets, and helps against hash flooding. When an insert hits a pathologically long probe
+// sequence, the table calls reseed() and rebuilds the buckets.
+//
+// Note that this can't help against keys that have exactly the same 64bit hash, for that Hash itself has to be keyed.
+template <typename T, typename Hash = hash<T>>
+struct seeded_hash : Hash {
+    using is_seeded = void;
+
+    // after that many reseeds the keys are most likely full hash collisions, so it's pointless to try again.
+    static constexpr std::uint32_t max_num_reseeds = 4;
+
+    seeded_hash()
+        : m_seed(detail::random_seed(this)) {}
+
+    explicit seeded_hash(std::uint64_t seed)
+        : m_seed(detail::wyhash::hash(seed)) {}
+
+    seeded_hash(std::uint64_t seed, Hash const& hash)
+        : Hash(hash)
+        , m_seed(detail::wyhash::hash(seed)) {}
+
+    // The value that is mixed into the hash.
+    [[nodiscard]] auto seed() const noexcept -> std::uint64_t {
+        return m_seed;
+    }
+
+    [[nodiscard]] auto num_reseeds() const noexcept -> std::uint32_t {
+        return m_num_reseeds;
+    }
+
+    // Called by the table for pathologically long probe sequences. Returns false when reseeding is not worth it any more.
+    auto reseed() -> bool {
+        if (m_num_reseeds == max_num_reseeds) {
+            return false;
+        }
+        ++m_num_reseeds;
+        m_seed = detail::random_seed(this);
+        return true;
+    }
+
+private:
+    std::uint64_t m_seed;
+    std::uint32_t m_num_reseeds = 0;
+};
+
 // bucket_type //////////////////////////////////////////////////////////
 
 namespace bucket_type {
@@ -444,40 +1517,45 @@ ANKERL_UNORDERED_DENSE_PACK(struct big {
 
 } // namespace bucket_type
 
-namespace detail {
-
-struct nonesuch {};
-struct default_container_t {};
+// Growth policies decide how much the table grows when it is full. The buckets always grow by a power of two, and
+// bucket_growth_shifts is the exponent: 1 doubles them. When a policy has next_values_capacity(), the table reserves that
+// capacity in the values container right before the container would have to reallocate. Otherwise the container grows
+// the way it does by itself, e.g. std::vector usually doubles.
+namespace growth_policy {
 
-template <class Default, class AlwaysVoid, template <class...> class Op, class... Args>
-struct detector {
-    using value_t = std::false_type;
-    using type = Default;
+struct standard {
+    static constexpr std::uint8_t bucket_growth_shifts = 1;
 };
 
-template <class Default, template <class...> class Op, class... Args>
-struct detector<Default, std::void_t<Op<Args...>>, Op, Args...> {
-    using value_t = std::true_type;
-    using type = Op<Args...>;
-};
+// Grows the values capacity by the factor Numerator / Denominator, e.g. factor<3, 2> grows by 1.5x. A smaller factor means
+// a smaller peak while the values are copied over, but more frequent reallocations.
+template <std::size_t Numerator, std::size_t Denominator>
+struct factor {
+    static_assert(Denominator > 0 && Numerator > Denominator, "growth factor needs to be > 1");
 
-template <template <class...> class Op, class... Args>
-using is_detected = typename detail::detector<detail::nonesuch, void, Op, Args...>::value_t;
+    static constexpr std::uint8_t bucket_growth_shifts = 1;
 
-template <template <class...> class Op, class... Args>
-constexpr bool is_detected_v = is_detected<Op, Args...>::value;
+    [[nodiscard]] static constexpr auto next_values_capacity(std::size_t capacity) -> std::size_t {
+        return capacity + (std::max)(std::size_t{1}, capacity / Denominator * (Numerator - Denominator));
+    }
+};
 
-template <typename T>
-using detect_avalanching = typename T::is_avalanching;
+// Grows the values capacity by a fixed number of elements. The peak is bounded by the increment, but each reallocation
+// copies all values, so this is only for tables with a known upper bound of their size.
+template <std::size_t Increment>
+struct increment {
+    static_assert(Increment > 0, "increment needs to be > 0");
 
-template <typename T>
-using detect_is_transparent = typename T::is_transparent;
+    static constexpr std::uint8_t bucket_growth_shifts = 1;
 
-template <typename T>
-using detect_iterator = typename T::iterator;
+    [[nodiscard]] static constexpr auto next_values_capacity(std::size_t capacity) -> std::size_t {
+        return capacity + Increment;
+    }
+};
 
-template <typename T>
-using detect_reserve = decltype(std::declval<T&>().reserve(std::size_t{}));
+} // namespace growth_policy
+
+namespace detail {
 
 // enable_if helpers
 
@@ -495,6 +1573,51 @@ constexpr bool is_neither_convertible_v = !std::is_convertible_v<From, To1> && !
 template <typename T>
 constexpr bool has_reserve = is_detected_v<detect_reserve, T>;
 
+// emplace() can look up the key before it constructs a value when the key is one of its arguments: the key itself for a
+// set; for a map a key and a mapped value, a pair with the key as first, or piecewise_construct with a tuple of just the
+// key. Args are without cv and reference.
+template <bool IsMap, typename Key, typename... Args>
+struct is_emplace_key_extractable : std::false_type {};
+
+template <typename Key>
+struct is_emplace_key_extractable<false, Key, Key> : std::true_type {};
+
+template <typename Key, typename M>
+struct is_emplace_key_extractable<true, Key, Key, M> : std::true_type {};
+
+template <typename Key, typename A, typename B>
+struct is_emplace_key_extractable<true, Key, std::pair<A, B>>
+    : std::is_same<Key, std::remove_cv_t<std::remove_reference_t<A>>> {};
+
+template <typename Key, typename A, typename M>
+struct is_emplace_key_extractable<true, Key, std::piecewise_construct_t, std::tuple<A>, M>
+    : std::is_same<Key, std::remove_cv_t<std::remove_reference_t<A>>> {};
+
+template <bool IsMap, typename Key, typename... Args>
+constexpr bool is_emplace_key_extractable_v =
+    is_emplace_key_extractable<IsMap, Key, std::remove_cv_t<std::remove_reference_t<Args>>...>::value;
+
+// The goal of mixed_hash is to always produce a high quality 64bit hash.
+template <typename Hash, typename K>
+[[nodiscard]] constexpr auto mixed_hash(Hash const& hash, K const& key) -> std::uint64_t {
+    if constexpr (is_detected_v<detect_seeded, Hash>) {
+        // seeded => wyhash mix with the seed, a 64x64 to 128bit multiplication, which also avalanches bad hashes.
+        return wyhash::mix(static_cast<std::uint64_t>(hash(key)), hash.seed());
+    } else if constexpr (is_detected_v<detect_avalanching, Hash>) {
+        // we know that the hash is good because is_avalanching.
+        if constexpr (sizeof(decltype(hash(key))) < sizeof(std::uint64_t)) {
+            // 32bit hash and is_avalanching => multiply with a constant to avalanche bits upwards
+            return hash(key) * UINT64_C(0x9ddfea08eb382d69);
+        } else {
+            // 64bit and is_avalanching => only use the hash itself.
+            return hash(key);
+        }
+    } else {
+        // not is_avalanching => apply wyhash
+        return wyhash::hash(hash(key));
+    }
+}
+
 // base type for map has mapped_type
 template <class T>
 struct base_table_type_map {
@@ -772,6 +1895,17 @@ public:
         return m_blocks.size() * num_elements_in_block;
     }
 
+    // Number of bytes allocated for all the blocks, and for the vector of block pointers.
+    [[nodiscard]] auto memory_usage() const -> std::size_t {
+        return capacity() * sizeof(T) + m_blocks.capacity() * sizeof(pointer);
+    }
+
+    // Number of bytes memory_usage() reports after reserve(capacity) on an empty segmented_vector.
+    [[nodiscard]] static constexpr auto estimated_memory(std::size_t capacity) -> std::size_t {
+        auto const num_blocks = calc_num_blocks_for_capacity(capacity);
+        return num_blocks * num_elements_in_block * sizeof(T) + num_blocks * sizeof(pointer);
+    }
+
     // Indexing is highly performance critical
     [[nodiscard]] constexpr auto operator[](std::size_t i) const noexcept -> T const& {
         return m_blocks[i >> num_bits][i & mask];
@@ -883,1028 +2017,3852 @@ public:
     }
 };
 
-namespace detail {
-
-// This is it, the table. Doubles as map and set, and uses `void` for T when its used as a set.
-template <class Key,
-          class T, // when void, treat it as a set.
-          class Hash,
-          class KeyEqual,
-          class AllocatorOrContainer,
-          class Bucket,
-          class BucketContainer,
-          bool IsSegmented>
-class table : public std::conditional_t<is_map_v<T>, base_table_type_map<T>, base_table_type_set> {
-    using underlying_value_type = std::conditional_t<is_map_v<T>, std::pair<Key, T>, Key>;
-    using underlying_container_type = std::conditional_t<IsSegmented,
-                                                         segmented_vector<underlying_value_type, AllocatorOrContainer>,
-                                                         std::vector<underlying_value_type, AllocatorOrContainer>>;
+// A vector with a fixed capacity and all elements stored inside the object itself, so it never allocates. Like
+// segmented_vector it only implements what's necessary to work as an underlying container for
+// ankerl::unordered_dense::{map, set}, for the values as well as for the buckets. Growing beyond Capacity calls
+// on_error_bucket_overflow(). The allocator is only there so that the table can construct it, it is never used.
+template <typename T, std::size_t Capacity>
+class inplace_vector {
+    static_assert(Capacity > 0, "inplace_vector needs room for at least one element");
 
 public:
-    using value_container_type = std::
-        conditional_t<is_detected_v<detect_iterator, AllocatorOrContainer>, AllocatorOrContainer, underlying_container_type>;
+    using allocator_type = std::allocator<T>;
+    using pointer = T*;
+    using const_pointer = T const*;
+    using difference_type = std::ptrdiff_t;
+    using value_type = T;
+    using size_type = std::size_t;
+    using reference = T&;
+    using const_reference = T const&;
+    using iterator = T*;
+    using const_iterator = T const*;
+
+    // lets the table size its buckets at compile time
+    static constexpr std::size_t fixed_capacity = Capacity;
 
 private:
-    using bucket_alloc =
-        typename std::allocator_traits<typename value_container_type::allocator_type>::template rebind_alloc<Bucket>;
-    using default_bucket_container_type =
-        std::conditional_t<IsSegmented, segmented_vector<Bucket, bucket_alloc>, std::vector<Bucket, bucket_alloc>>;
+    // The first m_size elements are constructed. A union, so that the elements are neither constructed nor zeroed, which
+    // would cost O(Capacity) per construction, while the constructors can still be constexpr: they initialize the empty
+    // member. A static inplace_vector is therefore constant initialized.
+    union storage {
+        std::byte m_empty;
+        T m_elements[Capacity]; // NOLINT(cppcoreguidelines-avoid-c-arrays,hicpp-avoid-c-arrays,modernize-avoid-c-arrays)
+
+        constexpr storage() noexcept
+            : m_empty{} {}
+
+        storage(storage const&) = delete;
+        storage(storage&&) = delete;
+        auto operator=(storage const&) -> storage& = delete;
+        auto operator=(storage&&) -> storage& = delete;
+
+        // the elements are destroyed by inplace_vector
+        ~storage() {} // NOLINT(modernize-use-equals-default): = default would be deleted for a non-trivial T
+    };
 
-    using bucket_container_type = std::conditional_t<std::is_same_v<BucketContainer, detail::default_container_t>,
-                                                     default_bucket_container_type,
-                                                     BucketContainer>;
+    storage m_data{};
+    std::size_t m_size{};
 
-    static constexpr std::uint8_t initial_shifts = 64 - 2; // 2^(64-m_shift) number of buckets
-    static constexpr float default_max_load_factor = 0.8F;
+    template <typename Alloc>
+    using enable_if_allocator = std::enable_if_t<!std::is_same_v<std::decay_t<Alloc>, inplace_vector>, bool>;
+
+    // Moves everything from other
+    void append_everything_from(inplace_vector&& other) { // NOLINT(cppcoreguidelines-rvalue-reference-param-not-moved)
+        reserve(size() + other.size());
+        for (auto&& o : other) {
+            emplace_back(std::move(o));
+        }
+    }
+
+    // Copies everything from other
+    void append_everything_from(inplace_vector const& other) {
+        reserve(size() + other.size());
+        for (auto const& o : other) {
+            emplace_back(o);
+        }
+    }
 
 public:
-    using key_type = Key;
-    using value_type = typename value_container_type::value_type;
-    using size_type = typename value_container_type::size_type;
-    using difference_type = typename value_container_type::difference_type;
-    using hasher = Hash;
-    using key_equal = KeyEqual;
-    using allocator_type = typename value_container_type::allocator_type;
-    using reference = typename value_container_type::reference;
-    using const_reference = typename value_container_type::const_reference;
-    using pointer = typename value_container_type::pointer;
-    using const_pointer = typename value_container_type::const_pointer;
-    using const_iterator = typename value_container_type::const_iterator;
-    using iterator = std::conditional_t<is_map_v<T>, typename value_container_type::iterator, const_iterator>;
-    using bucket_type = Bucket;
+    constexpr inplace_vector() noexcept = default;
 
-private:
-    using value_idx_type = decltype(Bucket::m_value_idx);
-    using dist_and_fingerprint_type = decltype(Bucket::m_dist_and_fingerprint);
+    template <typename Alloc, enable_if_allocator<Alloc> = true>
+    explicit constexpr inplace_vector(Alloc const& /*unused*/) noexcept {}
 
-    static_assert(std::is_trivially_destructible_v<Bucket>, "assert there's no need to call destructor / std::destroy");
-    static_assert(std::is_trivially_copyable_v<Bucket>, "assert we can just memset / memcpy");
+    template <typename Alloc>
+    inplace_vector(inplace_vector const& other, Alloc const& /*unused*/) {
+        append_everything_from(other);
+    }
 
-    value_container_type m_values{}; // Contains all the key-value pairs in one densely stored container. No holes.
-    bucket_container_type m_buckets{};
-    std::size_t m_max_bucket_capacity = 0;
-    float m_max_load_factor = default_max_load_factor;
-    Hash m_hash{};
-    KeyEqual m_equal{};
-    std::uint8_t m_shifts = initial_shifts;
+    inplace_vector(inplace_vector const& other) {
+        append_everything_from(other);
+    }
 
-    [[nodiscard]] auto next(value_idx_type bucket_idx) const -> value_idx_type {
-        if (ANKERL_UNORDERED_DENSE_UNLIKELY(bucket_idx + 1U == bucket_count()))
-            ANKERL_UNORDERED_DENSE_UNLIKELY_ATTR {
-                return 0;
-            }
+    // moves the elements over one by one, afterwards other is empty
+    inplace_vector(inplace_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        append_everything_from(std::move(other));
+        other.clear();
+    }
 
-        return static_cast<value_idx_type>(bucket_idx + 1U);
+    auto operator=(inplace_vector const& other) -> inplace_vector& {
+        if (this != &other) {
+            clear();
+            append_everything_from(other);
+        }
+        return *this;
     }
 
-    // Helper to access bucket through pointer types
-    [[nodiscard]] static constexpr auto at(bucket_container_type& bucket, std::size_t offset) -> Bucket& {
-        return bucket[offset];
+    auto operator=(inplace_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) -> inplace_vector& {
+        if (this != &other) {
+            clear();
+            append_everything_from(std::move(other));
+            other.clear();
+        }
+        return *this;
     }
 
-    [[nodiscard]] static constexpr auto at(const bucket_container_type& bucket, std::size_t offset) -> const Bucket& {
-        return bucket[offset];
+    ~inplace_vector() {
+        clear();
     }
 
-    // use the dist_inc and dist_dec functions so that std::uint16_t types work without warning
-    [[nodiscard]] static constexpr auto dist_inc(dist_and_fingerprint_type x) -> dist_and_fingerprint_type {
-        return static_cast<dist_and_fingerprint_type>(x + Bucket::dist_inc);
+    [[nodiscard]] constexpr auto size() const noexcept -> std::size_t {
+        return m_size;
     }
 
-    [[nodiscard]] static constexpr auto dist_dec(dist_and_fingerprint_type x) -> dist_and_fingerprint_type {
-        return static_cast<dist_and_fingerprint_type>(x - Bucket::dist_inc);
+    [[nodiscard]] static constexpr auto capacity() noexcept -> std::size_t {
+        return Capacity;
     }
 
-    // The goal of mixed_hash is to always produce a high quality 64bit hash.
-    template <typename K>
-    [[nodiscard]] constexpr auto mixed_hash(K const& key) const -> std::uint64_t {
-        if constexpr (is_detected_v<detect_avalanching, Hash>) {
-            // we know that the hash is good because is_avalanching.
-            if constexpr (sizeof(decltype(m_hash(key))) < sizeof(std::uint64_t)) {
-                // 32bit hash and is_avalanching => multiply with a constant to avalanche bits upwards
-                return m_hash(key) * UINT64_C(0x9ddfea08eb382d69);
-            } else {
-                // 64bit and is_avalanching => only use the hash itself.
-                return m_hash(key);
-            }
-        } else {
-            // not is_avalanching => apply wyhash
-            return wyhash::hash(m_hash(key));
-        }
+    // Nothing is ever allocated.
+    [[nodiscard]] static constexpr auto memory_usage() noexcept -> std::size_t {
+        return 0;
     }
 
-    [[nodiscard]] constexpr auto dist_and_fingerprint_from_hash(std::uint64_t hash) const -> dist_and_fingerprint_type {
-        return Bucket::dist_inc | (static_cast<dist_and_fingerprint_type>(hash) & Bucket::fingerprint_mask);
+    [[nodiscard]] static constexpr auto estimated_memory(std::size_t /*capacity*/) noexcept -> std::size_t {
+        return 0;
     }
 
-    [[nodiscard]] constexpr auto bucket_idx_from_hash(std::uint64_t hash) const -> value_idx_type {
-        return static_cast<value_idx_type>(hash >> m_shifts);
+    [[nodiscard]] constexpr auto data() noexcept -> T* {
+        return m_data.m_elements;
     }
 
-    [[nodiscard]] static constexpr auto get_key(value_type const& vt) -> key_type const& {
-        if constexpr (is_map_v<T>) {
-            return vt.first;
-        } else {
-            return vt;
-        }
+    [[nodiscard]] constexpr auto data() const noexcept -> T const* {
+        return m_data.m_elements;
     }
 
-    template <typename K>
-    [[nodiscard]] auto next_while_less(K const& key) const -> Bucket {
-        auto hash = mixed_hash(key);
-        auto dist_and_fingerprint = dist_and_fingerprint_from_hash(hash);
-        auto bucket_idx = bucket_idx_from_hash(hash);
+    [[nodiscard]] auto operator[](std::size_t i) const noexcept -> T const& {
+        return data()[i]; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
 
-        while (dist_and_fingerprint < at(m_buckets, bucket_idx).m_dist_and_fingerprint) {
-            dist_and_fingerprint = dist_inc(dist_and_fingerprint);
-            bucket_idx = next(bucket_idx);
-        }
-        return {dist_and_fingerprint, bucket_idx};
+    [[nodiscard]] auto operator[](std::size_t i) noexcept -> T& {
+        return data()[i]; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
     }
 
-    void place_and_shift_up(Bucket bucket, value_idx_type place) {
-        while (0 != at(m_buckets, place).m_dist_and_fingerprint) {
-            bucket = std::exchange(at(m_buckets, place), bucket);
-            bucket.m_dist_and_fingerprint = dist_inc(bucket.m_dist_and_fingerprint);
-            place = next(place);
-        }
-        at(m_buckets, place) = bucket;
+    [[nodiscard]] auto begin() noexcept -> iterator {
+        return data();
+    }
+    [[nodiscard]] auto begin() const noexcept -> const_iterator {
+        return data();
+    }
+    [[nodiscard]] auto cbegin() const noexcept -> const_iterator {
+        return data();
     }
 
-    void erase_and_shift_down(value_idx_type bucket_idx) {
-        // shift down until either empty or an element with correct spot is found
-        auto next_bucket_idx = next(bucket_idx);
-        while (at(m_buckets, next_bucket_idx).m_dist_and_fingerprint >= Bucket::dist_inc * 2) {
-            auto& next_bucket = at(m_buckets, next_bucket_idx);
-            at(m_buckets, bucket_idx) = {dist_dec(next_bucket.m_dist_and_fingerprint), next_bucket.m_value_idx};
-            bucket_idx = std::exchange(next_bucket_idx, next(next_bucket_idx));
-        }
-        at(m_buckets, bucket_idx) = {};
+    [[nodiscard]] auto end() noexcept -> iterator {
+        return data() + m_size; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+    [[nodiscard]] auto end() const noexcept -> const_iterator {
+        return data() + m_size; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+    [[nodiscard]] auto cend() const noexcept -> const_iterator {
+        return data() + m_size; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
     }
 
-    [[nodiscard]] static constexpr auto calc_num_buckets(std::uint8_t shifts) -> std::size_t {
-        return (std::min)(max_bucket_count(), std::size_t{1} << (64U - shifts));
+    [[nodiscard]] auto back() noexcept -> reference {
+        return operator[](m_size - 1);
+    }
+    [[nodiscard]] auto back() const noexcept -> const_reference {
+        return operator[](m_size - 1);
     }
 
-    [[nodiscard]] constexpr auto calc_shifts_for_size(std::size_t s) const -> std::uint8_t {
-        auto shifts = initial_shifts;
-        while (shifts > 0 && static_cast<std::size_t>(static_cast<float>(calc_num_buckets(shifts)) * max_load_factor()) < s) {
-            --shifts;
-        }
-        return shifts;
+    void pop_back() noexcept {
+        back().~T();
+        --m_size;
     }
 
-    // assumes m_values has data, m_buckets=m_buckets_end=nullptr, m_shifts is INITIAL_SHIFTS
-    void copy_buckets(table const& other) {
-        // assumes m_values has already the correct data copied over.
-        if (empty()) {
-            // when empty, at least allocate an initial buckets and clear them.
-            allocate_buckets_from_shift();
-            clear_buckets();
-        } else {
-            m_shifts = other.m_shifts;
-            allocate_buckets_from_shift();
-            if constexpr (IsSegmented || !std::is_same_v<BucketContainer, default_container_t>) {
-                for (auto i = 0UL; i < bucket_count(); ++i) {
-                    at(m_buckets, i) = at(other.m_buckets, i);
-                }
-            } else {
-                std::memcpy(m_buckets.data(), other.m_buckets.data(), sizeof(Bucket) * bucket_count());
-            }
-        }
+    [[nodiscard]] constexpr auto empty() const noexcept -> bool {
+        return 0 == m_size;
     }
 
-    /**
-     * True when no element can be added any more without increasing the size
-     */
-    [[nodiscard]] auto is_full() const -> bool {
-        return size() > m_max_bucket_capacity;
+    // There's nothing to reserve, but asking for more than Capacity is an error.
+    static void reserve(std::size_t new_capacity) {
+        if (ANKERL_UNORDERED_DENSE_UNLIKELY(new_capacity > Capacity))
+            ANKERL_UNORDERED_DENSE_UNLIKELY_ATTR {
+                detail::on_error_bucket_overflow();
+            }
     }
 
-    void deallocate_buckets() {
-        m_buckets.clear();
-        m_buckets.shrink_to_fit();
-        m_max_bucket_capacity = 0;
+    static void shrink_to_fit() noexcept {}
+
+    [[nodiscard]] auto get_allocator() const noexcept -> allocator_type {
+        return allocator_type{};
     }
 
-    void allocate_buckets_from_shift() {
-        auto num_buckets = calc_num_buckets(m_shifts);
-        if constexpr (IsSegmented || !std::is_same_v<BucketContainer, default_container_t>) {
-            if constexpr (has_reserve<bucket_container_type>) {
-                m_buckets.reserve(num_buckets);
-            }
-            for (std::size_t i = m_buckets.size(); i < num_buckets; ++i) {
-                m_buckets.emplace_back();
+    template <class... Args>
+    auto emplace_back(Args&&... args) -> reference {
+        if (ANKERL_UNORDERED_DENSE_UNLIKELY(m_size == Capacity))
+            ANKERL_UNORDERED_DENSE_UNLIKELY_ATTR {
+                detail::on_error_bucket_overflow();
             }
-        } else {
-            m_buckets.resize(num_buckets);
-        }
-        if (num_buckets == max_bucket_count()) {
-            // reached the maximum, make sure we can use each bucket
-            m_max_bucket_capacity = max_bucket_count();
-        } else {
-            m_max_bucket_capacity = static_cast<value_idx_type>(static_cast<float>(num_buckets) * max_load_factor());
-        }
+        auto& ref = *new (static_cast<void*>(end())) T(std::forward<Args>(args)...);
+        ++m_size;
+        return ref;
     }
 
-    void clear_buckets() {
-        if constexpr (IsSegmented || !std::is_same_v<BucketContainer, default_container_t>) {
-            for (auto&& e : m_buckets) {
-                std::memset(&e, 0, sizeof(e));
+    void clear() noexcept {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (auto& e : *this) {
+                e.~T();
             }
-        } else {
-            std::memset(m_buckets.data(), 0, sizeof(Bucket) * bucket_count());
         }
+        m_size = 0;
     }
+};
 
-    void clear_and_fill_buckets_from_values() {
-        clear_buckets();
-        for (value_idx_type value_idx = 0, end_idx = static_cast<value_idx_type>(m_values.size()); value_idx < end_idx;
-             ++value_idx) {
-            auto const& key = get_key(m_values[value_idx]);
-            auto [dist_and_fingerprint, bucket] = next_while_less(key);
+// A vector that keeps its size and capacity in a header in front of the elements, in the same allocation. So the object
+// itself is a single pointer (plus the allocator if it has state), which makes tables that use it for the values and
+// the buckets much smaller. An empty compact_vector doesn't allocate anything. Like segmented_vector
+// it only implements what's necessary to work as an underlying container for ankerl::unordered_dense::{map, set}.
+template <typename T, typename Allocator = std::allocator<T>>
+class compact_vector {
+public:
+    using allocator_type = Allocator;
+    using pointer = T*;
+    using const_pointer = T const*;
+    using difference_type = std::ptrdiff_t;
+    using value_type = T;
+    using size_type = std::size_t;
+    using reference = T&;
+    using const_reference = T const&;
+    using iterator = T*;
+    using const_iterator = T const*;
 
-            // we know for certain that key has not yet been inserted, so no need to check it.
-            place_and_shift_up({dist_and_fingerprint, value_idx}, bucket);
-        }
-    }
+private:
+    struct header {
+        std::size_t size;
+        std::size_t capacity;
+    };
 
-    void increase_size() {
-        if (m_max_bucket_capacity == max_bucket_count()) {
-            // remove the value again, we can't add it!
-            m_values.pop_back();
-            on_error_bucket_overflow();
-        }
-        --m_shifts;
-        if constexpr (!IsSegmented || std::is_same_v<BucketContainer, default_container_t>) {
-            deallocate_buckets();
-        }
-        allocate_buckets_from_shift();
-        clear_and_fill_buckets_from_values();
+    static constexpr std::size_t alignment = alignof(T) > alignof(header) ? alignof(T) : alignof(header);
+
+    // memory is allocated in units that are aligned for the header as well as for T
+    struct alignas(alignment) unit {
+        std::array<std::byte, alignment> bytes;
+    };
+
+    using unit_alloc = typename std::allocator_traits<Allocator>::template rebind_alloc<unit>;
+
+    // the elements start right after the header
+    static constexpr std::size_t data_offset = (sizeof(header) + alignment - 1) / alignment * alignment;
+
+    // Each empty compact_vector points to this header, so that size() and data() don't need to check for nullptr. It is
+    // never written to, and its capacity of 0 tells that there's nothing to deallocate.
+    struct empty_storage {
+        header m_header{};
+        std::array<std::byte, data_offset - sizeof(header)> m_padding{};
+    };
+
+    alignas(alignment) static constexpr empty_storage s_empty_storage{};
+
+    [[nodiscard]] static auto empty_header() noexcept -> header* {
+        return const_cast<header*>(&s_empty_storage.m_header); // NOLINT(cppcoreguidelines-pro-type-const-cast)
     }
 
-    template <typename Op>
-    void do_erase(value_idx_type bucket_idx, Op handle_erased_value) {
-        auto const value_idx_to_remove = at(m_buckets, bucket_idx).m_value_idx;
-        erase_and_shift_down(bucket_idx);
-        handle_erased_value(std::move(m_values[value_idx_to_remove]));
+    // the allocator is a base so that a stateless one doesn't take any space
+    struct storage : unit_alloc {
+        header* m_header = empty_header();
 
-        // update m_values
-        if (value_idx_to_remove != m_values.size() - 1) {
-            // no luck, we'll have to replace the value with the last one and update the index accordingly
-            auto& val = m_values[value_idx_to_remove];
-            val = std::move(m_values.back());
+        storage() = default;
 
-            // update the values_idx of the moved entry. No need to play the info game, just look until we find the values_idx
-            bucket_idx = bucket_idx_from_hash(mixed_hash(get_key(val)));
-            auto const values_idx_back = static_cast<value_idx_type>(m_values.size() - 1);
-            while (values_idx_back != at(m_buckets, bucket_idx).m_value_idx) {
-                bucket_idx = next(bucket_idx);
+        explicit storage(unit_alloc const& alloc)
+            : unit_alloc(alloc) {}
+    };
+
+    storage m_storage{};
+
+    // Destroys the elements constructed in new storage and deallocates it, unless it is released by setting m_header to
+    // nullptr. So when constructing an element in new storage throws, the vector is unchanged.
+    struct storage_guard {
+        compact_vector* m_vec;
+        header* m_header;
+        T* m_extra = nullptr; // an element constructed after the first m_header->size ones
+
+        storage_guard(compact_vector* vec, header* h)
+            : m_vec(vec)
+            , m_header(h) {}
+
+        storage_guard(storage_guard const&) = delete;
+        storage_guard(storage_guard&&) = delete;
+        auto operator=(storage_guard const&) -> storage_guard& = delete;
+        auto operator=(storage_guard&&) -> storage_guard& = delete;
+
+        ~storage_guard() {
+            if (m_header != nullptr) {
+                if (m_extra != nullptr) {
+                    std::destroy_at(m_extra);
+                }
+                std::destroy_n(data_of(m_header), m_header->size);
+                m_vec->deallocate_storage(m_header);
             }
-            at(m_buckets, bucket_idx).m_value_idx = value_idx_to_remove;
         }
-        m_values.pop_back();
-    }
+    };
 
-    template <typename K, typename Op>
-    auto do_erase_key(K&& key, Op handle_erased_value) -> std::size_t { // NOLINT(cppcoreguidelines-missing-std-forward)
-        if (empty()) {
-            return 0;
-        }
+    [[nodiscard]] static constexpr auto calc_num_units(std::size_t capacity) -> std::size_t {
+        return (data_offset + capacity * sizeof(T) + alignment - 1) / alignment;
+    }
 
-        auto [dist_and_fingerprint, bucket_idx] = next_while_less(key);
+    [[nodiscard]] static auto data_of(header* h) noexcept -> T* {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        return reinterpret_cast<T*>(reinterpret_cast<std::byte*>(h) + data_offset);
+    }
 
-        while (dist_and_fingerprint == at(m_buckets, bucket_idx).m_dist_and_fingerprint &&
-               !m_equal(key, get_key(m_values[at(m_buckets, bucket_idx).m_value_idx]))) {
-            dist_and_fingerprint = dist_inc(dist_and_fingerprint);
-            bucket_idx = next(bucket_idx);
-        }
+    // Storage for capacity elements, with a header for no elements yet.
+    [[nodiscard]] auto allocate_storage(std::size_t capacity) -> header* {
+        unit* units = std::allocator_traits<unit_alloc>::allocate(m_storage, calc_num_units(capacity));
+        return new (static_cast<void*>(units)) header{0, capacity};
+    }
 
-        if (dist_and_fingerprint != at(m_buckets, bucket_idx).m_dist_and_fingerprint) {
-            return 0;
-        }
-        do_erase(bucket_idx, handle_erased_value);
-        return 1;
+    void deallocate_storage(header* h) noexcept {
+        auto* units = reinterpret_cast<unit*>(h); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        std::allocator_traits<unit_alloc>::deallocate(m_storage, units, calc_num_units(h->capacity));
     }
 
-    template <class K, class M>
-    auto do_insert_or_assign(K&& key, M&& mapped) -> std::pair<iterator, bool> {
-        auto it_isinserted = try_emplace(std::forward<K>(key), std::forward<M>(mapped));
-        if (!it_isinserted.second) {
-            it_isinserted.first->second = std::forward<M>(mapped);
+    // Moves all elements over to the guarded new storage, and makes that the storage of this vector. Like std::vector it
+    // copies them instead when moving could throw, so if that throws the guard cleans up and this vector is unchanged.
+    void move_to_storage(storage_guard& guard) {
+        auto* const old_header = m_storage.m_header;
+        auto* const old_data = data_of(old_header);
+        auto* const new_data = data_of(guard.m_header);
+        for (std::size_t i = 0; i < old_header->size; ++i) {
+            new (static_cast<void*>(new_data + i)) T(std::move_if_noexcept(old_data[i])); // NOLINT
+            ++guard.m_header->size;
+        }
+        std::destroy_n(old_data, old_header->size);
+        m_storage.m_header = std::exchange(guard.m_header, nullptr);
+        if (old_header->capacity != 0) {
+            deallocate_storage(old_header);
         }
-        return it_isinserted;
     }
 
-    template <typename... Args>
-    auto do_place_element(dist_and_fingerprint_type dist_and_fingerprint, value_idx_type bucket_idx, Args&&... args)
-        -> std::pair<iterator, bool> {
+    void move_to_new_storage(std::size_t new_capacity) {
+        auto guard = storage_guard(this, allocate_storage(new_capacity));
+        move_to_storage(guard);
+    }
 
-        // emplace the new value. If that throws an exception, no harm done; index is still in a valid state
-        m_values.emplace_back(std::forward<Args>(args)...);
+    // slow path: the element is constructed in the new storage before the others are moved there, because args might
+    // refer to one of them.
+    template <class... Args>
+    auto grow_and_emplace_back(Args&&... args) -> reference {
+        auto const old_size = size();
+        auto guard = storage_guard(this, allocate_storage(old_size == 0 ? 1 : old_size * 2));
+        auto& ref = *new (static_cast<void*>(data_of(guard.m_header) + old_size)) T(std::forward<Args>(args)...); // NOLINT
+        guard.m_extra = &ref;
+        move_to_storage(guard);
+        ++m_storage.m_header->size;
+        return ref;
+    }
 
-        auto value_idx = static_cast<value_idx_type>(m_values.size() - 1);
-        if (ANKERL_UNORDERED_DENSE_UNLIKELY(is_full()))
-            ANKERL_UNORDERED_DENSE_UNLIKELY_ATTR {
-                increase_size();
-            }
-        else {
-            place_and_shift_up({dist_and_fingerprint, value_idx}, bucket_idx);
+    // Moves everything from other
+    void append_everything_from(compact_vector&& other) { // NOLINT(cppcoreguidelines-rvalue-reference-param-not-moved)
+        reserve(size() + other.size());
+        for (auto&& o : other) {
+            emplace_back(std::move(o));
         }
+    }
 
-        // place element and shift up until we find an empty spot
-        return {begin() + static_cast<difference_type>(value_idx), true};
+    // Copies everything from other
+    void append_everything_from(compact_vector const& other) {
+        reserve(size() + other.size());
+        for (auto const& o : other) {
+            emplace_back(o);
+        }
     }
 
-    template <typename K, typename... Args>
-    auto do_try_emplace(K&& key, Args&&... args) -> std::pair<iterator, bool> {
-        auto hash = mixed_hash(key);
-        auto dist_and_fingerprint = dist_and_fingerprint_from_hash(hash);
-        auto bucket_idx = bucket_idx_from_hash(hash);
+    void dealloc() noexcept {
+        if (capacity() != 0) {
+            deallocate_storage(std::exchange(m_storage.m_header, empty_header()));
+        }
+    }
 
-        while (true) {
-            auto* bucket = &at(m_buckets, bucket_idx);
-            if (dist_and_fingerprint == bucket->m_dist_and_fingerprint) {
-                if (m_equal(key, get_key(m_values[bucket->m_value_idx]))) {
-                    return {begin() + static_cast<difference_type>(bucket->m_value_idx), false};
-                }
-            } else if (dist_and_fingerprint > bucket->m_dist_and_fingerprint) {
-                return do_place_element(dist_and_fingerprint,
-                                        bucket_idx,
-                                        std::piecewise_construct,
-                                        std::forward_as_tuple(std::forward<K>(key)),
-                                        std::forward_as_tuple(std::forward<Args>(args)...));
-            }
-            dist_and_fingerprint = dist_inc(dist_and_fingerprint);
-            bucket_idx = next(bucket_idx);
+    // Replaces the elements with other's. other has to have an equal allocator.
+    void take_storage_of(compact_vector&& other) noexcept {
+        clear();
+        dealloc();
+        m_storage.m_header = std::exchange(other.m_storage.m_header, empty_header());
+    }
+
+public:
+    compact_vector() = default;
+
+    // NOLINTNEXTLINE(google-explicit-constructor,hicpp-explicit-conversions)
+    compact_vector(Allocator alloc)
+        : m_storage(unit_alloc(alloc)) {}
+
+    compact_vector(compact_vector&& other, Allocator alloc)
+        : compact_vector(alloc) {
+        *this = std::move(other);
+    }
+
+    compact_vector(compact_vector const& other, Allocator alloc)
+        : compact_vector(alloc) {
+        append_everything_from(other);
+    }
+
+    compact_vector(compact_vector&& other) noexcept
+        : m_storage(static_cast<unit_alloc const&>(other.m_storage)) {
+        m_storage.m_header = std::exchange(other.m_storage.m_header, empty_header());
+    }
+
+    compact_vector(compact_vector const& other)
+        : compact_vector(other,
+                         std::allocator_traits<Allocator>::select_on_container_copy_construction(other.get_allocator())) {}
+
+    // The elements are copied into new storage first, so when that throws this vector is unchanged.
+    auto operator=(compact_vector const& other) -> compact_vector& {
+        if (this != &other) {
+            take_storage_of(compact_vector(other, get_allocator()));
         }
+        return *this;
     }
 
-    template <typename K>
-    auto do_find(K const& key) -> iterator {
-        if (ANKERL_UNORDERED_DENSE_UNLIKELY(empty()))
-            ANKERL_UNORDERED_DENSE_UNLIKELY_ATTR {
-                return end();
+    // Only an allocator that is always equal makes sure that the storage can be taken over. Otherwise the elements are
+    // moved one by one into new storage, which can throw, and then this vector is unchanged.
+    auto operator=(compact_vector&& other) noexcept(std::allocator_traits<Allocator>::is_always_equal::value)
+        -> compact_vector& {
+        if (this != &other) {
+            if (other.get_allocator() == get_allocator()) {
+                take_storage_of(std::move(other));
+            } else {
+                auto moved = compact_vector(get_allocator());
+                moved.append_everything_from(std::move(other));
+                take_storage_of(std::move(moved));
+                other.clear();
             }
+        }
+        return *this;
+    }
 
-        auto mh = mixed_hash(key);
-        auto dist_and_fingerprint = dist_and_fingerprint_from_hash(mh);
-        auto bucket_idx = bucket_idx_from_hash(mh);
-        auto* bucket = &at(m_buckets, bucket_idx);
+    ~compact_vector() {
+        clear();
+        dealloc();
+    }
 
-        // unrolled loop. *Always* check a few directly, then enter the loop. This is faster.
-        if (dist_and_fingerprint == bucket->m_dist_and_fingerprint && m_equal(key, get_key(m_values[bucket->m_value_idx]))) {
-            return begin() + static_cast<difference_type>(bucket->m_value_idx);
-        }
-        dist_and_fingerprint = dist_inc(dist_and_fingerprint);
-        bucket_idx = next(bucket_idx);
-        bucket = &at(m_buckets, bucket_idx);
+    [[nodiscard]] auto size() const noexcept -> std::size_t {
+        return m_storage.m_header->size;
+    }
+
+    [[nodiscard]] auto capacity() const noexcept -> std::size_t {
+        return m_storage.m_header->capacity;
+    }
+
+    // Number of bytes allocated, including the header.
+    [[nodiscard]] auto memory_usage() const noexcept -> std::size_t {
+        return estimated_memory(capacity());
+    }
+
+    // Number of bytes memory_usage() reports after reserve(capacity) on an empty compact_vector.
+    [[nodiscard]] static constexpr auto estimated_memory(std::size_t capacity) -> std::size_t {
+        return capacity != 0 ? calc_num_units(capacity) * sizeof(unit) : 0;
+    }
+
+    [[nodiscard]] auto data() noexcept -> T* {
+        return data_of(m_storage.m_header);
+    }
+
+    [[nodiscard]] auto data() const noexcept -> T const* {
+        return data_of(m_storage.m_header);
+    }
+
+    [[nodiscard]] auto operator[](std::size_t i) const noexcept -> T const& {
+        return data_of(m_storage.m_header)[i]; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
 
-        if (dist_and_fingerprint == bucket->m_dist_and_fingerprint && m_equal(key, get_key(m_values[bucket->m_value_idx]))) {
-            return begin() + static_cast<difference_type>(bucket->m_value_idx);
+    [[nodiscard]] auto operator[](std::size_t i) noexcept -> T& {
+        return data_of(m_storage.m_header)[i]; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+
+    [[nodiscard]] auto begin() noexcept -> iterator {
+        return data();
+    }
+    [[nodiscard]] auto begin() const noexcept -> const_iterator {
+        return data();
+    }
+    [[nodiscard]] auto cbegin() const noexcept -> const_iterator {
+        return data();
+    }
+
+    [[nodiscard]] auto end() noexcept -> iterator {
+        return data() + size(); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+    [[nodiscard]] auto end() const noexcept -> const_iterator {
+        return data() + size(); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+    [[nodiscard]] auto cend() const noexcept -> const_iterator {
+        return data() + size(); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+
+    [[nodiscard]] auto back() noexcept -> reference {
+        return operator[](m_storage.m_header->size - 1);
+    }
+    [[nodiscard]] auto back() const noexcept -> const_reference {
+        return operator[](m_storage.m_header->size - 1);
+    }
+
+    void pop_back() noexcept {
+        back().~T();
+        --m_storage.m_header->size;
+    }
+
+    [[nodiscard]] auto empty() const noexcept -> bool {
+        return 0 == size();
+    }
+
+    void reserve(std::size_t new_capacity) {
+        if (new_capacity > capacity()) {
+            move_to_new_storage(new_capacity);
         }
-        dist_and_fingerprint = dist_inc(dist_and_fingerprint);
-        bucket_idx = next(bucket_idx);
-        bucket = &at(m_buckets, bucket_idx);
+    }
 
-        while (true) {
-            if (dist_and_fingerprint == bucket->m_dist_and_fingerprint) {
-                if (m_equal(key, get_key(m_values[bucket->m_value_idx]))) {
-                    return begin() + static_cast<difference_type>(bucket->m_value_idx);
-                }
-            } else if (dist_and_fingerprint > bucket->m_dist_and_fingerprint) {
-                return end();
-            }
-            dist_and_fingerprint = dist_inc(dist_and_fingerprint);
-            bucket_idx = next(bucket_idx);
-            bucket = &at(m_buckets, bucket_idx);
+    void shrink_to_fit() {
+        if (empty()) {
+            dealloc();
+        } else if (size() < capacity()) {
+            move_to_new_storage(size());
         }
     }
 
-    template <typename K>
-    auto do_find(K const& key) const -> const_iterator {
-        return const_cast<table*>(this)->do_find(key); // NOLINT(cppcoreguidelines-pro-type-const-cast)
+    [[nodiscard]] auto get_allocator() const -> allocator_type {
+        return allocator_type{static_cast<unit_alloc const&>(m_storage)};
     }
 
-    template <typename K, typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
-    auto do_at(K const& key) -> Q& {
-        if (auto it = find(key); ANKERL_UNORDERED_DENSE_LIKELY(end() != it))
-            ANKERL_UNORDERED_DENSE_LIKELY_ATTR {
-                return it->second;
+    template <class... Args>
+    auto emplace_back(Args&&... args) -> reference {
+        auto const s = size();
+        if (ANKERL_UNORDERED_DENSE_UNLIKELY(s == capacity()))
+            ANKERL_UNORDERED_DENSE_UNLIKELY_ATTR {
+                return grow_and_emplace_back(std::forward<Args>(args)...);
             }
-        on_error_key_not_found();
+        auto& ref = *new (static_cast<void*>(data_of(m_storage.m_header) + s)) T(std::forward<Args>(args)...); // NOLINT
+        ++m_storage.m_header->size;
+        return ref;
     }
 
-    template <typename K, typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
-    auto do_at(K const& key) const -> Q const& {
-        return const_cast<table*>(this)->at(key); // NOLINT(cppcoreguidelines-pro-type-const-cast)
+    void push_back(T const& value) {
+        emplace_back(value);
     }
 
-public:
-    explicit table(std::size_t bucket_count,
-                   Hash const& hash = Hash(),
-                   KeyEqual const& equal = KeyEqual(),
-                   allocator_type const& alloc_or_container = allocator_type())
-        : m_values(alloc_or_container)
-        , m_buckets(alloc_or_container)
-        , m_hash(hash)
-        , m_equal(equal) {
-        if (0 != bucket_count) {
-            reserve(bucket_count);
-        } else {
-            allocate_buckets_from_shift();
-            clear_buckets();
+    void push_back(T&& value) {
+        emplace_back(std::move(value));
+    }
+
+    template <typename It>
+    void assign(It first, It last) {
+        clear();
+        reserve(static_cast<std::size_t>(std::distance(first, last)));
+        for (; first != last; ++first) {
+            emplace_back(*first);
         }
     }
 
-    table()
-        : table(0) {}
+    void clear() noexcept {
+        if (m_storage.m_header->size != 0) {
+            if constexpr (!std::is_trivially_destructible_v<T>) {
+                for (auto& e : *this) {
+                    e.~T();
+                }
+            }
+            m_storage.m_header->size = 0;
+        }
+    }
+};
 
-    table(std::size_t bucket_count, allocator_type const& alloc)
-        : table(bucket_count, Hash(), KeyEqual(), alloc) {}
+// Result of table::probe_stats(). The probe length of an element is the distance from its ideal bucket, so 0 means the
+// element sits exactly where its hash points to.
+struct probe_statistics {
+    std::vector<std::size_t> histogram{}; // histogram[n] is the number of elements with probe length n
+    double average_probe_length{};
+    std::size_t max_probe_length{};
+    double empty_bucket_fraction{}; // fraction of buckets that are empty, 0.0 when there are no buckets at all.
+};
 
-    table(std::size_t bucket_count, Hash const& hash, allocator_type const& alloc)
-        : table(bucket_count, hash, KeyEqual(), alloc) {}
+#    if ANKERL_UNORDERED_DENSE_STATS
+
+// Per table operation counters, returned by table::stats(). Only available with ANKERL_UNORDERED_DENSE_STATS.
+struct operation_stats {
+    std::uint64_t finds = 0;                // lookups with find(), contains(), count(), at()
+    std::uint64_t hits = 0;                 // lookups that found the key
+    std::uint64_t misses = 0;               // lookups that did not find the key
+    std::uint64_t probe_steps = 0;          // buckets visited after the first one, by lookups and inserts
+    std::uint64_t equal_calls = 0;          // calls to key_equal
+    std::uint64_t shift_up_steps = 0;       // buckets moved by place_and_shift_up(), including during a rehash
+    std::uint64_t shift_down_steps = 0;     // buckets moved by the backward shift of erase
+    std::uint64_t increase_size_events = 0; // automatic growth because the table was full
+    std::uint64_t rehashes = 0;             // all rebuilds of the buckets, including increase_size_events
+};
 
-    explicit table(allocator_type const& alloc)
-        : table(0, Hash(), KeyEqual(), alloc) {}
+// Passed to the rehash callback after the buckets have been rebuilt.
+struct rehash_event {
+    std::size_t old_bucket_count;
+    std::size_t new_bucket_count;
+    std::size_t size; // number of elements in the table
+    std::chrono::nanoseconds elapsed;
+};
 
-    template <class InputIt>
-    table(InputIt first,
-          InputIt last,
-          size_type bucket_count = 0,
-          Hash const& hash = Hash(),
-          KeyEqual const& equal = KeyEqual(),
-          allocator_type const& alloc = allocator_type())
-        : table(bucket_count, hash, equal, alloc) {
-        insert(first, last);
+using rehash_callback = std::function<void(rehash_event const&)>;
+
+#    endif
+
+#    if ANKERL_UNORDERED_DENSE_HASH_CHECK
+
+// Passed to ANKERL_UNORDERED_DENSE_ON_POOR_HASH when the sampled probe lengths are much longer than what a good hash
+// produces for the current load factor. Only available with ANKERL_UNORDERED_DENSE_HASH_CHECK.
+struct poor_hash_report {
+    std::string_view key_type;
+    std::string_view hasher;
+    double average_probe_length;
+    double expected_probe_length;
+    std::size_t size;
+    std::size_t bucket_count;
+};
+
+#    endif
+
+namespace detail {
+
+#    if ANKERL_UNORDERED_DENSE_HASH_CHECK
+
+template <typename T>
+[[nodiscard]] constexpr auto type_name_raw() -> std::string_view {
+#        if defined(_MSC_VER)
+    return __FUNCSIG__; // NOLINT
+#        else
+    return __PRETTY_FUNCTION__; // NOLINT
+#        endif
+}
+
+// Human readable name of T, extracted from the function signature of type_name_raw<T>().
+template <typename T>
+[[nodiscard]] constexpr auto type_name() -> std::string_view {
+    auto const for_double = type_name_raw<double>();
+    auto const n_before = for_double.find("double");
+    auto const n_after = for_double.size() - (n_before + 6);
+
+    auto str = type_name_raw<T>();
+    str.remove_prefix(n_before);
+    str.remove_suffix(n_after);
+    return str;
+}
+
+// Expected average distance from the ideal bucket for robin hood hashing with linear probing, see Knuth's analysis of
+// successful searches: (1 + 1 / (1 - a)) / 2 probes, minus one because we count the distance.
+[[nodiscard]] constexpr auto expected_probe_length(double load_factor) -> double {
+    load_factor = (std::min)(load_factor, 0.99);
+    return load_factor / (2.0 * (1.0 - load_factor));
+}
+
+// Default handler for a bad hash, used when ANKERL_UNORDERED_DENSE_ON_POOR_HASH isn't defined.
+inline ANKERL_UNORDERED_DENSE_NOINLINE void on_poor_hash(poor_hash_report const& report) {
+    std::fprintf(stderr, // NOLINT(cppcoreguidelines-pro-type-vararg)
+                 "ankerl::unordered_dense: poor hash detected! average probe length %.1f, expected %.1f "
+                 "(size=%zu, bucket_count=%zu). key type '%.*s', hasher '%.*s'\n",
+                 report.average_probe_length,
+                 report.expected_probe_length,
+                 report.size,
+                 report.bucket_count,
+                 static_cast<int>(report.key_type.size()),
+                 report.key_type.data(),
+                 static_cast<int>(report.hasher.size()),
+                 report.hasher.data());
+}
+
+// Set once a poor hash was reported, so the report comes once per key type & hasher, whatever the table type.
+template <typename Key, typename Hash>
+inline auto poor_hash_reported = std::atomic<bool>{false}; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+#    endif
+
+template <typename T>
+using detect_memory_usage = decltype(std::declval<T const&>().memory_usage());
+
+template <typename T>
+using detect_capacity = decltype(std::declval<T const&>().capacity());
+
+template <typename T>
+using detect_estimated_memory = decltype(T::estimated_memory(std::size_t{}));
+
+template <typename T>
+using detect_next_values_capacity = decltype(T::next_values_capacity(std::size_t{}));
+
+template <typename T>
+using detect_fixed_capacity = decltype(T::fixed_capacity);
+
+// Containers like inplace_vector have a compile time capacity and never allocate.
+template <typename T>
+constexpr bool has_fixed_capacity = is_detected_v<detect_fixed_capacity, T>;
+
+// Bytes used by a container. Containers without capacity(), like std::deque, are approximated by their size.
+template <typename Container>
+[[nodiscard]] auto container_memory_usage(Container const& container) -> std::size_t {
+    if constexpr (is_detected_v<detect_memory_usage, Container>) {
+        return container.memory_usage();
+    } else if constexpr (is_detected_v<detect_capacity, Container>) {
+        return container.capacity() * sizeof(typename Container::value_type);
+    } else {
+        return container.size() * sizeof(typename Container::value_type);
     }
+}
 
-    template <class InputIt>
-    table(InputIt first, InputIt last, size_type bucket_count, allocator_type const& alloc)
-        : table(first, last, bucket_count, Hash(), KeyEqual(), alloc) {}
+// Bytes used by a container that holds exactly num_elements, e.g. after a reserve().
+template <typename Container>
+[[nodiscard]] constexpr auto container_estimated_memory(std::size_t num_elements) -> std::size_t {
+    if constexpr (is_detected_v<detect_estimated_memory, Container>) {
+        return Container::estimated_memory(num_elements);
+    } else {
+        return num_elements * sizeof(typename Container::value_type);
+    }
+}
 
-    template <class InputIt>
-    table(InputIt first, InputIt last, size_type bucket_count, Hash const& hash, allocator_type const& alloc)
-        : table(first, last, bucket_count, hash, KeyEqual(), alloc) {}
+// The default bucket container of a table that isn't segmented. The buckets are always allocated at once, with the count
+// they are used with, so unlike std::vector this doesn't need a capacity. That saves 8 bytes in each table.
+template <typename T, typename Allocator>
+class bucket_array {
+    static_assert(std::is_trivially_copyable_v<T>, "buckets are copied with memcpy");
 
-    table(table const& other)
-        : table(other, other.m_values.get_allocator()) {}
+    using alloc_traits = std::allocator_traits<Allocator>;
 
-    table(table const& other, allocator_type const& alloc)
-        : m_values(other.m_values, alloc)
-        , m_max_load_factor(other.m_max_load_factor)
-        , m_hash(other.m_hash)
-        , m_equal(other.m_equal) {
-        copy_buckets(other);
+    // the allocator is a base so that a stateless one doesn't take any space
+    struct storage : Allocator {
+        typename alloc_traits::pointer m_data{};
+        std::size_t m_size{};
+
+        storage() = default;
+
+        explicit storage(Allocator const& alloc)
+            : Allocator(alloc) {}
+    };
+
+    storage m_storage{};
+
+public:
+    using allocator_type = Allocator;
+    using value_type = T;
+    using size_type = std::size_t;
+    using reference = T&;
+    using const_reference = T const&;
+    using iterator = T*;
+    using const_iterator = T const*;
+
+    bucket_array() = default;
+
+    explicit bucket_array(Allocator const& alloc)
+        : m_storage(alloc) {}
+
+    bucket_array(bucket_array const&) = delete;
+    auto operator=(bucket_array const&) -> bucket_array& = delete;
+
+    bucket_array(bucket_array&& other) noexcept
+        : m_storage(static_cast<Allocator const&>(other.m_storage)) {
+        m_storage.m_data = std::exchange(other.m_storage.m_data, nullptr);
+        m_storage.m_size = std::exchange(other.m_storage.m_size, 0);
     }
 
-    table(table&& other) noexcept
-        : table(std::move(other), other.m_values.get_allocator()) {}
+    // Takes over the buckets, so both need to have equal allocators. The table only moves them in that case.
+    auto operator=(bucket_array&& other) noexcept -> bucket_array& {
+        if (this != &other) {
+            clear();
+            m_storage.m_data = std::exchange(other.m_storage.m_data, nullptr);
+            m_storage.m_size = std::exchange(other.m_storage.m_size, 0);
+        }
+        return *this;
+    }
+
+    ~bucket_array() {
+        clear();
+    }
+
+    [[nodiscard]] auto size() const noexcept -> std::size_t {
+        return m_storage.m_size;
+    }
+
+    [[nodiscard]] auto data() noexcept -> T* {
+        return 0 == m_storage.m_size ? nullptr : std::addressof(*m_storage.m_data);
+    }
+
+    [[nodiscard]] auto data() const noexcept -> T const* {
+        return 0 == m_storage.m_size ? nullptr : std::addressof(*m_storage.m_data);
+    }
+
+    [[nodiscard]] auto operator[](std::size_t i) noexcept -> T& {
+        return m_storage.m_data[static_cast<typename alloc_traits::difference_type>(i)];
+    }
+
+    [[nodiscard]] auto operator[](std::size_t i) const noexcept -> T const& {
+        return m_storage.m_data[static_cast<typename alloc_traits::difference_type>(i)];
+    }
+
+    [[nodiscard]] auto begin() noexcept -> iterator {
+        return data();
+    }
+
+    [[nodiscard]] auto begin() const noexcept -> const_iterator {
+        return data();
+    }
+
+    [[nodiscard]] auto end() noexcept -> iterator {
+        return data() + size(); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+
+    [[nodiscard]] auto end() const noexcept -> const_iterator {
+        return data() + size(); // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+
+    // Reallocates to exactly count buckets. Like std::vector, the existing buckets are kept and new ones are empty.
+    void resize(std::size_t count) {
+        if (count == size()) {
+            return;
+        }
+        auto new_data = typename alloc_traits::pointer{};
+        if (0 != count) {
+            new_data = alloc_traits::allocate(m_storage, count);
+            auto* const new_ptr = std::addressof(*new_data);
+            auto const num_kept = (std::min)(count, size());
+            if (0 != num_kept) {
+                std::memcpy(new_ptr, data(), sizeof(T) * num_kept);
+            }
+            std::memset(new_ptr + num_kept, 0, sizeof(T) * (count - num_kept)); // NOLINT
+        }
+        clear();
+        m_storage.m_data = new_data;
+        m_storage.m_size = count;
+    }
+
+    // Deallocates all buckets, there is no capacity to keep.
+    void clear() noexcept {
+        if (0 != m_storage.m_size) {
+            alloc_traits::deallocate(m_storage, m_storage.m_data, m_storage.m_size);
+            m_storage.m_data = nullptr;
+            m_storage.m_size = 0;
+        }
+    }
+
+    void shrink_to_fit() noexcept {}
+
+    [[nodiscard]] auto get_allocator() const -> allocator_type {
+        return static_cast<Allocator const&>(m_storage);
+    }
+};
+
+// The state of the features that only few tables use: stable index mode, and min_load_factor(). A table allocates it
+// when one of them is switched on, so all other tables pay only for a pointer.
+//
+// In stable index mode the values stay densely packed, and erase() still moves the last element into the hole. The
+// indices that find_index() returns are mapped to the elements in both directions, so they don't change when an element
+// moves. An erased element's index becomes free, and the next insert takes it.
+template <typename Index, typename Allocator>
+struct table_extras {
+    using allocator_type = Allocator;
+    using index_alloc = typename std::allocator_traits<Allocator>::template rebind_alloc<Index>;
+    using index_container = std::vector<Index, index_alloc>;
+
+    float min_load_factor = 0.0F;
+    bool stable_indices = false;
+    index_container index_of_value; // index of each element in values()
+    index_container value_of_index; // position in values() of each index. Stale for the free indices
+    index_container free_indices;   // a stack, so the most recently freed index is reused first
+
+    explicit table_extras(Allocator const& alloc)
+        : index_of_value(alloc)
+        , value_of_index(alloc)
+        , free_indices(alloc) {}
+
+    table_extras(table_extras const& other, Allocator const& alloc)
+        : min_load_factor(other.min_load_factor)
+        , stable_indices(other.stable_indices)
+        , index_of_value(other.index_of_value, alloc)
+        , value_of_index(other.value_of_index, alloc)
+        , free_indices(other.free_indices, alloc) {}
+
+    [[nodiscard]] auto get_allocator() const -> allocator_type {
+        return allocator_type(index_of_value.get_allocator());
+    }
+
+    // The stale position of a free index can't map back to it, because that position belongs to another index or to
+    // none at all.
+    [[nodiscard]] auto is_free(std::size_t idx) const noexcept -> bool {
+        if (idx >= value_of_index.size()) {
+            return false;
+        }
+        auto const value_idx = static_cast<std::size_t>(value_of_index[idx]);
+        return value_idx >= index_of_value.size() || index_of_value[value_idx] != idx;
+    }
+
+    // Makes room so that add() doesn't allocate. Called before the element is added to the values, so when this throws
+    // nothing has changed yet.
+    void reserve_for_add() {
+        grow_when_full(index_of_value);
+        if (free_indices.empty()) {
+            grow_when_full(value_of_index);
+        }
+    }
+
+    // The element that was just appended at value_idx gets an index: the most recently freed one, or a new one.
+    auto add(std::size_t value_idx) -> Index {
+        auto idx = static_cast<Index>(value_of_index.size());
+        if (free_indices.empty()) {
+            value_of_index.push_back(static_cast<Index>(value_idx));
+        } else {
+            idx = free_indices.back();
+            free_indices.pop_back();
+            value_of_index[idx] = static_cast<Index>(value_idx);
+        }
+        index_of_value.push_back(idx);
+        return idx;
+    }
+
+    // Makes room so that remove() doesn't allocate, see reserve_for_add().
+    void reserve_for_remove() {
+        grow_when_full(free_indices);
+    }
+
+    // The element at value_idx is removed, and the last element moves there. The removed element's index becomes free,
+    // unless it is the highest one. That one is dropped.
+    void remove(std::size_t value_idx) {
+        auto const idx = index_of_value[value_idx];
+        index_of_value[value_idx] = index_of_value.back();
+        value_of_index[index_of_value[value_idx]] = static_cast<Index>(value_idx);
+        index_of_value.pop_back();
+        if (idx + 1U == value_of_index.size()) {
+            value_of_index.pop_back();
+        } else {
+            free_indices.push_back(idx);
+        }
+    }
+
+    // Index i for the element at position i, for num_elements elements.
+    void assign_identity(std::size_t num_elements) {
+        auto indices = index_container(num_elements, Index{}, index_of_value.get_allocator());
+        for (std::size_t i = 0; i < num_elements; ++i) {
+            indices[i] = static_cast<Index>(i);
+        }
+        auto copy = indices;
+        index_of_value.swap(indices);
+        value_of_index.swap(copy);
+        free_indices.clear();
+    }
+
+    // Renumbers the indices without the free ones, so they are 0 to size() - 1. Their order stays the same.
+    void compact() noexcept {
+        auto new_idx = Index{};
+        for (std::size_t idx = 0; idx < value_of_index.size(); ++idx) {
+            if (!is_free(idx)) {
+                auto const value_idx = value_of_index[idx];
+                value_of_index[new_idx] = value_idx;
+                index_of_value[value_idx] = new_idx;
+                ++new_idx;
+            }
+        }
+        value_of_index.resize(new_idx);
+        free_indices.clear();
+    }
+
+    void clear_indices() noexcept {
+        index_of_value.clear();
+        value_of_index.clear();
+        free_indices.clear();
+    }
+
+    void shrink_to_fit() {
+        index_of_value.shrink_to_fit();
+        value_of_index.shrink_to_fit();
+        free_indices.shrink_to_fit();
+    }
+
+    [[nodiscard]] auto memory_usage() const noexcept -> std::size_t {
+        return sizeof(table_extras) + container_memory_usage(index_of_value) + container_memory_usage(value_of_index) +
+               container_memory_usage(free_indices);
+    }
+
+private:
+    static void grow_when_full(index_container& indices) {
+        if (indices.size() == indices.capacity()) {
+            indices.reserve((std::max)(std::size_t{8}, indices.capacity() * 2));
+        }
+    }
+};
+
+// Owns the table_extras of a table, which are only allocated when needed.
+template <typename Extras>
+class extras_ptr {
+    using alloc = typename std::allocator_traits<typename Extras::allocator_type>::template rebind_alloc<Extras>;
+    using alloc_traits = std::allocator_traits<alloc>;
+
+    typename alloc_traits::pointer m_ptr{};
+
+    // The extras are constructed first, so when allocating them throws there's nothing to clean up.
+    void emplace(Extras&& extras) {
+        auto a = alloc(extras.get_allocator());
+        auto ptr = alloc_traits::allocate(a, 1);
+        alloc_traits::construct(a, std::addressof(*ptr), std::move(extras));
+        reset();
+        m_ptr = ptr;
+    }
+
+public:
+    extras_ptr() = default;
+
+    extras_ptr(extras_ptr const&) = delete;
+    auto operator=(extras_ptr const&) -> extras_ptr& = delete;
+
+    extras_ptr(extras_ptr&& other) noexcept
+        : m_ptr(std::exchange(other.m_ptr, nullptr)) {}
+
+    auto operator=(extras_ptr&& other) noexcept -> extras_ptr& {
+        if (this != &other) {
+            reset();
+            m_ptr = std::exchange(other.m_ptr, nullptr);
+        }
+        return *this;
+    }
+
+    ~extras_ptr() {
+        reset();
+    }
+
+    // nullptr when there are no extras
+    [[nodiscard]] auto get() const noexcept -> Extras* {
+        return m_ptr == nullptr ? nullptr : std::addressof(*m_ptr);
+    }
+
+    auto get_or_create(typename Extras::allocator_type const& alloc_for_new) -> Extras& {
+        if (m_ptr == nullptr) {
+            emplace(Extras(alloc_for_new));
+        }
+        return *m_ptr;
+    }
+
+    // A copy of other's extras, allocated with alloc_for_copy
+    void assign(extras_ptr const& other, typename Extras::allocator_type const& alloc_for_copy) {
+        if (other.m_ptr == nullptr) {
+            reset();
+        } else {
+            emplace(Extras(*other.m_ptr, alloc_for_copy));
+        }
+    }
+
+    void reset() noexcept {
+        if (m_ptr != nullptr) {
+            auto a = alloc(m_ptr->get_allocator());
+            alloc_traits::destroy(a, std::addressof(*m_ptr));
+            alloc_traits::deallocate(a, std::exchange(m_ptr, nullptr), 1);
+        }
+    }
+};
+
+// Random odd constants, see table::bucket_idx_from_hash(). Each table uses one of them.
+inline constexpr auto bucket_multipliers = [] {
+    auto multipliers = std::array<std::uint64_t, 64>{};
+    for (std::size_t i = 0; i < multipliers.size(); ++i) {
+        multipliers[i] = wyhash::hash(i + 1) | 1U;
+    }
+    return multipliers;
+}();
+
+// This is it, the table. Doubles as map and set, and uses `void` for T when its used as a set.
+template <class Key,
+          class T, // when void, treat it as a set.
+          class Hash,
+          class KeyEqual,
+          class AllocatorOrContainer,
+          class Bucket,
+          class BucketContainer,
+          bool IsSegmented,
+          class GrowthPolicy = growth_policy::standard>
+class table : public std::conditional_t<is_map_v<T>, base_table_type_map<T>, base_table_type_set> {
+    using underlying_value_type = std::conditional_t<is_map_v<T>, std::pair<Key, T>, Key>;
+    using underlying_container_type = std::conditional_t<IsSegmented,
+                                                         segmented_vector<underlying_value_type, AllocatorOrContainer>,
+                                                         std::vector<underlying_value_type, AllocatorOrContainer>>;
+
+public:
+    using value_container_type = std::
+        conditional_t<is_detected_v<detect_iterator, AllocatorOrContainer>, AllocatorOrContainer, underlying_container_type>;
+
+private:
+    using bucket_alloc =
+        typename std::allocator_traits<typename value_container_type::allocator_type>::template rebind_alloc<Bucket>;
+    using default_bucket_container_type =
+        std::conditional_t<IsSegmented, segmented_vector<Bucket, bucket_alloc>, bucket_array<Bucket, bucket_alloc>>;
+
+    using bucket_container_type = std::conditional_t<std::is_same_v<BucketContainer, detail::default_container_t>,
+                                                     default_bucket_container_type,
+                                                     BucketContainer>;
+
+    using extras_type = table_extras<decltype(Bucket::m_value_idx), typename value_container_type::allocator_type>;
+
+    static constexpr std::uint8_t default_initial_shifts = 64 - 2; // 4 buckets
+
+    // A bucket container with a fixed capacity limits the number of buckets, m_shifts never goes below this.
+    [[nodiscard]] static constexpr auto calc_min_shifts() -> std::uint8_t {
+        if constexpr (has_fixed_capacity<bucket_container_type>) {
+            constexpr auto capacity = bucket_container_type::fixed_capacity;
+            static_assert(capacity >= (std::size_t{1} << (64U - default_initial_shifts)) && (capacity & (capacity - 1)) == 0,
+                          "a fixed capacity bucket container needs a power of two capacity of at least 4");
+            auto shifts = default_initial_shifts;
+            while ((std::size_t{1} << (64U - shifts)) < capacity) {
+                --shifts;
+            }
+            return shifts;
+        } else {
+            return 0;
+        }
+    }
+
+    static constexpr std::uint8_t min_shifts = calc_min_shifts();
+
+    // 2^(64-m_shift) number of buckets. A fixed capacity bucket container is used completely from the start, so such a
+    // table never rehashes.
+    static constexpr std::uint8_t initial_shifts =
+        has_fixed_capacity<bucket_container_type> ? min_shifts : default_initial_shifts;
+
+    static_assert(GrowthPolicy::bucket_growth_shifts >= 1, "buckets need to grow");
+
+    // the growth policy can only control the values container when it is contiguous and has capacity() and reserve()
+    static constexpr bool has_values_growth_policy =
+        !IsSegmented && !has_fixed_capacity<value_container_type> &&
+        is_detected_v<detect_next_values_capacity, GrowthPolicy> && is_detected_v<detect_capacity, value_container_type> &&
+        has_reserve<value_container_type>;
+    static constexpr float default_max_load_factor = 0.8F;
+
+    // A fixed capacity bucket container can't grow, so its buckets have to hold as many values as there can be. That is the
+    // lowest max_load_factor() such a table can keep, lower ones are clamped to it.
+    [[nodiscard]] static constexpr auto calc_min_max_load_factor() -> float {
+        if constexpr (!has_fixed_capacity<bucket_container_type>) {
+            return 0.0F;
+        } else if constexpr (has_fixed_capacity<value_container_type>) {
+            constexpr auto num_buckets = bucket_container_type::fixed_capacity;
+            return static_cast<float>((std::min)(value_container_type::fixed_capacity, num_buckets)) /
+                   static_cast<float>(num_buckets);
+        } else {
+            return 1.0F;
+        }
+    }
+
+    static constexpr float min_max_load_factor = calc_min_max_load_factor();
+    static constexpr float initial_max_load_factor = (std::max)(default_max_load_factor, min_max_load_factor);
+    static constexpr std::uint32_t max_probe_length_before_reseed = 128; // only used with a seeded hash
+
+public:
+    using key_type = Key;
+    using value_type = typename value_container_type::value_type;
+    using size_type = typename value_container_type::size_type;
+    using difference_type = typename value_container_type::difference_type;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using allocator_type = typename value_container_type::allocator_type;
+    using reference = typename value_container_type::reference;
+    using const_reference = typename value_container_type::const_reference;
+    using pointer = typename value_container_type::pointer;
+    using const_pointer = typename value_container_type::const_pointer;
+    using const_iterator = typename value_container_type::const_iterator;
+    using iterator = std::conditional_t<is_map_v<T>, typename value_container_type::iterator, const_iterator>;
+    using bucket_type = Bucket;
+
+private:
+    using value_idx_type = decltype(Bucket::m_value_idx);
+    using dist_and_fingerprint_type = decltype(Bucket::m_dist_and_fingerprint);
+
+    // find_ptr() points to the mapped value of a map, and to the key of a set.
+    using find_ptr_type = std::conditional_t<is_map_v<T>, T, value_type const>;
+
+public:
+    // Returned by prepare_insert(). When the key was found, position() is the element. Otherwise it remembers the bucket
+    // where the key has to be placed, for commit().
+    class insert_slot {
+        friend class table;
+
+        iterator m_it{};
+        dist_and_fingerprint_type m_dist_and_fingerprint{};
+        value_idx_type m_bucket_idx{};
+        bool m_found = false;
+
+    public:
+        [[nodiscard]] auto found() const noexcept -> bool {
+            return m_found;
+        }
+
+        // The element with the key, only valid when found().
+        [[nodiscard]] auto position() const noexcept -> iterator {
+            return m_it;
+        }
+    };
+
+private:
+
+    static_assert(std::is_trivially_destructible_v<Bucket>, "assert there's no need to call destructor / std::destroy");
+    static_assert(std::is_trivially_copyable_v<Bucket>, "assert we can just memset / memcpy");
+
+    value_container_type m_values{}; // Contains all the key-value pairs in one densely stored container. No holes.
+    bucket_container_type m_buckets{};
+    extras_ptr<extras_type> m_extras{}; // only allocated for stable index mode or a min_load_factor()
+    std::size_t m_max_bucket_capacity = 0;
+    float m_max_load_factor = initial_max_load_factor;
+    Hash m_hash{};
+    KeyEqual m_equal{};
+    std::uint8_t m_shifts = initial_shifts;
+    std::uint8_t m_bucket_multiplier = bucket_multiplier_for(this); // fits into the padding after m_shifts
+#    if ANKERL_UNORDERED_DENSE_STATS
+    mutable operation_stats m_stats{}; // mutable because lookups count too
+    rehash_callback m_on_rehash{};
+#    endif
+
+    [[nodiscard]] auto next(value_idx_type bucket_idx) const -> value_idx_type {
+        if (ANKERL_UNORDERED_DENSE_UNLIKELY(bucket_idx + 1U == bucket_count()))
+            ANKERL_UNORDERED_DENSE_UNLIKELY_ATTR {
+                return 0;
+            }
+
+        return static_cast<value_idx_type>(bucket_idx + 1U);
+    }
+
+    // Helper to access bucket through pointer types
+    [[nodiscard]] static constexpr auto at(bucket_container_type& bucket, std::size_t offset) -> Bucket& {
+        return bucket[offset];
+    }
+
+    [[nodiscard]] static constexpr auto at(const bucket_container_type& bucket, std::size_t offset) -> const Bucket& {
+        return bucket[offset];
+    }
+
+    // use the dist_inc and dist_dec functions so that std::uint16_t types work without warning
+    [[nodiscard]] static constexpr auto dist_inc(dist_and_fingerprint_type x) -> dist_and_fingerprint_type {
+        return static_cast<dist_and_fingerprint_type>(x + Bucket::dist_inc);
+    }
+
+    [[nodiscard]] static constexpr auto dist_dec(dist_and_fingerprint_type x) -> dist_and_fingerprint_type {
+        return static_cast<dist_and_fingerprint_type>(x - Bucket::dist_inc);
+    }
+
+    template <typename K>
+    [[nodiscard]] constexpr auto mixed_hash(K const& key) const -> std::uint64_t {
+        return detail::mixed_hash(m_hash, key);
+    }
+
+    [[nodiscard]] constexpr auto dist_and_fingerprint_from_hash(std::uint64_t hash) const -> dist_and_fingerprint_type {
+        return Bucket::dist_inc | (static_cast<dist_and_fingerprint_type>(hash) & Bucket::fingerprint_mask);
+    }
+
+    // Each table multiplies the hash with a different odd constant before it takes the upper bits as the bucket index, so
+    // the buckets are a different permutation of the hash in each table. Otherwise inserting keys in the bucket order of
+    // another table with the same hash, e.g. when filtering one map into another, would cram all keys into the first few
+    // buckets and degrade quadratically. An xorshift and the multiplication with an odd constant are both bijections, and
+    // they mix all bits into the upper ones, so the distribution is as good as the hash for every multiplier. Only bits
+    // 8..63 are used, the lower 8 bits are the fingerprint, so the bucket index never depends on it. The multiplier is
+    // picked by the address of the table, that's cheaper than a shared counter and just as different between tables that
+    // are alive at the same time.
+    [[nodiscard]] static auto bucket_multiplier_for(void const* table) -> std::uint8_t {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        auto const address = std::uint64_t{reinterpret_cast<std::uintptr_t>(table)};
+        return static_cast<std::uint8_t>(detail::wyhash::hash(address) % bucket_multipliers.size());
+    }
+
+    [[nodiscard]] constexpr auto bucket_idx_from_hash(std::uint64_t hash) const -> value_idx_type {
+        auto x = hash >> 8U;
+        x ^= x >> 32U; // without it, the regular hashes of sequential keys cluster with some of the multipliers
+        return static_cast<value_idx_type>((x * bucket_multipliers[m_bucket_multiplier]) >> m_shifts);
+    }
+
+    [[nodiscard]] static constexpr auto get_key(value_type const& vt) -> key_type const& {
+        if constexpr (is_map_v<T>) {
+            return vt.first;
+        } else {
+            return vt;
+        }
+    }
+
+    // The key in emplace's arguments, see is_emplace_key_extractable.
+    template <typename... Args>
+    [[nodiscard]] static auto get_key_from_args(Args const&... args) -> key_type const& {
+        auto const& arg_tuple = std::forward_as_tuple(args...);
+        if constexpr (sizeof...(Args) == 1) {
+            // not get_key(), a pair of other types would be converted to a temporary value_type
+            if constexpr (is_map_v<T>) {
+                return std::get<0>(arg_tuple).first;
+            } else {
+                return std::get<0>(arg_tuple);
+            }
+        } else if constexpr (sizeof...(Args) == 2) {
+            return std::get<0>(arg_tuple);
+        } else {
+            return std::get<0>(std::get<1>(arg_tuple));
+        }
+    }
+
+    template <typename K>
+    [[nodiscard]] auto next_while_less(K const& key) const -> Bucket {
+        auto hash = mixed_hash(key);
+        auto dist_and_fingerprint = dist_and_fingerprint_from_hash(hash);
+        auto bucket_idx = bucket_idx_from_hash(hash);
+
+        while (dist_and_fingerprint < at(m_buckets, bucket_idx).m_dist_and_fingerprint) {
+            dist_and_fingerprint = dist_inc(dist_and_fingerprint);
+            bucket_idx = next(bucket_idx);
+        }
+        return {dist_and_fingerprint, bucket_idx};
+    }
+
+    template <typename K, typename V>
+    [[nodiscard]] auto is_key_equal(K const& key, V const& value) const -> bool {
+        ANKERL_UNORDERED_DENSE_STATS_ADD(equal_calls, 1U);
+        return m_equal(key, value);
+    }
+
+    void place_and_shift_up(Bucket bucket, value_idx_type place) {
+        while (0 != at(m_buckets, place).m_dist_and_fingerprint) {
+            bucket = std::exchange(at(m_buckets, place), bucket);
+            bucket.m_dist_and_fingerprint = dist_inc(bucket.m_dist_and_fingerprint);
+            place = next(place);
+            ANKERL_UNORDERED_DENSE_STATS_ADD(shift_up_steps, 1U);
+        }
+        at(m_buckets, place) = bucket;
+    }
+
+    void erase_and_shift_down(value_idx_type bucket_idx) {
+        // shift down until either empty or an element with correct spot is found
+        auto next_bucket_idx = next(bucket_idx);
+        while (at(m_buckets, next_bucket_idx).m_dist_and_fingerprint >= Bucket::dist_inc * 2) {
+            auto& next_bucket = at(m_buckets, next_bucket_idx);
+            at(m_buckets, bucket_idx) = {dist_dec(next_bucket.m_dist_and_fingerprint), next_bucket.m_value_idx};
+            bucket_idx = std::exchange(next_bucket_idx, next(next_bucket_idx));
+            ANKERL_UNORDERED_DENSE_STATS_ADD(shift_down_steps, 1U);
+        }
+        at(m_buckets, bucket_idx) = {};
+    }
+
+    [[nodiscard]] static constexpr auto calc_num_buckets(std::uint8_t shifts) -> std::size_t {
+        return (std::min)(max_bucket_count(), std::size_t{1} << (64U - shifts));
+    }
+
+    // Bytes allocated for the buckets with the given shifts. Nothing when they are stored inline.
+    [[nodiscard]] static constexpr auto calc_buckets_memory(std::uint8_t shifts) -> std::size_t {
+        if constexpr (has_fixed_capacity<bucket_container_type>) {
+            return 0;
+        } else {
+            return calc_num_buckets(shifts) * sizeof(Bucket);
+        }
+    }
+
+    [[nodiscard]] static constexpr auto calc_shifts_for_size(std::size_t s, float max_load_factor) -> std::uint8_t {
+        auto shifts = initial_shifts;
+        while (shifts > min_shifts &&
+               static_cast<std::size_t>(static_cast<float>(calc_num_buckets(shifts)) * max_load_factor) < s) {
+            --shifts;
+        }
+        return shifts;
+    }
+
+    [[nodiscard]] constexpr auto calc_shifts_for_size(std::size_t s) const -> std::uint8_t {
+        return calc_shifts_for_size(s, max_load_factor());
+    }
+
+    // assumes m_values has data, m_buckets=m_buckets_end=nullptr, m_shifts is INITIAL_SHIFTS
+    void copy_buckets(table const& other) {
+        // assumes m_values has already the correct data copied over.
+        m_bucket_multiplier = other.m_bucket_multiplier;
+        if (empty()) {
+            // no buckets needed, they are allocated with the first insert.
+            m_shifts = initial_shifts;
+            return;
+        }
+        m_shifts = other.m_shifts;
+        allocate_buckets_from_shift();
+        if constexpr (IsSegmented || !std::is_same_v<BucketContainer, default_container_t>) {
+            for (auto i = 0UL; i < bucket_count(); ++i) {
+                at(m_buckets, i) = at(other.m_buckets, i);
+            }
+        } else {
+            std::memcpy(m_buckets.data(), other.m_buckets.data(), sizeof(Bucket) * bucket_count());
+        }
+    }
+
+    /**
+     * True when no element can be added any more without increasing the size
+     */
+    [[nodiscard]] auto is_full() const -> bool {
+        return size() > m_max_bucket_capacity;
+    }
+
+    void deallocate_buckets() {
+        m_buckets.clear();
+        m_buckets.shrink_to_fit();
+        m_max_bucket_capacity = 0;
+    }
+
+    // An empty table doesn't need any buckets: lookups return before they touch them. So constructing a table never
+    // allocates, the initial buckets are allocated with the first insert. Every insert has to call this before probing.
+    void allocate_buckets_when_missing() {
+        if (ANKERL_UNORDERED_DENSE_UNLIKELY(0 == bucket_count()))
+            ANKERL_UNORDERED_DENSE_UNLIKELY_ATTR {
+                allocate_buckets_from_shift();
+                clear_buckets();
+            }
+    }
+
+    // Back to the state of a newly constructed table, without any buckets. Only valid when the table is empty.
+    void release_buckets() {
+        deallocate_buckets();
+        m_shifts = initial_shifts;
+    }
+
+    void allocate_buckets_from_shift() {
+        auto num_buckets = calc_num_buckets(m_shifts);
+        if constexpr (IsSegmented || !std::is_same_v<BucketContainer, default_container_t>) {
+            if constexpr (has_reserve<bucket_container_type>) {
+                m_buckets.reserve(num_buckets);
+            }
+            for (std::size_t i = m_buckets.size(); i < num_buckets; ++i) {
+                m_buckets.emplace_back();
+            }
+        } else {
+            m_buckets.resize(num_buckets);
+        }
+        if (num_buckets == max_bucket_count()) {
+            // reached the maximum, make sure we can use each bucket
+            m_max_bucket_capacity = max_bucket_count();
+        } else {
+            m_max_bucket_capacity = static_cast<value_idx_type>(static_cast<float>(num_buckets) * max_load_factor());
+        }
+    }
+
+    void clear_buckets() {
+        if constexpr (IsSegmented || !std::is_same_v<BucketContainer, default_container_t>) {
+            for (auto&& e : m_buckets) {
+                std::memset(&e, 0, sizeof(e));
+            }
+        } else if (0 != bucket_count()) {
+            std::memset(m_buckets.data(), 0, sizeof(Bucket) * bucket_count());
+        }
+    }
+
+    void clear_and_fill_buckets_from_values() {
+        clear_buckets();
+        for (value_idx_type value_idx = 0, end_idx = static_cast<value_idx_type>(m_values.size()); value_idx < end_idx;
+             ++value_idx) {
+            auto const& key = get_key(m_values[value_idx]);
+            auto [dist_and_fingerprint, bucket] = next_while_less(key);
+
+            // we know for certain that key has not yet been inserted, so no need to check it.
+            place_and_shift_up({dist_and_fingerprint, value_idx}, bucket);
+        }
+    }
+
+#    if ANKERL_UNORDERED_DENSE_HASH_CHECK
+    static constexpr std::size_t hash_check_sample_interval = 256; // check every 256th insert
+    static constexpr std::size_t hash_check_min_size = 1024;       // small tables don't matter
+    // number of buckets to sample. Near the max load factor a good hash has a cluster of a few hundred buckets now and
+    // then, the window has to be wide enough to average over it.
+    static constexpr std::size_t hash_check_window = 1024;
+
+    // Samples the probe lengths of the buckets following the ideal bucket of the element that was inserted last, and
+    // reports once per key type & hasher when the average is far beyond what a good hash achieves at the current load
+    // factor. This catches hashes that claim is_avalanching but aren't.
+    void check_hash_quality() const {
+        auto& already_reported = poor_hash_reported<Key, Hash>;
+        if (size() < hash_check_min_size || 0 != (size() & (hash_check_sample_interval - 1)) ||
+            already_reported.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        auto bucket_idx = bucket_idx_from_hash(mixed_hash(get_key(m_values.back())));
+        auto num_occupied = std::size_t{};
+        auto sum_probe_lengths = std::size_t{};
+        for (std::size_t i = 0, end = (std::min)(hash_check_window, bucket_count()); i < end; ++i) {
+            auto const dist_and_fingerprint = at(m_buckets, bucket_idx).m_dist_and_fingerprint;
+            if (0 != dist_and_fingerprint) {
+                ++num_occupied;
+                sum_probe_lengths += static_cast<std::size_t>(dist_and_fingerprint / Bucket::dist_inc) - 1U;
+            }
+            bucket_idx = next(bucket_idx);
+        }
+
+        auto const average = static_cast<double>(sum_probe_lengths) / static_cast<double>(num_occupied);
+        auto const expected =
+            expected_probe_length(static_cast<double>(size()) / static_cast<double>(bucket_count()));
+        if (average > expected * 4.0 + 8.0 && !already_reported.exchange(true)) {
+            ANKERL_UNORDERED_DENSE_ON_POOR_HASH((poor_hash_report{
+                type_name<Key>(), type_name<Hash>(), average, expected, size(), bucket_count()}));
+        }
+    }
+#    endif
+
+    // Calls rebuild_buckets, which reallocates and refills the buckets. With ANKERL_UNORDERED_DENSE_STATS this is counted,
+    // timed, and reported to the rehash callback.
+    template <typename Op>
+    void observe_rehash(Op rebuild_buckets) {
+#    if ANKERL_UNORDERED_DENSE_STATS
+        auto const old_bucket_count = bucket_count();
+        auto const start = std::chrono::steady_clock::now();
+        rebuild_buckets();
+        auto const elapsed = std::chrono::steady_clock::now() - start;
+        ++m_stats.rehashes;
+        if (m_on_rehash) {
+            m_on_rehash(rehash_event{old_bucket_count,
+                                     bucket_count(),
+                                     size(),
+                                     std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)});
+        }
+#    else
+        rebuild_buckets();
+#    endif
+    }
+
+    // Only does something for a seeded hash: when an insert had to probe pathologically far, the table is most likely
+    // flooded with keys that collide in the buckets. Rebuild with a new seed to get rid of the collisions.
+    void reseed_when_too_far([[maybe_unused]] dist_and_fingerprint_type dist_and_fingerprint) {
+        if constexpr (is_detected_v<detect_seeded, Hash>) {
+            if (ANKERL_UNORDERED_DENSE_UNLIKELY(dist_and_fingerprint / Bucket::dist_inc > max_probe_length_before_reseed) &&
+                m_hash.reseed()) {
+                observe_rehash([this] {
+                    clear_and_fill_buckets_from_values();
+                });
+            }
+        }
+    }
+
+    // shifts after the buckets grow, by the factor of the growth policy
+    [[nodiscard]] auto next_shifts() const -> std::uint8_t {
+        return static_cast<std::uint8_t>(m_shifts > min_shifts + GrowthPolicy::bucket_growth_shifts
+                                             ? m_shifts - GrowthPolicy::bucket_growth_shifts
+                                             : min_shifts);
+    }
+
+    // Makes room for one more value the way the growth policy wants it, before the container would reallocate by itself.
+    void reserve_values_for_growth() {
+        if constexpr (has_values_growth_policy) {
+            if (ANKERL_UNORDERED_DENSE_UNLIKELY(m_values.size() == m_values.capacity()))
+                ANKERL_UNORDERED_DENSE_UNLIKELY_ATTR {
+                    m_values.reserve((std::min)(GrowthPolicy::next_values_capacity(m_values.capacity()), max_size()));
+                }
+        }
+    }
+
+    void increase_size() {
+        if (m_max_bucket_capacity == max_bucket_count()) {
+            // remove the value again, we can't add it!
+            m_values.pop_back();
+            on_error_bucket_overflow();
+        }
+        ANKERL_UNORDERED_DENSE_STATS_ADD(increase_size_events, 1U);
+        observe_rehash([this] {
+            m_shifts = next_shifts();
+            if constexpr (!IsSegmented || std::is_same_v<BucketContainer, default_container_t>) {
+                deallocate_buckets();
+            }
+            allocate_buckets_from_shift();
+            clear_and_fill_buckets_from_values();
+        });
+    }
+
+    template <typename Op>
+    void do_erase(value_idx_type bucket_idx, Op handle_erased_value) {
+        auto* const stable = stable_extras();
+        if (stable != nullptr) {
+            stable->reserve_for_remove();
+        }
+        auto const value_idx_to_remove = at(m_buckets, bucket_idx).m_value_idx;
+        erase_and_shift_down(bucket_idx);
+        handle_erased_value(std::move(m_values[value_idx_to_remove]));
+        if (stable != nullptr) {
+            // the index of the last element moves along with it
+            stable->remove(value_idx_to_remove);
+        }
+
+        // update m_values
+        if (value_idx_to_remove != m_values.size() - 1) {
+            // no luck, we'll have to replace the value with the last one and update the index accordingly
+            auto& val = m_values[value_idx_to_remove];
+            val = std::move(m_values.back());
+
+            // update the values_idx of the moved entry. No need to play the info game, just look until we find the values_idx
+            bucket_idx = bucket_idx_from_hash(mixed_hash(get_key(val)));
+            auto const values_idx_back = static_cast<value_idx_type>(m_values.size() - 1);
+            while (values_idx_back != at(m_buckets, bucket_idx).m_value_idx) {
+                bucket_idx = next(bucket_idx);
+            }
+            at(m_buckets, bucket_idx).m_value_idx = value_idx_to_remove;
+        }
+        m_values.pop_back();
+        shrink_when_sparse();
+    }
+
+    // Frees the extras once neither stable index mode nor min_load_factor() needs them.
+    void release_unused_extras() noexcept {
+        auto const* const extras = m_extras.get();
+        if (extras != nullptr && !extras->stable_indices && extras->min_load_factor <= 0.0F) {
+            m_extras.reset();
+        }
+    }
+
+    // The extras when stable index mode is on, otherwise nullptr.
+    [[nodiscard]] auto stable_extras() const noexcept -> extras_type* {
+        auto* const extras = m_extras.get();
+        return extras != nullptr && extras->stable_indices ? extras : nullptr;
+    }
+
+    // Only does something with a min_load_factor(): when the load factor has dropped below it, the buckets and the values
+    // are shrunk. The new bucket count gives a load factor of at most max_load_factor() / 2, so it takes many more erases
+    // before the next shrink, and many inserts before the table grows again.
+    void shrink_when_sparse() {
+        auto const* const extras = m_extras.get();
+        if (ANKERL_UNORDERED_DENSE_LIKELY(extras == nullptr ||
+                                          static_cast<float>(m_values.size()) >=
+                                              static_cast<float>(bucket_count()) * extras->min_load_factor))
+            ANKERL_UNORDERED_DENSE_LIKELY_ATTR {
+                return;
+            }
+        if (m_values.empty()) {
+            release_buckets();
+            m_values.shrink_to_fit();
+            return;
+        }
+        auto const shifts = calc_shifts_for_size(m_values.size() * 2);
+        if (shifts > m_shifts) {
+            observe_rehash([&] {
+                m_shifts = shifts;
+                deallocate_buckets();
+                allocate_buckets_from_shift();
+                clear_and_fill_buckets_from_values();
+            });
+            m_values.shrink_to_fit();
+        }
+    }
+
+    template <typename K, typename Op>
+    auto do_erase_key(K&& key, Op handle_erased_value) -> std::size_t { // NOLINT(cppcoreguidelines-missing-std-forward)
+        if (empty()) {
+            return 0;
+        }
+
+        auto [dist_and_fingerprint, bucket_idx] = next_while_less(key);
+
+        while (dist_and_fingerprint == at(m_buckets, bucket_idx).m_dist_and_fingerprint &&
+               !is_key_equal(key, get_key(m_values[at(m_buckets, bucket_idx).m_value_idx]))) {
+            dist_and_fingerprint = dist_inc(dist_and_fingerprint);
+            bucket_idx = next(bucket_idx);
+        }
+
+        if (dist_and_fingerprint != at(m_buckets, bucket_idx).m_dist_and_fingerprint) {
+            return 0;
+        }
+        do_erase(bucket_idx, handle_erased_value);
+        return 1;
+    }
+
+    template <class K, class M>
+    auto do_insert_or_assign(K&& key, M&& mapped) -> std::pair<iterator, bool> {
+        auto it_isinserted = try_emplace(std::forward<K>(key), std::forward<M>(mapped));
+        if (!it_isinserted.second) {
+            it_isinserted.first->second = std::forward<M>(mapped);
+        }
+        return it_isinserted;
+    }
+
+    // Stable index mode: makes room for the index of the element that is about to be added to m_values. Called before
+    // it is added, so when this throws nothing has changed yet.
+    void reserve_stable_index() {
+        if (auto* const stable = stable_extras(); ANKERL_UNORDERED_DENSE_UNLIKELY(stable != nullptr))
+            ANKERL_UNORDERED_DENSE_UNLIKELY_ATTR {
+                stable->reserve_for_add();
+            }
+    }
+
+    // Stable index mode: gives an index to the element that was just added at the back of m_values.
+    void assign_stable_index() {
+        if (auto* const stable = stable_extras(); ANKERL_UNORDERED_DENSE_UNLIKELY(stable != nullptr))
+            ANKERL_UNORDERED_DENSE_UNLIKELY_ATTR {
+                stable->add(m_values.size() - 1);
+            }
+    }
+
+    template <typename... Args>
+    auto do_place_element(dist_and_fingerprint_type dist_and_fingerprint, value_idx_type bucket_idx, Args&&... args)
+        -> std::pair<iterator, bool> {
+
+        // emplace the new value. If that throws an exception, no harm done; index is still in a valid state
+        reserve_values_for_growth();
+        reserve_stable_index();
+        m_values.emplace_back(std::forward<Args>(args)...);
+
+        auto value_idx = static_cast<value_idx_type>(m_values.size() - 1);
+        if (ANKERL_UNORDERED_DENSE_UNLIKELY(is_full()))
+            ANKERL_UNORDERED_DENSE_UNLIKELY_ATTR {
+                increase_size();
+            }
+        else {
+            place_and_shift_up({dist_and_fingerprint, value_idx}, bucket_idx);
+            reseed_when_too_far(dist_and_fingerprint);
+        }
+        assign_stable_index();
+#    if ANKERL_UNORDERED_DENSE_HASH_CHECK
+        check_hash_quality();
+#    endif
+
+        // place element and shift up until we find an empty spot
+        return {begin() + static_cast<difference_type>(value_idx), true};
+    }
+
+    template <typename K, typename... Args>
+    auto do_try_emplace(K&& key, Args&&... args) -> std::pair<iterator, bool> {
+        allocate_buckets_when_missing();
+        auto hash = mixed_hash(key);
+        auto dist_and_fingerprint = dist_and_fingerprint_from_hash(hash);
+        auto bucket_idx = bucket_idx_from_hash(hash);
+
+        while (true) {
+            auto* bucket = &at(m_buckets, bucket_idx);
+            if (dist_and_fingerprint == bucket->m_dist_and_fingerprint) {
+                if (is_key_equal(key, get_key(m_values[bucket->m_value_idx]))) {
+                    return {begin() + static_cast<difference_type>(bucket->m_value_idx), false};
+                }
+            } else if (dist_and_fingerprint > bucket->m_dist_and_fingerprint) {
+                return do_place_element(dist_and_fingerprint,
+                                        bucket_idx,
+                                        std::piecewise_construct,
+                                        std::forward_as_tuple(std::forward<K>(key)),
+                                        std::forward_as_tuple(std::forward<Args>(args)...));
+            }
+            dist_and_fingerprint = dist_inc(dist_and_fingerprint);
+            bucket_idx = next(bucket_idx);
+            ANKERL_UNORDERED_DENSE_STATS_ADD(probe_steps, 1U);
+        }
+    }
+
+    // Same as do_try_emplace, but the value is constructed from args, which already contain the key.
+    template <typename... Args>
+    auto do_emplace_new_key(key_type const& key, Args&&... args) -> std::pair<iterator, bool> {
+        allocate_buckets_when_missing();
+        auto hash = mixed_hash(key);
+        auto dist_and_fingerprint = dist_and_fingerprint_from_hash(hash);
+        auto bucket_idx = bucket_idx_from_hash(hash);
+
+        while (dist_and_fingerprint <= at(m_buckets, bucket_idx).m_dist_and_fingerprint) {
+            if (dist_and_fingerprint == at(m_buckets, bucket_idx).m_dist_and_fingerprint &&
+                is_key_equal(key, get_key(m_values[at(m_buckets, bucket_idx).m_value_idx]))) {
+                return {begin() + static_cast<difference_type>(at(m_buckets, bucket_idx).m_value_idx), false};
+            }
+            dist_and_fingerprint = dist_inc(dist_and_fingerprint);
+            bucket_idx = next(bucket_idx);
+            ANKERL_UNORDERED_DENSE_STATS_ADD(probe_steps, 1U);
+        }
+        return do_place_element(dist_and_fingerprint, bucket_idx, std::forward<Args>(args)...);
+    }
+
+    template <typename K>
+    auto do_prepare_insert(K const& key) -> insert_slot {
+        allocate_buckets_when_missing();
+        auto slot = insert_slot{};
+        auto hash = mixed_hash(key);
+        slot.m_dist_and_fingerprint = dist_and_fingerprint_from_hash(hash);
+        slot.m_bucket_idx = bucket_idx_from_hash(hash);
+
+        while (slot.m_dist_and_fingerprint <= at(m_buckets, slot.m_bucket_idx).m_dist_and_fingerprint) {
+            auto const& bucket = at(m_buckets, slot.m_bucket_idx);
+            if (slot.m_dist_and_fingerprint == bucket.m_dist_and_fingerprint &&
+                is_key_equal(key, get_key(m_values[bucket.m_value_idx]))) {
+                slot.m_it = begin() + static_cast<difference_type>(bucket.m_value_idx);
+                slot.m_found = true;
+                return slot;
+            }
+            slot.m_dist_and_fingerprint = dist_inc(slot.m_dist_and_fingerprint);
+            slot.m_bucket_idx = next(slot.m_bucket_idx);
+            ANKERL_UNORDERED_DENSE_STATS_ADD(probe_steps, 1U);
+        }
+        return slot;
+    }
+
+    // Index of the element with the key in m_values, or m_values.size() when it's not there.
+    template <typename K>
+    auto do_find_idx(K const& key) const -> std::size_t {
+        ANKERL_UNORDERED_DENSE_STATS_ADD(finds, 1U);
+        if (ANKERL_UNORDERED_DENSE_UNLIKELY(empty()))
+            ANKERL_UNORDERED_DENSE_UNLIKELY_ATTR {
+                ANKERL_UNORDERED_DENSE_STATS_ADD(misses, 1U);
+                return m_values.size();
+            }
+
+        auto mh = mixed_hash(key);
+        auto dist_and_fingerprint = dist_and_fingerprint_from_hash(mh);
+        auto bucket_idx = bucket_idx_from_hash(mh);
+        auto const* bucket = &at(m_buckets, bucket_idx);
+
+        // unrolled loop. *Always* check a few directly, then enter the loop. This is faster.
+        if (dist_and_fingerprint == bucket->m_dist_and_fingerprint &&
+            is_key_equal(key, get_key(m_values[bucket->m_value_idx]))) {
+            ANKERL_UNORDERED_DENSE_STATS_ADD(hits, 1U);
+            return bucket->m_value_idx;
+        }
+        dist_and_fingerprint = dist_inc(dist_and_fingerprint);
+        bucket_idx = next(bucket_idx);
+        bucket = &at(m_buckets, bucket_idx);
+        ANKERL_UNORDERED_DENSE_STATS_ADD(probe_steps, 1U);
+
+        if (dist_and_fingerprint == bucket->m_dist_and_fingerprint &&
+            is_key_equal(key, get_key(m_values[bucket->m_value_idx]))) {
+            ANKERL_UNORDERED_DENSE_STATS_ADD(hits, 1U);
+            return bucket->m_value_idx;
+        }
+        dist_and_fingerprint = dist_inc(dist_and_fingerprint);
+        bucket_idx = next(bucket_idx);
+        bucket = &at(m_buckets, bucket_idx);
+        ANKERL_UNORDERED_DENSE_STATS_ADD(probe_steps, 1U);
+
+        while (true) {
+            if (dist_and_fingerprint == bucket->m_dist_and_fingerprint) {
+                if (is_key_equal(key, get_key(m_values[bucket->m_value_idx]))) {
+                    ANKERL_UNORDERED_DENSE_STATS_ADD(hits, 1U);
+                    return bucket->m_value_idx;
+                }
+            } else if (dist_and_fingerprint > bucket->m_dist_and_fingerprint) {
+                ANKERL_UNORDERED_DENSE_STATS_ADD(misses, 1U);
+                return m_values.size();
+            }
+            dist_and_fingerprint = dist_inc(dist_and_fingerprint);
+            bucket_idx = next(bucket_idx);
+            bucket = &at(m_buckets, bucket_idx);
+            ANKERL_UNORDERED_DENSE_STATS_ADD(probe_steps, 1U);
+        }
+    }
+
+    template <typename K>
+    auto do_find(K const& key) -> iterator {
+        return begin() + static_cast<difference_type>(do_find_idx(key));
+    }
+
+    template <typename K>
+    auto do_find(K const& key) const -> const_iterator {
+        return const_cast<table*>(this)->do_find(key); // NOLINT(cppcoreguidelines-pro-type-const-cast)
+    }
+
+    template <typename K, typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
+    auto do_at(K const& key) -> Q& {
+        if (auto it = find(key); ANKERL_UNORDERED_DENSE_LIKELY(end() != it))
+            ANKERL_UNORDERED_DENSE_LIKELY_ATTR {
+                return it->second;
+            }
+        on_error_key_not_found();
+    }
+
+    template <typename K, typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
+    auto do_at(K const& key) const -> Q const& {
+        return const_cast<table*>(this)->at(key); // NOLINT(cppcoreguidelines-pro-type-const-cast)
+    }
+
+    [[nodiscard]] auto make_index(std::size_t idx) const -> std::optional<size_type> {
+        if (idx == m_values.size()) {
+            return std::nullopt;
+        }
+        if (auto const* const stable = stable_extras()) {
+            return static_cast<size_type>(stable->index_of_value[idx]);
+        }
+        return static_cast<size_type>(idx);
+    }
+
+    template <typename K>
+    auto do_find_ptr(K const& key) -> find_ptr_type* {
+        auto const idx = do_find_idx(key);
+        if (idx == m_values.size()) {
+            return nullptr;
+        }
+        if constexpr (is_map_v<T>) {
+            return std::addressof(m_values[idx].second);
+        } else {
+            return std::addressof(m_values[idx]);
+        }
+    }
+
+public:
+    explicit table(std::size_t bucket_count,
+                   Hash const& hash = Hash(),
+                   KeyEqual const& equal = KeyEqual(),
+                   allocator_type const& alloc_or_container = allocator_type())
+        : m_values(alloc_or_container)
+        , m_buckets(alloc_or_container)
+        , m_hash(hash)
+        , m_equal(equal) {
+        if (0 != bucket_count) {
+            reserve(bucket_count);
+        }
+    }
+
+    table()
+        : table(0) {}
+
+    table(std::size_t bucket_count, allocator_type const& alloc)
+        : table(bucket_count, Hash(), KeyEqual(), alloc) {}
+
+    table(std::size_t bucket_count, Hash const& hash, allocator_type const& alloc)
+        : table(bucket_count, hash, KeyEqual(), alloc) {}
+
+    explicit table(allocator_type const& alloc)
+        : table(0, Hash(), KeyEqual(), alloc) {}
+
+    template <class InputIt>
+    table(InputIt first,
+          InputIt last,
+          size_type bucket_count = 0,
+          Hash const& hash = Hash(),
+          KeyEqual const& equal = KeyEqual(),
+          allocator_type const& alloc = allocator_type())
+        : table(bucket_count, hash, equal, alloc) {
+        insert(first, last);
+    }
+
+    template <class InputIt>
+    table(InputIt first, InputIt last, size_type bucket_count, allocator_type const& alloc)
+        : table(first, last, bucket_count, Hash(), KeyEqual(), alloc) {}
+
+    template <class InputIt>
+    table(InputIt first, InputIt last, size_type bucket_count, Hash const& hash, allocator_type const& alloc)
+        : table(first, last, bucket_count, hash, KeyEqual(), alloc) {}
+
+    table(table const& other)
+        : table(other, other.m_values.get_allocator()) {}
+
+    table(table const& other, allocator_type const& alloc)
+        : m_values(other.m_values, alloc)
+        , m_max_load_factor(other.m_max_load_factor)
+        , m_hash(other.m_hash)
+        , m_equal(other.m_equal)
+#    if ANKERL_UNORDERED_DENSE_STATS
+        , m_on_rehash(other.m_on_rehash)
+#    endif
+    {
+        m_extras.assign(other.m_extras, alloc);
+        copy_buckets(other);
+    }
+
+    table(table&& other) noexcept
+        : table(std::move(other), other.m_values.get_allocator()) {}
+
+    table(table&& other, allocator_type const& alloc) noexcept
+        : m_values(alloc) {
+        *this = std::move(other);
+    }
+
+    table(std::initializer_list<value_type> ilist,
+          std::size_t bucket_count = 0,
+          Hash const& hash = Hash(),
+          KeyEqual const& equal = KeyEqual(),
+          allocator_type const& alloc = allocator_type())
+        : table(bucket_count, hash, equal, alloc) {
+        insert(ilist);
+    }
+
+    table(std::initializer_list<value_type> ilist, size_type bucket_count, allocator_type const& alloc)
+        : table(ilist, bucket_count, Hash(), KeyEqual(), alloc) {}
+
+    table(std::initializer_list<value_type> init, size_type bucket_count, Hash const& hash, allocator_type const& alloc)
+        : table(init, bucket_count, hash, KeyEqual(), alloc) {}
+
+    ~table() = default;
+
+    auto operator=(table const& other) -> table& {
+        if (&other != this) {
+            deallocate_buckets(); // deallocate before m_values is set (might have another allocator)
+            m_values = other.m_values;
+            m_extras.assign(other.m_extras, get_allocator());
+            m_max_load_factor = other.m_max_load_factor;
+            m_hash = other.m_hash;
+            m_equal = other.m_equal;
+#    if ANKERL_UNORDERED_DENSE_STATS
+            m_on_rehash = other.m_on_rehash;
+#    endif
+            m_shifts = initial_shifts;
+            copy_buckets(other);
+        }
+        return *this;
+    }
+
+    auto operator=(table&& other) noexcept(noexcept(std::is_nothrow_move_assignable_v<value_container_type> &&
+                                                    std::is_nothrow_move_assignable_v<Hash> &&
+                                                    std::is_nothrow_move_assignable_v<KeyEqual>)) -> table& {
+        if (&other != this) {
+            deallocate_buckets(); // deallocate before m_values is set (might have another allocator)
+            m_values = std::move(other.m_values);
+            other.m_values.clear();
+#    if ANKERL_UNORDERED_DENSE_STATS
+            m_stats = std::exchange(other.m_stats, {});
+            m_on_rehash = std::exchange(other.m_on_rehash, {});
+#    endif
+
+            // we can only reuse m_buckets when both maps have the same allocator!
+            if (get_allocator() == other.get_allocator()) {
+                m_buckets = std::move(other.m_buckets);
+                other.m_buckets.clear();
+                m_extras = std::move(other.m_extras);
+                m_max_bucket_capacity = std::exchange(other.m_max_bucket_capacity, 0);
+                m_shifts = std::exchange(other.m_shifts, initial_shifts);
+                m_bucket_multiplier = other.m_bucket_multiplier;
+                m_max_load_factor = std::exchange(other.m_max_load_factor, initial_max_load_factor);
+                m_hash = std::exchange(other.m_hash, {});
+                m_equal = std::exchange(other.m_equal, {});
+            } else {
+                // set max_load_factor *before* copying the other's buckets, so we have the same
+                // behavior
+                m_max_load_factor = other.m_max_load_factor;
+
+                // copy_buckets sets m_buckets, m_num_buckets, m_max_bucket_capacity, m_shifts
+                m_extras.assign(other.m_extras, get_allocator());
+                copy_buckets(other);
+                // clear's the other's buckets so other is now already usable.
+                other.clear_buckets();
+                m_hash = other.m_hash;
+                m_equal = other.m_equal;
+                other.m_extras.reset();
+            }
+            // map "other" is now already usable, it's empty.
+        }
+        return *this;
+    }
+
+    auto operator=(std::initializer_list<value_type> ilist) -> table& {
+        clear();
+        insert(ilist);
+        return *this;
+    }
+
+    auto get_allocator() const noexcept -> allocator_type {
+        return m_values.get_allocator();
+    }
+
+    // iterators //////////////////////////////////////////////////////////////
+
+    auto begin() noexcept -> iterator {
+        return m_values.begin();
+    }
+
+    auto begin() const noexcept -> const_iterator {
+        return m_values.begin();
+    }
+
+    auto cbegin() const noexcept -> const_iterator {
+        return m_values.cbegin();
+    }
+
+    auto end() noexcept -> iterator {
+        return m_values.end();
+    }
+
+    auto cend() const noexcept -> const_iterator {
+        return m_values.cend();
+    }
+
+    auto end() const noexcept -> const_iterator {
+        return m_values.end();
+    }
+
+    // capacity ///////////////////////////////////////////////////////////////
+
+    [[nodiscard]] auto empty() const noexcept -> bool {
+        return m_values.empty();
+    }
+
+    [[nodiscard]] auto size() const noexcept -> std::size_t {
+        return m_values.size();
+    }
+
+    [[nodiscard]] static constexpr auto max_size() noexcept -> std::size_t {
+        if constexpr ((std::numeric_limits<value_idx_type>::max)() == (std::numeric_limits<std::size_t>::max)()) {
+            return std::size_t{1} << (sizeof(value_idx_type) * 8 - 1);
+        } else {
+            return std::size_t{1} << (sizeof(value_idx_type) * 8);
+        }
+    }
+
+    // modifiers //////////////////////////////////////////////////////////////
+
+    void clear() {
+        m_values.clear();
+        if (auto* const extras = m_extras.get()) {
+            extras->clear_indices();
+        }
+        clear_buckets();
+        shrink_when_sparse();
+    }
+
+    auto insert(value_type const& value) -> std::pair<iterator, bool> {
+        return emplace(value);
+    }
+
+    auto insert(value_type&& value) -> std::pair<iterator, bool> {
+        return emplace(std::move(value));
+    }
+
+    template <class P, std::enable_if_t<std::is_constructible_v<value_type, P&&>, bool> = true>
+    auto insert(P&& value) -> std::pair<iterator, bool> {
+        return emplace(std::forward<P>(value));
+    }
+
+    auto insert(const_iterator /*hint*/, value_type const& value) -> iterator {
+        return insert(value).first;
+    }
+
+    auto insert(const_iterator /*hint*/, value_type&& value) -> iterator {
+        return insert(std::move(value)).first;
+    }
+
+    template <class P, std::enable_if_t<std::is_constructible_v<value_type, P&&>, bool> = true>
+    auto insert(const_iterator /*hint*/, P&& value) -> iterator {
+        return insert(std::forward<P>(value)).first;
+    }
+
+    template <class InputIt>
+    void insert(InputIt first, InputIt last) {
+        while (first != last) {
+            insert(*first);
+            ++first;
+        }
+    }
+
+    void insert(std::initializer_list<value_type> ilist) {
+        insert(ilist.begin(), ilist.end());
+    }
+
+    // nonstandard API: *this is emptied.
+    // Also see "A Standard flat_map" https://www.open-std.org/jtc1/sc22/wg21/docs/papers/2022/p0429r9.pdf
+    auto extract() && -> value_container_type {
+        if (auto* const extras = m_extras.get()) {
+            extras->clear_indices();
+        }
+        return std::move(m_values);
+    }
+
+    // nonstandard API:
+    // Discards the internally held container and replaces it with the one passed. Erases non-unique elements.
+    auto replace(value_container_type&& container) {
+        if (ANKERL_UNORDERED_DENSE_UNLIKELY(container.size() > max_size()))
+            ANKERL_UNORDERED_DENSE_UNLIKELY_ATTR {
+                on_error_too_many_elements();
+            }
+        auto shifts = calc_shifts_for_size(container.size());
+        if (0 == bucket_count() || shifts < m_shifts || container.get_allocator() != m_values.get_allocator()) {
+            m_shifts = shifts;
+            deallocate_buckets();
+            allocate_buckets_from_shift();
+        }
+        clear_buckets();
+
+        m_values = std::move(container);
+        if (auto* const extras = m_extras.get()) {
+            extras->clear_indices();
+        }
+
+        // can't use clear_and_fill_buckets_from_values() because container elements might not be unique
+        auto value_idx = value_idx_type{};
+
+        // loop until we reach the end of the container. duplicated entries will be replaced with back().
+        while (value_idx != static_cast<value_idx_type>(m_values.size())) {
+            auto const& key = get_key(m_values[value_idx]);
+
+            auto hash = mixed_hash(key);
+            auto dist_and_fingerprint = dist_and_fingerprint_from_hash(hash);
+            auto bucket_idx = bucket_idx_from_hash(hash);
+
+            bool key_found = false;
+            while (true) {
+                auto const& bucket = at(m_buckets, bucket_idx);
+                if (dist_and_fingerprint > bucket.m_dist_and_fingerprint) {
+                    break;
+                }
+                if (dist_and_fingerprint == bucket.m_dist_and_fingerprint &&
+                    is_key_equal(key, get_key(m_values[bucket.m_value_idx]))) {
+                    key_found = true;
+                    break;
+                }
+                dist_and_fingerprint = dist_inc(dist_and_fingerprint);
+                bucket_idx = next(bucket_idx);
+            }
+
+            if (key_found) {
+                if (value_idx != static_cast<value_idx_type>(m_values.size() - 1)) {
+                    m_values[value_idx] = std::move(m_values.back());
+                }
+                m_values.pop_back();
+            } else {
+                place_and_shift_up({dist_and_fingerprint, value_idx}, bucket_idx);
+                ++value_idx;
+            }
+        }
+
+        // the new elements get the indices 0 to size() - 1, in their order
+        if (auto* const stable = stable_extras()) {
+            stable->assign_identity(m_values.size());
+        }
+    }
+
+    template <class M, typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
+    auto insert_or_assign(Key const& key, M&& mapped) -> std::pair<iterator, bool> {
+        return do_insert_or_assign(key, std::forward<M>(mapped));
+    }
+
+    template <class M, typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
+    auto insert_or_assign(Key&& key, M&& mapped) -> std::pair<iterator, bool> {
+        return do_insert_or_assign(std::move(key), std::forward<M>(mapped));
+    }
+
+    template <typename K,
+              typename M,
+              typename Q = T,
+              typename H = Hash,
+              typename KE = KeyEqual,
+              std::enable_if_t<is_map_v<Q> && is_transparent_v<H, KE>, bool> = true>
+    auto insert_or_assign(K&& key, M&& mapped) -> std::pair<iterator, bool> {
+        return do_insert_or_assign(std::forward<K>(key), std::forward<M>(mapped));
+    }
+
+    template <class M, typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
+    auto insert_or_assign(const_iterator /*hint*/, Key const& key, M&& mapped) -> iterator {
+        return do_insert_or_assign(key, std::forward<M>(mapped)).first;
+    }
+
+    template <class M, typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
+    auto insert_or_assign(const_iterator /*hint*/, Key&& key, M&& mapped) -> iterator {
+        return do_insert_or_assign(std::move(key), std::forward<M>(mapped)).first;
+    }
+
+    template <typename K,
+              typename M,
+              typename Q = T,
+              typename H = Hash,
+              typename KE = KeyEqual,
+              std::enable_if_t<is_map_v<Q> && is_transparent_v<H, KE>, bool> = true>
+    auto insert_or_assign(const_iterator /*hint*/, K&& key, M&& mapped) -> iterator {
+        return do_insert_or_assign(std::forward<K>(key), std::forward<M>(mapped)).first;
+    }
+
+    // Single arguments for unordered_set can be used without having to construct the value_type
+    template <class K,
+              typename Q = T,
+              typename H = Hash,
+              typename KE = KeyEqual,
+              std::enable_if_t<!is_map_v<Q> && is_transparent_v<H, KE>, bool> = true>
+    auto emplace(K&& key) -> std::pair<iterator, bool> {
+        allocate_buckets_when_missing();
+        auto hash = mixed_hash(key);
+        auto dist_and_fingerprint = dist_and_fingerprint_from_hash(hash);
+        auto bucket_idx = bucket_idx_from_hash(hash);
+
+        while (dist_and_fingerprint <= at(m_buckets, bucket_idx).m_dist_and_fingerprint) {
+            if (dist_and_fingerprint == at(m_buckets, bucket_idx).m_dist_and_fingerprint &&
+                is_key_equal(key, m_values[at(m_buckets, bucket_idx).m_value_idx])) {
+                // found it, return without ever actually creating anything
+                return {begin() + static_cast<difference_type>(at(m_buckets, bucket_idx).m_value_idx), false};
+            }
+            dist_and_fingerprint = dist_inc(dist_and_fingerprint);
+            bucket_idx = next(bucket_idx);
+            ANKERL_UNORDERED_DENSE_STATS_ADD(probe_steps, 1U);
+        }
+
+        // value is new, insert element first, so when exception happens we are in a valid state
+        return do_place_element(dist_and_fingerprint, bucket_idx, std::forward<K>(key));
+    }
+
+    template <class... Args>
+    auto emplace(Args&&... args) -> std::pair<iterator, bool> {
+        if constexpr (is_emplace_key_extractable_v<is_map_v<T>, Key, Args...>) {
+            // The key is right there, so look it up first. The value is only constructed when the key is new.
+            return do_emplace_new_key(get_key_from_args(args...), std::forward<Args>(args)...);
+        } else {
+            // we have to instantiate the value_type to be able to access the key.
+            // 1. emplace_back the object so it is constructed. 2. If the key is already there, pop it later in the loop.
+            allocate_buckets_when_missing();
+            reserve_values_for_growth();
+            reserve_stable_index();
+            auto& key = get_key(m_values.emplace_back(std::forward<Args>(args)...));
+            auto hash = mixed_hash(key);
+            auto dist_and_fingerprint = dist_and_fingerprint_from_hash(hash);
+            auto bucket_idx = bucket_idx_from_hash(hash);
+
+            while (dist_and_fingerprint <= at(m_buckets, bucket_idx).m_dist_and_fingerprint) {
+                if (dist_and_fingerprint == at(m_buckets, bucket_idx).m_dist_and_fingerprint &&
+                    is_key_equal(key, get_key(m_values[at(m_buckets, bucket_idx).m_value_idx]))) {
+                    m_values.pop_back(); // value was already there, so get rid of it
+                    return {begin() + static_cast<difference_type>(at(m_buckets, bucket_idx).m_value_idx), false};
+                }
+                dist_and_fingerprint = dist_inc(dist_and_fingerprint);
+                bucket_idx = next(bucket_idx);
+                ANKERL_UNORDERED_DENSE_STATS_ADD(probe_steps, 1U);
+            }
+
+            // value is new, place the bucket and shift up until we find an empty spot
+            auto value_idx = static_cast<value_idx_type>(m_values.size() - 1);
+            if (ANKERL_UNORDERED_DENSE_UNLIKELY(is_full()))
+                ANKERL_UNORDERED_DENSE_UNLIKELY_ATTR {
+                    // increase_size just rehashes all the data we have in m_values
+                    increase_size();
+                }
+            else {
+                // place element and shift up until we find an empty spot
+                place_and_shift_up({dist_and_fingerprint, value_idx}, bucket_idx);
+                reseed_when_too_far(dist_and_fingerprint);
+            }
+            assign_stable_index();
+#    if ANKERL_UNORDERED_DENSE_HASH_CHECK
+            check_hash_quality();
+#    endif
+            return {begin() + static_cast<difference_type>(value_idx), true};
+        }
+    }
+
+    template <class... Args>
+    auto emplace_hint(const_iterator /*hint*/, Args&&... args) -> iterator {
+        return emplace(std::forward<Args>(args)...).first;
+    }
+
+    template <class... Args, typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
+    auto try_emplace(Key const& key, Args&&... args) -> std::pair<iterator, bool> {
+        return do_try_emplace(key, std::forward<Args>(args)...);
+    }
+
+    template <class... Args, typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
+    auto try_emplace(Key&& key, Args&&... args) -> std::pair<iterator, bool> {
+        return do_try_emplace(std::move(key), std::forward<Args>(args)...);
+    }
+
+    template <class... Args, typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
+    auto try_emplace(const_iterator /*hint*/, Key const& key, Args&&... args) -> iterator {
+        return do_try_emplace(key, std::forward<Args>(args)...).first;
+    }
+
+    template <class... Args, typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
+    auto try_emplace(const_iterator /*hint*/, Key&& key, Args&&... args) -> iterator {
+        return do_try_emplace(std::move(key), std::forward<Args>(args)...).first;
+    }
+
+    template <
+        typename K,
+        typename... Args,
+        typename Q = T,
+        typename H = Hash,
+        typename KE = KeyEqual,
+        std::enable_if_t<is_map_v<Q> && is_transparent_v<H, KE> && is_neither_convertible_v<K&&, iterator, const_iterator>,
+                         bool> = true>
+    auto try_emplace(K&& key, Args&&... args) -> std::pair<iterator, bool> {
+        return do_try_emplace(std::forward<K>(key), std::forward<Args>(args)...);
+    }
+
+    template <
+        typename K,
+        typename... Args,
+        typename Q = T,
+        typename H = Hash,
+        typename KE = KeyEqual,
+        std::enable_if_t<is_map_v<Q> && is_transparent_v<H, KE> && is_neither_convertible_v<K&&, iterator, const_iterator>,
+                         bool> = true>
+    auto try_emplace(const_iterator /*hint*/, K&& key, Args&&... args) -> iterator {
+        return do_try_emplace(std::forward<K>(key), std::forward<Args>(args)...).first;
+    }
+
+    // Two phase insert. prepare_insert() looks up the key, and when it's not there the slot remembers where it has to be
+    // placed. commit() then constructs the element right there without probing again. So an expensive value is only
+    // computed when the key is new, and the key is only looked up once:
+    //
+    //     auto slot = map.prepare_insert(key);
+    //     auto it = slot.found() ? slot.position() : map.commit(slot, key, compute_value(key));
+    //
+    // commit() requires that the key was not found, that it gets a key equal to the one given to prepare_insert(), and that
+    // the table was not modified in between.
+    auto prepare_insert(Key const& key) -> insert_slot {
+        return do_prepare_insert(key);
+    }
+
+    template <class K, class H = Hash, class KE = KeyEqual, std::enable_if_t<is_transparent_v<H, KE>, bool> = true>
+    auto prepare_insert(K const& key) -> insert_slot {
+        return do_prepare_insert(key);
+    }
+
+    // For a map, the mapped value is constructed from args. For a set there are no args.
+    template <typename K, typename... Args>
+    auto commit(insert_slot const& slot, K&& key, Args&&... args) -> iterator {
+        if constexpr (is_map_v<T>) {
+            return do_place_element(slot.m_dist_and_fingerprint,
+                                    slot.m_bucket_idx,
+                                    std::piecewise_construct,
+                                    std::forward_as_tuple(std::forward<K>(key)),
+                                    std::forward_as_tuple(std::forward<Args>(args)...))
+                .first;
+        } else {
+            static_assert(sizeof...(Args) == 0, "a set's element is constructed from the key only");
+            return do_place_element(slot.m_dist_and_fingerprint, slot.m_bucket_idx, std::forward<K>(key)).first;
+        }
+    }
+
+    // Replaces the key at the given iterator with new_key. This does not change any other data in the underlying table, so
+    // all iterators and references remain valid. However, this operation can fail if new_key already exists in the table.
+    // In that case, returns {iterator to the already existing new_key, false} and no change is made.
+    //
+    // In the case of a set, this effectively removes the old key and inserts the new key at the same spot, which is more
+    // efficient than removing the old key and inserting the new key because it avoids repositioning the last element.
+    template <typename K>
+    auto replace_key(iterator it, K&& new_key) -> std::pair<iterator, bool> {
+        auto const new_key_hash = mixed_hash(new_key);
+
+        // first, check if new_key already exists and return if so
+        auto dist_and_fingerprint = dist_and_fingerprint_from_hash(new_key_hash);
+        auto bucket_idx = bucket_idx_from_hash(new_key_hash);
+        while (dist_and_fingerprint <= at(m_buckets, bucket_idx).m_dist_and_fingerprint) {
+            auto const& bucket = at(m_buckets, bucket_idx);
+            if (dist_and_fingerprint == bucket.m_dist_and_fingerprint &&
+                is_key_equal(new_key, get_key(m_values[bucket.m_value_idx]))) {
+                return {begin() + static_cast<difference_type>(bucket.m_value_idx), false};
+            }
+            dist_and_fingerprint = dist_inc(dist_and_fingerprint);
+            bucket_idx = next(bucket_idx);
+        }
+
+        // const_cast is needed because iterator for the set is always const, so adding another get_key overload is not
+        // feasible.
+        auto& target_key = const_cast<key_type&>(get_key(*it));
+        auto const old_key_bucket_idx = bucket_idx_from_hash(mixed_hash(target_key));
+
+        // Replace the key before doing any bucket changes. If it throws, no harm done, we are still in a valid state as we
+        // have not modified any buckets yet.
+        target_key = std::forward<K>(new_key);
+
+        auto const value_idx = static_cast<value_idx_type>(it - begin());
+
+        // Find the bucket containing our value_idx. It's guaranteed we find it, so no other stopping condition needed.
+        bucket_idx = old_key_bucket_idx;
+        while (value_idx != at(m_buckets, bucket_idx).m_value_idx) {
+            bucket_idx = next(bucket_idx);
+        }
+        erase_and_shift_down(bucket_idx);
+
+        // place the new bucket
+        dist_and_fingerprint = dist_and_fingerprint_from_hash(new_key_hash);
+        bucket_idx = bucket_idx_from_hash(new_key_hash);
+        while (dist_and_fingerprint < at(m_buckets, bucket_idx).m_dist_and_fingerprint) {
+            dist_and_fingerprint = dist_inc(dist_and_fingerprint);
+            bucket_idx = next(bucket_idx);
+        }
+        place_and_shift_up({dist_and_fingerprint, value_idx}, bucket_idx);
+
+        return {it, true};
+    }
+
+    // With a min_load_factor() erasing can shrink the values, which invalidates all references and pointers to them.
+    auto erase(iterator it) -> iterator {
+        auto hash = mixed_hash(get_key(*it));
+        auto bucket_idx = bucket_idx_from_hash(hash);
+
+        auto const value_idx_to_remove = static_cast<value_idx_type>(it - cbegin());
+        while (at(m_buckets, bucket_idx).m_value_idx != value_idx_to_remove) {
+            bucket_idx = next(bucket_idx);
+        }
+
+        do_erase(bucket_idx, [](value_type const& /*unused*/) -> void {
+        });
+        return begin() + static_cast<difference_type>(value_idx_to_remove);
+    }
+
+    auto extract(iterator it) -> value_type {
+        auto hash = mixed_hash(get_key(*it));
+        auto bucket_idx = bucket_idx_from_hash(hash);
+
+        auto const value_idx_to_remove = static_cast<value_idx_type>(it - cbegin());
+        while (at(m_buckets, bucket_idx).m_value_idx != value_idx_to_remove) {
+            bucket_idx = next(bucket_idx);
+        }
+
+        auto tmp = std::optional<value_type>{};
+        do_erase(bucket_idx, [&tmp](value_type&& val) -> void {
+            tmp = std::move(val);
+        });
+        return std::move(tmp).value();
+    }
+
+    template <typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
+    auto erase(const_iterator it) -> iterator {
+        return erase(begin() + (it - cbegin()));
+    }
+
+    template <typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
+    auto extract(const_iterator it) -> value_type {
+        return extract(begin() + (it - cbegin()));
+    }
+
+    auto erase(const_iterator first, const_iterator last) -> iterator {
+        auto const idx_first = first - cbegin();
+        auto const idx_last = last - cbegin();
+        auto const first_to_last = std::distance(first, last);
+        auto const last_to_end = std::distance(last, cend());
+
+        // remove elements from left to right which moves elements from the end back
+        auto const mid = idx_first + (std::min)(first_to_last, last_to_end);
+        auto idx = idx_first;
+        while (idx != mid) {
+            erase(begin() + idx);
+            ++idx;
+        }
+
+        // all elements from the right are moved, now remove the last element until all done
+        idx = idx_last;
+        while (idx != mid) {
+            --idx;
+            erase(begin() + idx);
+        }
+
+        return begin() + idx_first;
+    }
+
+    auto erase(Key const& key) -> std::size_t {
+        return do_erase_key(key, [](value_type const& /*unused*/) -> void {
+        });
+    }
+
+    auto extract(Key const& key) -> std::optional<value_type> {
+        auto tmp = std::optional<value_type>{};
+        do_erase_key(key, [&tmp](value_type&& val) -> void {
+            tmp = std::move(val);
+        });
+        return tmp;
+    }
+
+    template <class K, class H = Hash, class KE = KeyEqual, std::enable_if_t<is_transparent_v<H, KE>, bool> = true>
+    auto erase(K&& key) -> std::size_t {
+        return do_erase_key(std::forward<K>(key), [](value_type const& /*unused*/) -> void {
+        });
+    }
+
+    template <class K, class H = Hash, class KE = KeyEqual, std::enable_if_t<is_transparent_v<H, KE>, bool> = true>
+    auto extract(K&& key) -> std::optional<value_type> {
+        auto tmp = std::optional<value_type>{};
+        do_erase_key(std::forward<K>(key), [&tmp](value_type&& val) -> void {
+            tmp = std::move(val);
+        });
+        return tmp;
+    }
+
+    void swap(table& other) noexcept(noexcept(std::is_nothrow_swappable_v<value_container_type> &&
+                                              std::is_nothrow_swappable_v<Hash> && std::is_nothrow_swappable_v<KeyEqual>)) {
+        using std::swap;
+        swap(other, *this);
+    }
+
+    // lookup /////////////////////////////////////////////////////////////////
+
+    template <typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
+    auto at(key_type const& key) -> Q& {
+        return do_at(key);
+    }
+
+    template <typename K,
+              typename Q = T,
+              typename H = Hash,
+              typename KE = KeyEqual,
+              std::enable_if_t<is_map_v<Q> && is_transparent_v<H, KE>, bool> = true>
+    auto at(K const& key) -> Q& {
+        return do_at(key);
+    }
+
+    template <typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
+    auto at(key_type const& key) const -> Q const& {
+        return do_at(key);
+    }
+
+    template <typename K,
+              typename Q = T,
+              typename H = Hash,
+              typename KE = KeyEqual,
+              std::enable_if_t<is_map_v<Q> && is_transparent_v<H, KE>, bool> = true>
+    auto at(K const& key) const -> Q const& {
+        return do_at(key);
+    }
+
+    template <typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
+    auto operator[](Key const& key) -> Q& {
+        return try_emplace(key).first->second;
+    }
+
+    template <typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
+    auto operator[](Key&& key) -> Q& {
+        return try_emplace(std::move(key)).first->second;
+    }
+
+    template <typename K,
+              typename Q = T,
+              typename H = Hash,
+              typename KE = KeyEqual,
+              std::enable_if_t<is_map_v<Q> && is_transparent_v<H, KE>, bool> = true>
+    auto operator[](K&& key) -> Q& {
+        return try_emplace(std::forward<K>(key)).first->second;
+    }
+
+    auto count(Key const& key) const -> std::size_t {
+        return find(key) == end() ? 0 : 1;
+    }
+
+    template <class K, class H = Hash, class KE = KeyEqual, std::enable_if_t<is_transparent_v<H, KE>, bool> = true>
+    auto count(K const& key) const -> std::size_t {
+        return find(key) == end() ? 0 : 1;
+    }
+
+    auto find(Key const& key) -> iterator {
+        return do_find(key);
+    }
+
+    auto find(Key const& key) const -> const_iterator {
+        return do_find(key);
+    }
+
+    template <class K, class H = Hash, class KE = KeyEqual, std::enable_if_t<is_transparent_v<H, KE>, bool> = true>
+    auto find(K const& key) -> iterator {
+        return do_find(key);
+    }
+
+    template <class K, class H = Hash, class KE = KeyEqual, std::enable_if_t<is_transparent_v<H, KE>, bool> = true>
+    auto find(K const& key) const -> const_iterator {
+        return do_find(key);
+    }
+
+    auto contains(Key const& key) const -> bool {
+        return find(key) != end();
+    }
+
+    template <class K, class H = Hash, class KE = KeyEqual, std::enable_if_t<is_transparent_v<H, KE>, bool> = true>
+    auto contains(K const& key) const -> bool {
+        return find(key) != end();
+    }
+
+    // The elements are stored densely in values(), so an element's index there is a compact handle to it. Inserts never
+    // move elements, a new one always gets index size(). rehash(), reserve() and replace_key() keep all indices too.
+    // Removing an element moves the last one into its place: erase() and extract() of a single element change the index of
+    // the last element to the one that was removed. erase() of a range, erase_if(), replace(), clear(), assignment and
+    // swap invalidate all indices. In stable index mode the indices don't change when elements move, see stable_indices().
+    // Unlike indices, pointers and references are invalidated when values() reallocates: on insert, and with a
+    // min_load_factor() also on erase() and extract(), which can shrink it.
+    auto find_index(Key const& key) const -> std::optional<size_type> {
+        return make_index(do_find_idx(key));
+    }
+
+    template <class K, class H = Hash, class KE = KeyEqual, std::enable_if_t<is_transparent_v<H, KE>, bool> = true>
+    auto find_index(K const& key) const -> std::optional<size_type> {
+        return make_index(do_find_idx(key));
+    }
+
+    // nonstandard API: The index of the element at it, as find_index() would return it. it must not be end().
+    [[nodiscard]] auto index_of(const_iterator it) const -> size_type {
+        return *make_index(static_cast<std::size_t>(it - cbegin()));
+    }
+
+    // nonstandard API: In stable index mode an element keeps its index until it is erased, so side arrays that are
+    // indexed the same way never need fixing up. The values stay dense: erase() still moves the last element into the
+    // hole and destroys the erased one, and iterators see exactly the size() elements. Only the index changes meaning, it
+    // no longer is the position in values(). Get it with find_index() or index_of(), and access an element by index with
+    // at_index().
+    //
+    // An erased element's index becomes free, is_free_index() tells, and the next insert takes the most recently freed
+    // one. Index and position are mapped in both directions, which costs two integers per element and a bit more work in
+    // insert and erase. Switching the mode on numbers the elements by their position; switching it off sorts values() by
+    // index, so the indices stay valid, and compact() renumbers them to 0 to size() - 1 first.
+    [[nodiscard]] auto stable_indices() const noexcept -> bool {
+        auto const* const extras = m_extras.get();
+        return extras != nullptr && extras->stable_indices;
+    }
+
+    void stable_indices(bool enabled) {
+        if (enabled == stable_indices()) {
+            return;
+        }
+        auto& extras = m_extras.get_or_create(get_allocator());
+        if (enabled) {
+            extras.assign_identity(m_values.size());
+            extras.stable_indices = true;
+            return;
+        }
+
+        // The buckets point to positions, so they now point to indices, and values() is sorted by index to match.
+        extras.compact();
+        for (std::size_t bucket_idx = 0, num_buckets = bucket_count(); bucket_idx < num_buckets; ++bucket_idx) {
+            auto& bucket = at(m_buckets, bucket_idx);
+            if (0 != bucket.m_dist_and_fingerprint) {
+                bucket.m_value_idx = static_cast<value_idx_type>(extras.index_of_value[bucket.m_value_idx]);
+            }
+        }
+        using std::swap;
+        for (std::size_t value_idx = 0; value_idx < m_values.size(); ++value_idx) {
+            while (extras.index_of_value[value_idx] != value_idx) {
+                auto const idx = static_cast<std::size_t>(extras.index_of_value[value_idx]);
+                swap(m_values[value_idx], m_values[idx]);
+                swap(extras.index_of_value[value_idx], extras.index_of_value[idx]);
+            }
+        }
+        extras.stable_indices = false;
+        release_unused_extras();
+    }
+
+    // True when idx is an index that erase() has freed in stable index mode, and no insert has taken again.
+    [[nodiscard]] auto is_free_index(size_type idx) const noexcept -> bool {
+        auto const* const stable = stable_extras();
+        return stable != nullptr && stable->is_free(idx);
+    }
+
+    // nonstandard API: In stable index mode, renumbers the indices without the free ones, so they are 0 to size() - 1
+    // again. The elements keep the order of their indices, and neither values() nor the buckets change.
+    void compact() noexcept {
+        if (auto* const stable = stable_extras()) {
+            stable->compact();
+        }
+    }
+
+    // Throws std::out_of_range when there is no element with index idx, i.e. idx >= values().size() or, in stable index
+    // mode, idx is not an index that find_index() can return.
+    auto at_index(size_type idx) -> std::conditional_t<is_map_v<T>, value_type&, value_type const&> {
+        if (auto const* const stable = stable_extras(); ANKERL_UNORDERED_DENSE_UNLIKELY(stable != nullptr))
+            ANKERL_UNORDERED_DENSE_UNLIKELY_ATTR {
+                if (idx >= stable->value_of_index.size() || stable->is_free(idx)) {
+                    on_error_index_out_of_range();
+                }
+                return m_values[stable->value_of_index[idx]];
+            }
+        if (ANKERL_UNORDERED_DENSE_UNLIKELY(idx >= m_values.size()))
+            ANKERL_UNORDERED_DENSE_UNLIKELY_ATTR {
+                on_error_index_out_of_range();
+            }
+        return m_values[idx];
+    }
+
+    auto at_index(size_type idx) const -> value_type const& {
+        return const_cast<table*>(this)->at_index(idx); // NOLINT(cppcoreguidelines-pro-type-const-cast)
+    }
+
+    // Pointer to the mapped value of a map or to the key of a set, nullptr when the key is not there.
+    auto find_ptr(Key const& key) -> find_ptr_type* {
+        return do_find_ptr(key);
+    }
+
+    auto find_ptr(Key const& key) const -> find_ptr_type const* {
+        return const_cast<table*>(this)->do_find_ptr(key); // NOLINT(cppcoreguidelines-pro-type-const-cast)
+    }
+
+    template <class K, class H = Hash, class KE = KeyEqual, std::enable_if_t<is_transparent_v<H, KE>, bool> = true>
+    auto find_ptr(K const& key) -> find_ptr_type* {
+        return do_find_ptr(key);
+    }
+
+    template <class K, class H = Hash, class KE = KeyEqual, std::enable_if_t<is_transparent_v<H, KE>, bool> = true>
+    auto find_ptr(K const& key) const -> find_ptr_type const* {
+        return const_cast<table*>(this)->do_find_ptr(key); // NOLINT(cppcoreguidelines-pro-type-const-cast)
+    }
+
+    auto equal_range(Key const& key) -> std::pair<iterator, iterator> {
+        auto it = do_find(key);
+        return {it, it == end() ? end() : it + 1};
+    }
+
+    auto equal_range(const Key& key) const -> std::pair<const_iterator, const_iterator> {
+        auto it = do_find(key);
+        return {it, it == end() ? end() : it + 1};
+    }
+
+    template <class K, class H = Hash, class KE = KeyEqual, std::enable_if_t<is_transparent_v<H, KE>, bool> = true>
+    auto equal_range(K const& key) -> std::pair<iterator, iterator> {
+        auto it = do_find(key);
+        return {it, it == end() ? end() : it + 1};
+    }
+
+    template <class K, class H = Hash, class KE = KeyEqual, std::enable_if_t<is_transparent_v<H, KE>, bool> = true>
+    auto equal_range(K const& key) const -> std::pair<const_iterator, const_iterator> {
+        auto it = do_find(key);
+        return {it, it == end() ? end() : it + 1};
+    }
+
+    // bucket interface ///////////////////////////////////////////////////////
+
+    auto bucket_count() const noexcept -> std::size_t { // NOLINT(modernize-use-nodiscard)
+        return m_buckets.size();
+    }
+
+    static constexpr auto max_bucket_count() noexcept -> std::size_t { // NOLINT(modernize-use-nodiscard)
+        if constexpr (has_fixed_capacity<bucket_container_type>) {
+            return (std::min)(max_size(), bucket_container_type::fixed_capacity);
+        } else {
+            return max_size();
+        }
+    }
+
+    // hash policy ////////////////////////////////////////////////////////////
+
+    [[nodiscard]] auto load_factor() const -> float {
+        return bucket_count() ? static_cast<float>(size()) / static_cast<float>(bucket_count()) : 0.0F;
+    }
+
+    [[nodiscard]] auto max_load_factor() const -> float {
+        return m_max_load_factor;
+    }
+
+    // With a fixed capacity bucket container, e.g. in inplace_map, ml is clamped so that the buckets can hold all values.
+    void max_load_factor(float ml) {
+        ml = (std::max)(ml, min_max_load_factor);
+        m_max_load_factor = ml;
+        if (auto* const extras = m_extras.get()) {
+            extras->min_load_factor = (std::min)(extras->min_load_factor, ml / 4);
+        }
+        if (bucket_count() != max_bucket_count()) {
+            m_max_bucket_capacity = static_cast<value_idx_type>(static_cast<float>(bucket_count()) * max_load_factor());
+        }
+    }
+
+    // nonstandard API: when erase(), clear() or erase_if() make the load factor drop below min_load_factor(), the buckets
+    // and the values are shrunk. 0 (the default) disables this. Limited to max_load_factor() / 4, so there is enough
+    // room between shrinking and growing. Shrinking reallocates the values, so with a min_load_factor() any erase()
+    // can invalidate all iterators, references and pointers, not only those to the erased element. Indices stay valid.
+    [[nodiscard]] auto min_load_factor() const -> float {
+        auto const* const extras = m_extras.get();
+        return extras == nullptr ? 0.0F : extras->min_load_factor;
+    }
+
+    void min_load_factor(float ml) {
+        ml = (std::min)(ml, m_max_load_factor / 4);
+        if (ml > 0.0F || m_extras.get() != nullptr) {
+            m_extras.get_or_create(get_allocator()).min_load_factor = ml;
+            release_unused_extras();
+        }
+    }
+
+    void rehash(std::size_t count) {
+        count = (std::min)(count, max_size());
+        auto shifts = calc_shifts_for_size((std::max)(count, size()));
+        if (shifts != m_shifts) {
+            observe_rehash([&] {
+                m_shifts = shifts;
+                deallocate_buckets();
+                m_values.shrink_to_fit();
+                allocate_buckets_from_shift();
+                clear_and_fill_buckets_from_values();
+            });
+        }
+    }
+
+    // nonstandard API: shrinks the buckets to the smallest count that holds size() elements, and the values container
+    // to its size.
+    void shrink_to_fit() {
+        auto const shifts = calc_shifts_for_size(m_values.size());
+        if (m_values.empty()) {
+            release_buckets();
+        } else if (shifts != m_shifts) {
+            observe_rehash([&] {
+                m_shifts = shifts;
+                deallocate_buckets();
+                allocate_buckets_from_shift();
+                clear_and_fill_buckets_from_values();
+            });
+        }
+        m_values.shrink_to_fit();
+        if (auto* const extras = m_extras.get()) {
+            extras->shrink_to_fit();
+        }
+    }
+
+    void reserve(std::size_t capa) {
+        capa = (std::min)(capa, max_size());
+        if constexpr (has_reserve<value_container_type>) {
+            // std::deque doesn't have reserve(). Make sure we only call when available
+            m_values.reserve(capa);
+        }
+        auto shifts = calc_shifts_for_size((std::max)(capa, size()));
+        if ((0 == bucket_count() && 0 != capa) || shifts < m_shifts) {
+            observe_rehash([&] {
+                m_shifts = shifts;
+                deallocate_buckets();
+                allocate_buckets_from_shift();
+                clear_and_fill_buckets_from_values();
+            });
+        }
+    }
+
+#    if ANKERL_UNORDERED_DENSE_STATS
+    // nonstandard API, only with ANKERL_UNORDERED_DENSE_STATS: operation counters of this table. The counters are moved
+    // along with the table, but not copied.
+    [[nodiscard]] auto stats() const noexcept -> operation_stats const& {
+        return m_stats;
+    }
+
+    void reset_stats() noexcept {
+        m_stats = {};
+    }
+
+    // nonstandard API, only with ANKERL_UNORDERED_DENSE_STATS: called after each rebuild of the buckets, either because
+    // the table has grown or because of rehash() / reserve(). Pass an empty callback to unregister.
+    void set_rehash_callback(rehash_callback callback) {
+        m_on_rehash = std::move(callback);
+    }
+#    endif
+
+    // observers //////////////////////////////////////////////////////////////
+
+    auto hash_function() const -> hasher {
+        return m_hash;
+    }
+
+    auto key_eq() const -> key_equal {
+        return m_equal;
+    }
+
+    // nonstandard API: expose the underlying values container
+    [[nodiscard]] auto values() const noexcept -> value_container_type const& {
+        return m_values;
+    }
+
+    // nonstandard API: number of bytes held by the values and the buckets container. This does not include sizeof(*this),
+    // and not the bookkeeping overhead of the allocator.
+    [[nodiscard]] auto memory_usage() const -> std::size_t {
+        auto const* const extras = m_extras.get();
+        return container_memory_usage(m_values) + container_memory_usage(m_buckets) +
+               (extras == nullptr ? 0 : extras->memory_usage());
+    }
+
+    // nonstandard API: upper bound of memory_usage() while the table grows the next time. Growing the values container
+    // allocates the new capacity while the old one is still held. Growing the buckets frees the old buckets first, except
+    // for a segmented table which just adds to them. For a values container without a growth policy, this assumes
+    // that it doubles.
+    [[nodiscard]] auto growth_peak_memory() const -> std::size_t {
+        auto values_growth = std::size_t{};
+        if constexpr (has_values_growth_policy) {
+            values_growth = GrowthPolicy::next_values_capacity(m_values.capacity()) * sizeof(value_type);
+        } else if constexpr (!IsSegmented && !has_fixed_capacity<value_container_type> &&
+                             is_detected_v<detect_capacity, value_container_type>) {
+            values_growth = (std::max)(std::size_t{1}, m_values.capacity() * 2) * sizeof(value_type);
+        }
+        if (0 == bucket_count()) {
+            // the first insert allocates both, and keeps both
+            return memory_usage() + values_growth + calc_buckets_memory(m_shifts);
+        }
+        auto const buckets_growth = calc_buckets_memory(next_shifts());
+        return memory_usage() + (std::max)(values_growth, buckets_growth);
+    }
+
+    // nonstandard API: number of bytes memory_usage() reports for a map that has reserve()d space for num_elements, with
+    // the default max_load_factor. Useful for capacity planning.
+    [[nodiscard]] static constexpr auto estimated_memory(std::size_t num_elements) -> std::size_t {
+        num_elements = (std::min)(num_elements, max_size());
+        // an empty table doesn't have any buckets
+        auto const num_buckets =
+            0 == num_elements ? std::size_t{} : calc_num_buckets(calc_shifts_for_size(num_elements, default_max_load_factor));
+        return container_estimated_memory<value_container_type>(num_elements) +
+               container_estimated_memory<bucket_container_type>(num_buckets);
+    }
+
+    // nonstandard API: distribution of probe lengths of all elements. This walks all buckets, so it's O(bucket_count()).
+    // A high average probe length means the hash is of bad quality for the inserted keys.
+    [[nodiscard]] auto probe_stats() const -> probe_statistics {
+        auto stats = probe_statistics{};
+        auto num_empty_buckets = std::size_t{};
+        auto sum_probe_lengths = std::size_t{};
+        for (std::size_t bucket_idx = 0, num_buckets = bucket_count(); bucket_idx < num_buckets; ++bucket_idx) {
+            auto const dist_and_fingerprint = at(m_buckets, bucket_idx).m_dist_and_fingerprint;
+            if (0 == dist_and_fingerprint) {
+                ++num_empty_buckets;
+                continue;
+            }
+            auto const probe_length = static_cast<std::size_t>(dist_and_fingerprint / Bucket::dist_inc) - 1U;
+            if (probe_length >= stats.histogram.size()) {
+                stats.histogram.resize(probe_length + 1U);
+            }
+            ++stats.histogram[probe_length];
+            sum_probe_lengths += probe_length;
+            stats.max_probe_length = (std::max)(stats.max_probe_length, probe_length);
+        }
+        if (!empty()) {
+            stats.average_probe_length = static_cast<double>(sum_probe_lengths) / static_cast<double>(size());
+        }
+        if (0 != bucket_count()) {
+            stats.empty_bucket_fraction = static_cast<double>(num_empty_buckets) / static_cast<double>(bucket_count());
+        }
+        return stats;
+    }
+
+    // non-member functions ///////////////////////////////////////////////////
+
+    friend auto operator==(table const& a, table const& b) -> bool {
+        if (&a == &b) {
+            return true;
+        }
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (auto const& b_entry : b) {
+            auto it = a.find(get_key(b_entry));
+            if constexpr (is_map_v<T>) {
+                // map: check that key is here, then also check that value is the same
+                if (a.end() == it || !(b_entry.second == it->second)) {
+                    return false;
+                }
+            } else {
+                // set: only check that the key is here
+                if (a.end() == it) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    friend auto operator!=(table const& a, table const& b) -> bool {
+        return !(a == b);
+    }
+};
+
+} // namespace detail
+
+template <class Key,
+          class T,
+          class Hash = hash<Key>,
+          class KeyEqual = std::equal_to<Key>,
+          class AllocatorOrContainer = std::allocator<std::pair<Key, T>>,
+          class Bucket = bucket_type::standard,
+          class BucketContainer = detail::default_container_t,
+          class GrowthPolicy = growth_policy::standard>
+using map = detail::table<Key, T, Hash, KeyEqual, AllocatorOrContainer, Bucket, BucketContainer, false, GrowthPolicy>;
+
+template <class Key,
+          class T,
+          class Hash = hash<Key>,
+          class KeyEqual = std::equal_to<Key>,
+          class AllocatorOrContainer = std::allocator<std::pair<Key, T>>,
+          class Bucket = bucket_type::standard,
+          class BucketContainer = detail::default_container_t,
+          class GrowthPolicy = growth_policy::standard>
+using segmented_map =
+    detail::table<Key, T, Hash, KeyEqual, AllocatorOrContainer, Bucket, BucketContainer, true, GrowthPolicy>;
+
+template <class Key,
+          class Hash = hash<Key>,
+          class KeyEqual = std::equal_to<Key>,
+          class AllocatorOrContainer = std::allocator<Key>,
+          class Bucket = bucket_type::standard,
+          class BucketContainer = detail::default_container_t,
+          class GrowthPolicy = growth_policy::standard>
+using set = detail::table<Key, void, Hash, KeyEqual, AllocatorOrContainer, Bucket, BucketContainer, false, GrowthPolicy>;
+
+template <class Key,
+          class Hash = hash<Key>,
+          class KeyEqual = std::equal_to<Key>,
+          class AllocatorOrContainer = std::allocator<Key>,
+          class Bucket = bucket_type::standard,
+          class BucketContainer = detail::default_container_t,
+          class GrowthPolicy = growth_policy::standard>
+using segmented_set =
+    detail::table<Key, void, Hash, KeyEqual, AllocatorOrContainer, Bucket, BucketContainer, true, GrowthPolicy>;
+
+// A map with a small sizeof, for when there are many of them. The values and the buckets are each stored in a
+// compact_vector, which keeps its size and capacity in the allocation.
+template <class Key,
+          class T,
+          class Hash = hash<Key>,
+          class KeyEqual = std::equal_to<Key>,
+          class Allocator = std::allocator<std::pair<Key, T>>,
+          class Bucket = bucket_type::standard,
+          class GrowthPolicy = growth_policy::standard>
+using compact_map =
+    detail::table<Key,
+                  T,
+                  Hash,
+                  KeyEqual,
+                  compact_vector<std::pair<Key, T>, Allocator>,
+                  Bucket,
+                  compact_vector<Bucket, typename std::allocator_traits<Allocator>::template rebind_alloc<Bucket>>,
+                  false,
+                  GrowthPolicy>;
+
+// A set with a small sizeof, like compact_map.
+template <class Key,
+          class Hash = hash<Key>,
+          class KeyEqual = std::equal_to<Key>,
+          class Allocator = std::allocator<Key>,
+          class Bucket = bucket_type::standard,
+          class GrowthPolicy = growth_policy::standard>
+using compact_set =
+    detail::table<Key,
+                  void,
+                  Hash,
+                  KeyEqual,
+                  compact_vector<Key, Allocator>,
+                  Bucket,
+                  compact_vector<Bucket, typename std::allocator_traits<Allocator>::template rebind_alloc<Bucket>>,
+                  false,
+                  GrowthPolicy>;
+
+// static_map /////////////////////////////////////////////////////////////////
+
+// An immutable map with a fixed number of elements, where both the values and the index are built in a constant
+// expression. A constexpr static_map is initialized at compile time, so there is no startup cost at all. Lookups work
+// exactly like in ankerl::unordered_dense::map. The hash needs to be usable in a constant expression, e.g.
+// ankerl::unordered_dense::hash for integral types, enums, and std::basic_string_view.
+template <class Key, class T, std::size_t N, class Hash = hash<Key>, class KeyEqual = std::equal_to<Key>>
+class static_map {
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<Key, T>;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using reference = value_type const&;
+    using const_reference = value_type const&;
+    using pointer = value_type const*;
+    using const_pointer = value_type const*;
+    using iterator = value_type const*;
+    using const_iterator = value_type const*;
+    using bucket_type = ankerl::unordered_dense::bucket_type::standard;
+
+private:
+    using value_idx_type = decltype(bucket_type::m_value_idx);
+    using dist_and_fingerprint_type = decltype(bucket_type::m_dist_and_fingerprint);
+
+    // smallest power of two that keeps the load factor at or below 0.8, but at least 4 buckets.
+    [[nodiscard]] static constexpr auto calc_num_buckets() -> std::size_t {
+        auto num_buckets = std::size_t{4};
+        while (num_buckets * 4U < N * 5U) {
+            num_buckets *= 2U;
+        }
+        return num_buckets;
+    }
+
+    [[nodiscard]] static constexpr auto calc_shifts() -> std::uint8_t {
+        auto shifts = std::uint8_t{64};
+        for (auto num_buckets = calc_num_buckets(); num_buckets > 1U; num_buckets >>= 1U) {
+            --shifts;
+        }
+        return shifts;
+    }
+
+    static constexpr std::size_t num_buckets = calc_num_buckets();
+    static constexpr std::uint8_t shifts = calc_shifts();
+
+    static_assert(N < (std::size_t{1} << 24U), "static_map is meant for small tables");
+
+    std::array<value_type, N> m_values;
+    std::array<bucket_type, num_buckets> m_buckets{};
+    Hash m_hash{};
+    KeyEqual m_equal{};
 
-    table(table&& other, allocator_type const& alloc) noexcept
-        : m_values(alloc) {
-        *this = std::move(other);
+    [[nodiscard]] static constexpr auto next(std::size_t bucket_idx) -> std::size_t {
+        return (bucket_idx + 1U) & (num_buckets - 1U);
     }
 
-    table(std::initializer_list<value_type> ilist,
-          std::size_t bucket_count = 0,
-          Hash const& hash = Hash(),
-          KeyEqual const& equal = KeyEqual(),
-          allocator_type const& alloc = allocator_type())
-        : table(bucket_count, hash, equal, alloc) {
-        insert(ilist);
+    [[nodiscard]] static constexpr auto dist_inc(dist_and_fingerprint_type x) -> dist_and_fingerprint_type {
+        return x + bucket_type::dist_inc;
     }
 
-    table(std::initializer_list<value_type> ilist, size_type bucket_count, allocator_type const& alloc)
-        : table(ilist, bucket_count, Hash(), KeyEqual(), alloc) {}
-
-    table(std::initializer_list<value_type> init, size_type bucket_count, Hash const& hash, allocator_type const& alloc)
-        : table(init, bucket_count, hash, KeyEqual(), alloc) {}
+    [[nodiscard]] static constexpr auto dist_and_fingerprint_from_hash(std::uint64_t hash) -> dist_and_fingerprint_type {
+        return bucket_type::dist_inc | (static_cast<dist_and_fingerprint_type>(hash) & bucket_type::fingerprint_mask);
+    }
 
-    ~table() = default;
+#    if defined(__GNUC__) && !defined(__clang__)
+#        pragma GCC diagnostic push
+#        pragma GCC diagnostic ignored "-Wuseless-cast" // only useless on 64bit
+#    endif
+    [[nodiscard]] static constexpr auto bucket_idx_from_hash(std::uint64_t hash) -> std::size_t {
+        return static_cast<std::size_t>(hash >> shifts);
+    }
+#    if defined(__GNUC__) && !defined(__clang__)
+#        pragma GCC diagnostic pop
+#    endif
 
-    auto operator=(table const& other) -> table& {
-        if (&other != this) {
-            deallocate_buckets(); // deallocate before m_values is set (might have another allocator)
-            m_values = other.m_values;
-            m_max_load_factor = other.m_max_load_factor;
-            m_hash = other.m_hash;
-            m_equal = other.m_equal;
-            m_shifts = initial_shifts;
-            copy_buckets(other);
+    template <typename Init, std::size_t... Idx>
+    constexpr static_map(Init const& init, std::index_sequence<Idx...> /*unused*/, Hash const& hash, KeyEqual const& equal)
+        : m_values{{init[Idx]...}}
+        , m_hash(hash)
+        , m_equal(equal) {
+        for (std::size_t value_idx = 0; value_idx < N; ++value_idx) {
+            insert_bucket(value_idx);
         }
-        return *this;
     }
 
-    auto operator=(table&& other) noexcept(noexcept(std::is_nothrow_move_assignable_v<value_container_type> &&
-                                                    std::is_nothrow_move_assignable_v<Hash> &&
-                                                    std::is_nothrow_move_assignable_v<KeyEqual>)) -> table& {
-        if (&other != this) {
-            deallocate_buckets(); // deallocate before m_values is set (might have another allocator)
-            m_values = std::move(other.m_values);
-            other.m_values.clear();
-
-            // we can only reuse m_buckets when both maps have the same allocator!
-            if (get_allocator() == other.get_allocator()) {
-                m_buckets = std::move(other.m_buckets);
-                other.m_buckets.clear();
-                m_max_bucket_capacity = std::exchange(other.m_max_bucket_capacity, 0);
-                m_shifts = std::exchange(other.m_shifts, initial_shifts);
-                m_max_load_factor = std::exchange(other.m_max_load_factor, default_max_load_factor);
-                m_hash = std::exchange(other.m_hash, {});
-                m_equal = std::exchange(other.m_equal, {});
-                other.allocate_buckets_from_shift();
-                other.clear_buckets();
-            } else {
-                // set max_load_factor *before* copying the other's buckets, so we have the same
-                // behavior
-                m_max_load_factor = other.m_max_load_factor;
+    // Same robin-hood insertion as in the table, but written so that it can be evaluated at compile time.
+    constexpr void insert_bucket(std::size_t value_idx) {
+        auto const& key = m_values[value_idx].first;
+        auto hash = detail::mixed_hash(m_hash, key);
+        auto dist_and_fingerprint = dist_and_fingerprint_from_hash(hash);
+        auto bucket_idx = bucket_idx_from_hash(hash);
 
-                // copy_buckets sets m_buckets, m_num_buckets, m_max_bucket_capacity, m_shifts
-                copy_buckets(other);
-                // clear's the other's buckets so other is now already usable.
-                other.clear_buckets();
-                m_hash = other.m_hash;
-                m_equal = other.m_equal;
+        while (dist_and_fingerprint <= m_buckets[bucket_idx].m_dist_and_fingerprint) {
+            if (dist_and_fingerprint == m_buckets[bucket_idx].m_dist_and_fingerprint &&
+                m_equal(key, m_values[m_buckets[bucket_idx].m_value_idx].first)) {
+                detail::on_error_invalid_static_map();
             }
-            // map "other" is now already usable, it's empty.
+            dist_and_fingerprint = dist_inc(dist_and_fingerprint);
+            bucket_idx = next(bucket_idx);
         }
-        return *this;
-    }
 
-    auto operator=(std::initializer_list<value_type> ilist) -> table& {
-        clear();
-        insert(ilist);
-        return *this;
+        auto bucket = bucket_type{dist_and_fingerprint, static_cast<value_idx_type>(value_idx)};
+        while (0 != m_buckets[bucket_idx].m_dist_and_fingerprint) {
+            auto tmp = m_buckets[bucket_idx];
+            m_buckets[bucket_idx] = bucket;
+            bucket = tmp;
+            bucket.m_dist_and_fingerprint = dist_inc(bucket.m_dist_and_fingerprint);
+            bucket_idx = next(bucket_idx);
+        }
+        m_buckets[bucket_idx] = bucket;
     }
 
-    auto get_allocator() const noexcept -> allocator_type {
-        return m_values.get_allocator();
+    template <typename K>
+    [[nodiscard]] constexpr auto do_find(K const& key) const -> const_iterator {
+        auto hash = detail::mixed_hash(m_hash, key);
+        auto dist_and_fingerprint = dist_and_fingerprint_from_hash(hash);
+        auto bucket_idx = bucket_idx_from_hash(hash);
+
+        while (true) {
+            auto const& bucket = m_buckets[bucket_idx];
+            if (dist_and_fingerprint == bucket.m_dist_and_fingerprint) {
+                if (m_equal(key, m_values[bucket.m_value_idx].first)) {
+                    return begin() + bucket.m_value_idx;
+                }
+            } else if (dist_and_fingerprint > bucket.m_dist_and_fingerprint) {
+                return end();
+            }
+            dist_and_fingerprint = dist_inc(dist_and_fingerprint);
+            bucket_idx = next(bucket_idx);
+        }
     }
 
+public:
+    // Exactly N elements have to be provided, and all keys need to be unique.
+    constexpr static_map(std::initializer_list<value_type> ilist, Hash const& hash = Hash(), KeyEqual const& equal = KeyEqual())
+        : static_map((ilist.size() == N ? ilist.begin() : (detail::on_error_invalid_static_map(), ilist.begin())),
+                     std::make_index_sequence<N>{},
+                     hash,
+                     equal) {}
+
+    template <std::size_t M, std::enable_if_t<M == N && (M > 0), bool> = true>
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays,hicpp-avoid-c-arrays,modernize-avoid-c-arrays)
+    constexpr explicit static_map(value_type const (&values)[M], Hash const& hash = Hash(), KeyEqual const& equal = KeyEqual())
+        : static_map(values, std::make_index_sequence<N>{}, hash, equal) {}
+
     // iterators //////////////////////////////////////////////////////////////
 
-    auto begin() noexcept -> iterator {
-        return m_values.begin();
+    [[nodiscard]] constexpr auto begin() const noexcept -> const_iterator {
+        return m_values.data();
     }
 
-    auto begin() const noexcept -> const_iterator {
-        return m_values.begin();
+    [[nodiscard]] constexpr auto cbegin() const noexcept -> const_iterator {
+        return m_values.data();
     }
 
-    auto cbegin() const noexcept -> const_iterator {
-        return m_values.cbegin();
+    [[nodiscard]] constexpr auto end() const noexcept -> const_iterator {
+        return m_values.data() + N;
     }
 
-    auto end() noexcept -> iterator {
-        return m_values.end();
+    [[nodiscard]] constexpr auto cend() const noexcept -> const_iterator {
+        return m_values.data() + N;
     }
 
-    auto cend() const noexcept -> const_iterator {
-        return m_values.cend();
+    // capacity ///////////////////////////////////////////////////////////////
+
+    [[nodiscard]] constexpr auto empty() const noexcept -> bool {
+        return 0 == N;
     }
 
-    auto end() const noexcept -> const_iterator {
-        return m_values.end();
+    [[nodiscard]] constexpr auto size() const noexcept -> std::size_t {
+        return N;
     }
 
-    // capacity ///////////////////////////////////////////////////////////////
+    [[nodiscard]] static constexpr auto max_size() noexcept -> std::size_t {
+        return N;
+    }
 
-    [[nodiscard]] auto empty() const noexcept -> bool {
-        return m_values.empty();
+    [[nodiscard]] static constexpr auto bucket_count() noexcept -> std::size_t {
+        return num_buckets;
     }
 
-    [[nodiscard]] auto size() const noexcept -> std::size_t {
-        return m_values.size();
+    // lookup /////////////////////////////////////////////////////////////////
+
+    [[nodiscard]] constexpr auto at(key_type const& key) const -> T const& {
+        if (auto it = find(key); ANKERL_UNORDERED_DENSE_LIKELY(end() != it))
+            ANKERL_UNORDERED_DENSE_LIKELY_ATTR {
+                return it->second;
+            }
+        detail::on_error_key_not_found();
     }
 
-    [[nodiscard]] static constexpr auto max_size() noexcept -> std::size_t {
-        if constexpr ((std::numeric_limits<value_idx_type>::max)() == (std::numeric_limits<std::size_t>::max)()) {
-            return std::size_t{1} << (sizeof(value_idx_type) * 8 - 1);
-        } else {
-            return std::size_t{1} << (sizeof(value_idx_type) * 8);
-        }
+    template <class K, class H = Hash, class KE = KeyEqual, std::enable_if_t<detail::is_transparent_v<H, KE>, bool> = true>
+    [[nodiscard]] constexpr auto at(K const& key) const -> T const& {
+        if (auto it = find(key); ANKERL_UNORDERED_DENSE_LIKELY(end() != it))
+            ANKERL_UNORDERED_DENSE_LIKELY_ATTR {
+                return it->second;
+            }
+        detail::on_error_key_not_found();
     }
 
-    // modifiers //////////////////////////////////////////////////////////////
+    [[nodiscard]] constexpr auto count(key_type const& key) const -> std::size_t {
+        return find(key) == end() ? 0 : 1;
+    }
 
-    void clear() {
-        m_values.clear();
-        clear_buckets();
+    template <class K, class H = Hash, class KE = KeyEqual, std::enable_if_t<detail::is_transparent_v<H, KE>, bool> = true>
+    [[nodiscard]] constexpr auto count(K const& key) const -> std::size_t {
+        return find(key) == end() ? 0 : 1;
     }
 
-    auto insert(value_type const& value) -> std::pair<iterator, bool> {
-        return emplace(value);
+    [[nodiscard]] constexpr auto find(key_type const& key) const -> const_iterator {
+        return do_find(key);
     }
 
-    auto insert(value_type&& value) -> std::pair<iterator, bool> {
-        return emplace(std::move(value));
+    template <class K, class H = Hash, class KE = KeyEqual, std::enable_if_t<detail::is_transparent_v<H, KE>, bool> = true>
+    [[nodiscard]] constexpr auto find(K const& key) const -> const_iterator {
+        return do_find(key);
     }
 
-    template <class P, std::enable_if_t<std::is_constructible_v<value_type, P&&>, bool> = true>
-    auto insert(P&& value) -> std::pair<iterator, bool> {
-        return emplace(std::forward<P>(value));
+    [[nodiscard]] constexpr auto contains(key_type const& key) const -> bool {
+        return find(key) != end();
     }
 
-    auto insert(const_iterator /*hint*/, value_type const& value) -> iterator {
-        return insert(value).first;
+    template <class K, class H = Hash, class KE = KeyEqual, std::enable_if_t<detail::is_transparent_v<H, KE>, bool> = true>
+    [[nodiscard]] constexpr auto contains(K const& key) const -> bool {
+        return find(key) != end();
     }
 
-    auto insert(const_iterator /*hint*/, value_type&& value) -> iterator {
-        return insert(std::move(value)).first;
+    // observers //////////////////////////////////////////////////////////////
+
+    [[nodiscard]] constexpr auto hash_function() const -> hasher {
+        return m_hash;
     }
 
-    template <class P, std::enable_if_t<std::is_constructible_v<value_type, P&&>, bool> = true>
-    auto insert(const_iterator /*hint*/, P&& value) -> iterator {
-        return insert(std::forward<P>(value)).first;
+    [[nodiscard]] constexpr auto key_eq() const -> key_equal {
+        return m_equal;
     }
+};
 
-    template <class InputIt>
-    void insert(InputIt first, InputIt last) {
-        while (first != last) {
-            insert(*first);
-            ++first;
+// Creates a static_map and deduces the number of elements, e.g.
+// constexpr auto m = make_static_map<std::string_view, int>({{"one", 1}, {"two", 2}});
+template <class Key, class T, class Hash = hash<Key>, class KeyEqual = std::equal_to<Key>, std::size_t N>
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays,hicpp-avoid-c-arrays,modernize-avoid-c-arrays)
+[[nodiscard]] constexpr auto make_static_map(std::pair<Key, T> const (&values)[N]) -> static_map<Key, T, N, Hash, KeyEqual> {
+    return static_map<Key, T, N, Hash, KeyEqual>(values);
+}
+
+// small_map and small_set ////////////////////////////////////////////////////
+
+namespace detail {
+
+// Holds up to N elements inline, without any allocation and without buckets. Lookups compare the keys one after the other,
+// which for a handful of elements is faster than hashing. The (N+1)th element moves everything into a regular table, and
+// the elements stay there until shrink_to_fit() brings them back. Iterators are pointers to the contiguous elements, so
+// like in the table they are invalidated by inserts and erases.
+template <class Key, class T, std::size_t N, class Hash, class KeyEqual, class Allocator>
+class small_table : public std::conditional_t<is_map_v<T>, base_table_type_map<T>, base_table_type_set> {
+    static_assert(N > 0, "small_table needs room for at least one inline element");
+
+    using table_type =
+        table<Key, T, Hash, KeyEqual, Allocator, bucket_type::standard, default_container_t, false, growth_policy::standard>;
+
+public:
+    using key_type = Key;
+    using value_type = typename table_type::value_type;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using allocator_type = typename table_type::allocator_type;
+    using reference = std::conditional_t<is_map_v<T>, value_type&, value_type const&>;
+    using const_reference = value_type const&;
+    using pointer = std::conditional_t<is_map_v<T>, value_type*, value_type const*>;
+    using const_pointer = value_type const*;
+    using iterator = pointer;
+    using const_iterator = const_pointer;
+
+private:
+    // the first m_num_inline elements are constructed. NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init)
+    alignas(value_type) std::array<std::byte, sizeof(value_type) * N> m_inline;
+    std::size_t m_num_inline = 0;
+    bool m_is_inline = true;
+    table_type m_table; // empty while the elements are inline, and then it doesn't allocate anything
+
+    [[nodiscard]] static auto get_key(value_type const& vt) -> key_type const& {
+        if constexpr (is_map_v<T>) {
+            return vt.first;
+        } else {
+            return vt;
         }
     }
 
-    void insert(std::initializer_list<value_type> ilist) {
-        insert(ilist.begin(), ilist.end());
+    [[nodiscard]] auto inline_data() noexcept -> value_type* {
+        return reinterpret_cast<value_type*>(m_inline.data()); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
     }
 
-    // nonstandard API: *this is emptied.
-    // Also see "A Standard flat_map" https://www.open-std.org/jtc1/sc22/wg21/docs/papers/2022/p0429r9.pdf
-    auto extract() && -> value_container_type {
-        return std::move(m_values);
+    [[nodiscard]] auto inline_data() const noexcept -> value_type const* {
+        return reinterpret_cast<value_type const*>(m_inline.data()); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
     }
 
-    // nonstandard API:
-    // Discards the internally held container and replaces it with the one passed. Erases non-unique elements.
-    auto replace(value_container_type&& container) {
-        if (ANKERL_UNORDERED_DENSE_UNLIKELY(container.size() > max_size()))
-            ANKERL_UNORDERED_DENSE_UNLIKELY_ATTR {
-                on_error_too_many_elements();
-            }
-        auto shifts = calc_shifts_for_size(container.size());
-        if (0 == bucket_count() || shifts < m_shifts || container.get_allocator() != m_values.get_allocator()) {
-            m_shifts = shifts;
-            deallocate_buckets();
-            allocate_buckets_from_shift();
-        }
-        clear_buckets();
-
-        m_values = std::move(container);
+    [[nodiscard]] auto table_data() const noexcept -> value_type* {
+        // the table's elements are not const, only the access through values() is.
+        return const_cast<value_type*>(m_table.values().data()); // NOLINT(cppcoreguidelines-pro-type-const-cast)
+    }
 
-        // can't use clear_and_fill_buckets_from_values() because container elements might not be unique
-        auto value_idx = value_idx_type{};
+    template <typename It>
+    [[nodiscard]] auto to_iterator(It it) -> iterator {
+        return table_data() + (it - m_table.begin());
+    }
 
-        // loop until we reach the end of the container. duplicated entries will be replaced with back().
-        while (value_idx != static_cast<value_idx_type>(m_values.size())) {
-            auto const& key = get_key(m_values[value_idx]);
+    // Index of the inline element with the key, or m_num_inline when it's not there.
+    template <typename K>
+    [[nodiscard]] auto find_inline(K const& key) const -> std::size_t {
+        auto const equal = m_table.key_eq();
+        auto const* values = inline_data();
+        for (std::size_t idx = 0; idx < m_num_inline; ++idx) {
+            if (equal(key, get_key(values[idx]))) {
+                return idx;
+            }
+        }
+        return m_num_inline;
+    }
 
-            auto hash = mixed_hash(key);
-            auto dist_and_fingerprint = dist_and_fingerprint_from_hash(hash);
-            auto bucket_idx = bucket_idx_from_hash(hash);
+    template <typename... Args>
+    auto construct_inline(Args&&... args) -> value_type* {
+        auto* value = ::new (static_cast<void*>(inline_data() + m_num_inline)) value_type(std::forward<Args>(args)...);
+        ++m_num_inline;
+        return value;
+    }
 
-            bool key_found = false;
-            while (true) {
-                auto const& bucket = at(m_buckets, bucket_idx);
-                if (dist_and_fingerprint > bucket.m_dist_and_fingerprint) {
-                    break;
-                }
-                if (dist_and_fingerprint == bucket.m_dist_and_fingerprint &&
-                    m_equal(key, get_key(m_values[bucket.m_value_idx]))) {
-                    key_found = true;
-                    break;
+    // Same as in the table: the last element is moved into the hole.
+    void erase_inline(std::size_t idx) {
+        auto* values = inline_data();
+        if (idx != m_num_inline - 1) {
+            values[idx] = std::move(values[m_num_inline - 1]);
+        }
+        std::destroy_at(values + m_num_inline - 1);
+        --m_num_inline;
+    }
+
+    void destroy_inline() noexcept {
+        std::destroy(inline_data(), inline_data() + m_num_inline);
+        m_num_inline = 0;
+    }
+
+    // Elements are only moved out of the inline storage when they can be moved back without throwing. Otherwise they are
+    // copied, so that they are still intact when the move to the table fails.
+    static constexpr bool is_move_reversible =
+        std::is_nothrow_move_constructible_v<value_type> && std::is_nothrow_move_assignable_v<value_type>;
+
+    // Moves the elements that have already been moved into the table back inline, unless released.
+    struct move_back_guard {
+        small_table* m_small;
+        table_type* m_table;
+
+        move_back_guard(small_table* small, table_type* table)
+            : m_small(small)
+            , m_table(table) {}
+
+        move_back_guard(move_back_guard const&) = delete;
+        move_back_guard(move_back_guard&&) = delete;
+        auto operator=(move_back_guard const&) -> move_back_guard& = delete;
+        auto operator=(move_back_guard&&) -> move_back_guard& = delete;
+
+        ~move_back_guard() {
+            if constexpr (is_move_reversible) {
+                if (m_table != nullptr) {
+                    // the table appended the elements in the inline order, none of them are duplicates
+                    auto* values = m_small->inline_data();
+                    auto const& table_values = m_table->values();
+                    for (std::size_t idx = 0; idx < table_values.size(); ++idx) {
+                        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+                        values[idx] = std::move(const_cast<value_type&>(table_values[idx]));
+                    }
                 }
-                dist_and_fingerprint = dist_inc(dist_and_fingerprint);
-                bucket_idx = next(bucket_idx);
             }
+        }
+    };
 
-            if (key_found) {
-                if (value_idx != static_cast<value_idx_type>(m_values.size() - 1)) {
-                    m_values[value_idx] = std::move(m_values.back());
-                }
-                m_values.pop_back();
+    // Moves all inline elements into the table. They are put into a new table first, which only replaces m_table once it
+    // has all of them. So when that throws, the elements are still inline and unchanged.
+    void move_to_table(std::size_t capacity) {
+        auto table = m_table; // empty, but has the settings
+        table.reserve(capacity);
+        auto guard = move_back_guard(this, &table);
+        for (auto* it = inline_data(), *end = inline_data() + m_num_inline; it != end; ++it) {
+            if constexpr (is_move_reversible || !std::is_copy_constructible_v<value_type>) {
+                table.emplace(std::move(*it));
             } else {
-                place_and_shift_up({dist_and_fingerprint, value_idx}, bucket_idx);
-                ++value_idx;
+                table.emplace(std::as_const(*it));
+            }
+        }
+        guard.m_table = nullptr;
+        m_table = std::move(table);
+        destroy_inline();
+        m_is_inline = false;
+    }
+
+    // Moves the table's elements back inline, and releases the table's memory. Needs size() <= N.
+    void move_to_inline() {
+        for (auto& value : m_table) {
+            construct_inline(std::move(value));
+        }
+        m_table.clear();
+        m_table.shrink_to_fit();
+        m_is_inline = true;
+    }
+
+    void copy_inline_from(small_table const& other) {
+        for (auto const& value : other) {
+            construct_inline(value);
+        }
+    }
+
+    template <typename K, typename... Args>
+    auto do_try_emplace(K&& key, Args&&... args) -> std::pair<iterator, bool> {
+        if (m_is_inline) {
+            auto idx = find_inline(key);
+            if (idx != m_num_inline) {
+                return {inline_data() + idx, false};
+            }
+            if (m_num_inline != N) {
+                return {construct_inline(std::piecewise_construct,
+                                         std::forward_as_tuple(std::forward<K>(key)),
+                                         std::forward_as_tuple(std::forward<Args>(args)...)),
+                        true};
             }
+            move_to_table(N + 1);
         }
+        auto [it, inserted] = m_table.try_emplace(std::forward<K>(key), std::forward<Args>(args)...);
+        return {to_iterator(it), inserted};
     }
 
-    template <class M, typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
-    auto insert_or_assign(Key const& key, M&& mapped) -> std::pair<iterator, bool> {
-        return do_insert_or_assign(key, std::forward<M>(mapped));
+    template <typename K, typename M>
+    auto do_insert_or_assign(K&& key, M&& mapped) -> std::pair<iterator, bool> {
+        auto it_isinserted = do_try_emplace(std::forward<K>(key), std::forward<M>(mapped));
+        if (!it_isinserted.second) {
+            it_isinserted.first->second = std::forward<M>(mapped);
+        }
+        return it_isinserted;
     }
 
-    template <class M, typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
-    auto insert_or_assign(Key&& key, M&& mapped) -> std::pair<iterator, bool> {
-        return do_insert_or_assign(std::move(key), std::forward<M>(mapped));
+    template <typename K>
+    auto do_find(K const& key) const -> const_iterator {
+        if (m_is_inline) {
+            return inline_data() + find_inline(key);
+        }
+        return table_data() + (m_table.find(key) - m_table.begin());
     }
 
-    template <typename K,
-              typename M,
-              typename Q = T,
-              typename H = Hash,
-              typename KE = KeyEqual,
-              std::enable_if_t<is_map_v<Q> && is_transparent_v<H, KE>, bool> = true>
-    auto insert_or_assign(K&& key, M&& mapped) -> std::pair<iterator, bool> {
-        return do_insert_or_assign(std::forward<K>(key), std::forward<M>(mapped));
+    template <typename K>
+    auto do_find(K const& key) -> iterator {
+        if (m_is_inline) {
+            return inline_data() + find_inline(key);
+        }
+        return to_iterator(m_table.find(key));
     }
 
-    template <class M, typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
-    auto insert_or_assign(const_iterator /*hint*/, Key const& key, M&& mapped) -> iterator {
-        return do_insert_or_assign(key, std::forward<M>(mapped)).first;
+    template <typename K>
+    auto do_erase_key(K const& key) -> std::size_t {
+        if (!m_is_inline) {
+            return m_table.erase(key);
+        }
+        auto idx = find_inline(key);
+        if (idx == m_num_inline) {
+            return 0;
+        }
+        erase_inline(idx);
+        return 1;
     }
 
-    template <class M, typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
-    auto insert_or_assign(const_iterator /*hint*/, Key&& key, M&& mapped) -> iterator {
-        return do_insert_or_assign(std::move(key), std::forward<M>(mapped)).first;
+    template <typename K, typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
+    auto do_at(K const& key) const -> Q const& {
+        if (auto it = find(key); ANKERL_UNORDERED_DENSE_LIKELY(end() != it))
+            ANKERL_UNORDERED_DENSE_LIKELY_ATTR {
+                return it->second;
+            }
+        on_error_key_not_found();
     }
 
-    template <typename K,
-              typename M,
-              typename Q = T,
-              typename H = Hash,
-              typename KE = KeyEqual,
-              std::enable_if_t<is_map_v<Q> && is_transparent_v<H, KE>, bool> = true>
-    auto insert_or_assign(const_iterator /*hint*/, K&& key, M&& mapped) -> iterator {
-        return do_insert_or_assign(std::forward<K>(key), std::forward<M>(mapped)).first;
+public:
+    small_table()
+        : small_table(Hash()) {}
+
+    explicit small_table(Hash const& hash, KeyEqual const& equal = KeyEqual(), allocator_type const& alloc = allocator_type())
+        : m_table(0, hash, equal, alloc) {}
+
+    explicit small_table(allocator_type const& alloc)
+        : small_table(Hash(), KeyEqual(), alloc) {}
+
+    template <class InputIt>
+    small_table(InputIt first,
+                InputIt last,
+                Hash const& hash = Hash(),
+                KeyEqual const& equal = KeyEqual(),
+                allocator_type const& alloc = allocator_type())
+        : small_table(hash, equal, alloc) {
+        insert(first, last);
     }
 
-    // Single arguments for unordered_set can be used without having to construct the value_type
-    template <class K,
-              typename Q = T,
-              typename H = Hash,
-              typename KE = KeyEqual,
-              std::enable_if_t<!is_map_v<Q> && is_transparent_v<H, KE>, bool> = true>
-    auto emplace(K&& key) -> std::pair<iterator, bool> {
-        auto hash = mixed_hash(key);
-        auto dist_and_fingerprint = dist_and_fingerprint_from_hash(hash);
-        auto bucket_idx = bucket_idx_from_hash(hash);
+    small_table(std::initializer_list<value_type> ilist,
+                Hash const& hash = Hash(),
+                KeyEqual const& equal = KeyEqual(),
+                allocator_type const& alloc = allocator_type())
+        : small_table(hash, equal, alloc) {
+        insert(ilist);
+    }
 
-        while (dist_and_fingerprint <= at(m_buckets, bucket_idx).m_dist_and_fingerprint) {
-            if (dist_and_fingerprint == at(m_buckets, bucket_idx).m_dist_and_fingerprint &&
-                m_equal(key, m_values[at(m_buckets, bucket_idx).m_value_idx])) {
-                // found it, return without ever actually creating anything
-                return {begin() + static_cast<difference_type>(at(m_buckets, bucket_idx).m_value_idx), false};
-            }
-            dist_and_fingerprint = dist_inc(dist_and_fingerprint);
-            bucket_idx = next(bucket_idx);
+    // delegates first, so the destructor cleans up when copying an element throws
+    small_table(small_table const& other)
+        : small_table(other.hash_function(), other.key_eq(), other.get_allocator()) {
+        if (other.m_is_inline) {
+            copy_inline_from(other);
+        } else {
+            m_table = other.m_table;
+            m_is_inline = false;
         }
+    }
 
-        // value is new, insert element first, so when exception happens we are in a valid state
-        return do_place_element(dist_and_fingerprint, bucket_idx, std::forward<K>(key));
+    small_table(small_table&& other) noexcept(std::is_nothrow_move_constructible_v<value_type>)
+        : small_table(other.hash_function(), other.key_eq(), other.get_allocator()) {
+        *this = std::move(other);
     }
 
-    template <class... Args>
-    auto emplace(Args&&... args) -> std::pair<iterator, bool> {
-        // we have to instantiate the value_type to be able to access the key.
-        // 1. emplace_back the object so it is constructed. 2. If the key is already there, pop it later in the loop.
-        auto& key = get_key(m_values.emplace_back(std::forward<Args>(args)...));
-        auto hash = mixed_hash(key);
-        auto dist_and_fingerprint = dist_and_fingerprint_from_hash(hash);
-        auto bucket_idx = bucket_idx_from_hash(hash);
+    ~small_table() {
+        destroy_inline();
+    }
 
-        while (dist_and_fingerprint <= at(m_buckets, bucket_idx).m_dist_and_fingerprint) {
-            if (dist_and_fingerprint == at(m_buckets, bucket_idx).m_dist_and_fingerprint &&
-                m_equal(key, get_key(m_values[at(m_buckets, bucket_idx).m_value_idx]))) {
-                m_values.pop_back(); // value was already there, so get rid of it
-                return {begin() + static_cast<difference_type>(at(m_buckets, bucket_idx).m_value_idx), false};
+    auto operator=(small_table const& other) -> small_table& {
+        if (&other != this) {
+            destroy_inline();
+            m_table = other.m_table;
+            m_is_inline = other.m_is_inline;
+            if (m_is_inline) {
+                // the table keeps its capacity when it's assigned an empty one, but inline there mustn't be any memory
+                m_table.shrink_to_fit();
+                copy_inline_from(other);
             }
-            dist_and_fingerprint = dist_inc(dist_and_fingerprint);
-            bucket_idx = next(bucket_idx);
         }
+        return *this;
+    }
 
-        // value is new, place the bucket and shift up until we find an empty spot
-        auto value_idx = static_cast<value_idx_type>(m_values.size() - 1);
-        if (ANKERL_UNORDERED_DENSE_UNLIKELY(is_full()))
-            ANKERL_UNORDERED_DENSE_UNLIKELY_ATTR {
-                // increase_size just rehashes all the data we have in m_values
-                increase_size();
+    auto operator=(small_table&& other) noexcept(std::is_nothrow_move_constructible_v<value_type>) -> small_table& {
+        if (&other != this) {
+            destroy_inline();
+            m_table = std::move(other.m_table);
+            m_is_inline = other.m_is_inline;
+            if (m_is_inline) {
+                for (auto& value : other) {
+                    construct_inline(std::move(value));
+                }
+                other.destroy_inline();
             }
-        else {
-            // place element and shift up until we find an empty spot
-            place_and_shift_up({dist_and_fingerprint, value_idx}, bucket_idx);
+            // the moved-from table is empty, so other is back to inline storage
+            other.m_is_inline = true;
         }
-        return {begin() + static_cast<difference_type>(value_idx), true};
+        return *this;
     }
 
-    template <class... Args>
-    auto emplace_hint(const_iterator /*hint*/, Args&&... args) -> iterator {
-        return emplace(std::forward<Args>(args)...).first;
+    auto operator=(std::initializer_list<value_type> ilist) -> small_table& {
+        clear();
+        insert(ilist);
+        return *this;
     }
 
-    template <class... Args, typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
-    auto try_emplace(Key const& key, Args&&... args) -> std::pair<iterator, bool> {
-        return do_try_emplace(key, std::forward<Args>(args)...);
+    auto get_allocator() const noexcept -> allocator_type {
+        return m_table.get_allocator();
     }
 
-    template <class... Args, typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
-    auto try_emplace(Key&& key, Args&&... args) -> std::pair<iterator, bool> {
-        return do_try_emplace(std::move(key), std::forward<Args>(args)...);
+    // iterators //////////////////////////////////////////////////////////////
+
+    auto begin() noexcept -> iterator {
+        return m_is_inline ? inline_data() : table_data();
     }
 
-    template <class... Args, typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
-    auto try_emplace(const_iterator /*hint*/, Key const& key, Args&&... args) -> iterator {
-        return do_try_emplace(key, std::forward<Args>(args)...).first;
+    auto begin() const noexcept -> const_iterator {
+        return m_is_inline ? inline_data() : table_data();
     }
 
-    template <class... Args, typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
-    auto try_emplace(const_iterator /*hint*/, Key&& key, Args&&... args) -> iterator {
-        return do_try_emplace(std::move(key), std::forward<Args>(args)...).first;
+    auto cbegin() const noexcept -> const_iterator {
+        return begin();
     }
 
-    template <
-        typename K,
-        typename... Args,
-        typename Q = T,
-        typename H = Hash,
-        typename KE = KeyEqual,
-        std::enable_if_t<is_map_v<Q> && is_transparent_v<H, KE> && is_neither_convertible_v<K&&, iterator, const_iterator>,
-                         bool> = true>
-    auto try_emplace(K&& key, Args&&... args) -> std::pair<iterator, bool> {
-        return do_try_emplace(std::forward<K>(key), std::forward<Args>(args)...);
+    auto end() noexcept -> iterator {
+        return begin() + static_cast<difference_type>(size());
     }
 
-    template <
-        typename K,
-        typename... Args,
-        typename Q = T,
-        typename H = Hash,
-        typename KE = KeyEqual,
-        std::enable_if_t<is_map_v<Q> && is_transparent_v<H, KE> && is_neither_convertible_v<K&&, iterator, const_iterator>,
-                         bool> = true>
-    auto try_emplace(const_iterator /*hint*/, K&& key, Args&&... args) -> iterator {
-        return do_try_emplace(std::forward<K>(key), std::forward<Args>(args)...).first;
+    auto end() const noexcept -> const_iterator {
+        return begin() + static_cast<difference_type>(size());
     }
 
-    // Replaces the key at the given iterator with new_key. This does not change any other data in the underlying table, so
-    // all iterators and references remain valid. However, this operation can fail if new_key already exists in the table.
-    // In that case, returns {iterator to the already existing new_key, false} and no change is made.
-    //
-    // In the case of a set, this effectively removes the old key and inserts the new key at the same spot, which is more
-    // efficient than removing the old key and inserting the new key because it avoids repositioning the last element.
-    template <typename K>
-    auto replace_key(iterator it, K&& new_key) -> std::pair<iterator, bool> {
-        auto const new_key_hash = mixed_hash(new_key);
+    auto cend() const noexcept -> const_iterator {
+        return end();
+    }
 
-        // first, check if new_key already exists and return if so
-        auto dist_and_fingerprint = dist_and_fingerprint_from_hash(new_key_hash);
-        auto bucket_idx = bucket_idx_from_hash(new_key_hash);
-        while (dist_and_fingerprint <= at(m_buckets, bucket_idx).m_dist_and_fingerprint) {
-            auto const& bucket = at(m_buckets, bucket_idx);
-            if (dist_and_fingerprint == bucket.m_dist_and_fingerprint &&
-                m_equal(new_key, get_key(m_values[bucket.m_value_idx]))) {
-                return {begin() + static_cast<difference_type>(bucket.m_value_idx), false};
-            }
-            dist_and_fingerprint = dist_inc(dist_and_fingerprint);
-            bucket_idx = next(bucket_idx);
-        }
+    // capacity ///////////////////////////////////////////////////////////////
 
-        // const_cast is needed because iterator for the set is always const, so adding another get_key overload is not
-        // feasible.
-        auto& target_key = const_cast<key_type&>(get_key(*it));
-        auto const old_key_bucket_idx = bucket_idx_from_hash(mixed_hash(target_key));
+    [[nodiscard]] auto empty() const noexcept -> bool {
+        return 0 == size();
+    }
 
-        // Replace the key before doing any bucket changes. If it throws, no harm done, we are still in a valid state as we
-        // have not modified any buckets yet.
-        target_key = std::forward<K>(new_key);
+    [[nodiscard]] auto size() const noexcept -> std::size_t {
+        return m_is_inline ? m_num_inline : m_table.size();
+    }
 
-        auto const value_idx = static_cast<value_idx_type>(it - begin());
+    [[nodiscard]] static constexpr auto max_size() noexcept -> std::size_t {
+        return table_type::max_size();
+    }
 
-        // Find the bucket containing our value_idx. It's guaranteed we find it, so no other stopping condition needed.
-        bucket_idx = old_key_bucket_idx;
-        while (value_idx != at(m_buckets, bucket_idx).m_value_idx) {
-            bucket_idx = next(bucket_idx);
-        }
-        erase_and_shift_down(bucket_idx);
+    // nonstandard API: number of elements that fit inline
+    [[nodiscard]] static constexpr auto inline_capacity() noexcept -> std::size_t {
+        return N;
+    }
 
-        // place the new bucket
-        dist_and_fingerprint = dist_and_fingerprint_from_hash(new_key_hash);
-        bucket_idx = bucket_idx_from_hash(new_key_hash);
-        while (dist_and_fingerprint < at(m_buckets, bucket_idx).m_dist_and_fingerprint) {
-            dist_and_fingerprint = dist_inc(dist_and_fingerprint);
-            bucket_idx = next(bucket_idx);
+    // nonstandard API: true while the elements are stored inline
+    [[nodiscard]] auto is_inline() const noexcept -> bool {
+        return m_is_inline;
+    }
+
+    // nonstandard API: bytes allocated on the heap, 0 while the elements are inline. Does not include sizeof(*this).
+    [[nodiscard]] auto memory_usage() const -> std::size_t {
+        return m_table.memory_usage();
+    }
+
+    // Only moves the elements to the heap when more than N are reserved.
+    void reserve(std::size_t capa) {
+        if (m_is_inline) {
+            if (capa <= N) {
+                return;
+            }
+            move_to_table(capa);
         }
-        place_and_shift_up({dist_and_fingerprint, value_idx}, bucket_idx);
+        m_table.reserve(capa);
+    }
 
-        return {it, true};
+    // nonstandard API: moves the elements back inline when there are at most N, otherwise shrinks the table.
+    void shrink_to_fit() {
+        if (m_is_inline) {
+            return;
+        }
+        if (m_table.size() <= N) {
+            move_to_inline();
+        } else {
+            m_table.shrink_to_fit();
+        }
     }
 
-    auto erase(iterator it) -> iterator {
-        auto hash = mixed_hash(get_key(*it));
-        auto bucket_idx = bucket_idx_from_hash(hash);
+    // modifiers //////////////////////////////////////////////////////////////
 
-        auto const value_idx_to_remove = static_cast<value_idx_type>(it - cbegin());
-        while (at(m_buckets, bucket_idx).m_value_idx != value_idx_to_remove) {
-            bucket_idx = next(bucket_idx);
+    // Keeps the table's memory, like table::clear(). Use shrink_to_fit() to go back to inline storage.
+    void clear() {
+        if (m_is_inline) {
+            destroy_inline();
+        } else {
+            m_table.clear();
         }
+    }
 
-        do_erase(bucket_idx, [](value_type const& /*unused*/) -> void {
-        });
-        return begin() + static_cast<difference_type>(value_idx_to_remove);
+    auto insert(value_type const& value) -> std::pair<iterator, bool> {
+        return emplace(value);
     }
 
-    auto extract(iterator it) -> value_type {
-        auto hash = mixed_hash(get_key(*it));
-        auto bucket_idx = bucket_idx_from_hash(hash);
+    auto insert(value_type&& value) -> std::pair<iterator, bool> {
+        return emplace(std::move(value));
+    }
 
-        auto const value_idx_to_remove = static_cast<value_idx_type>(it - cbegin());
-        while (at(m_buckets, bucket_idx).m_value_idx != value_idx_to_remove) {
-            bucket_idx = next(bucket_idx);
+    template <class InputIt>
+    void insert(InputIt first, InputIt last) {
+        while (first != last) {
+            insert(*first);
+            ++first;
         }
-
-        auto tmp = std::optional<value_type>{};
-        do_erase(bucket_idx, [&tmp](value_type&& val) -> void {
-            tmp = std::move(val);
-        });
-        return std::move(tmp).value();
     }
 
-    template <typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
-    auto erase(const_iterator it) -> iterator {
-        return erase(begin() + (it - cbegin()));
+    void insert(std::initializer_list<value_type> ilist) {
+        insert(ilist.begin(), ilist.end());
     }
 
-    template <typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
-    auto extract(const_iterator it) -> value_type {
-        return extract(begin() + (it - cbegin()));
+    template <class... Args>
+    auto emplace(Args&&... args) -> std::pair<iterator, bool> {
+        if (!m_is_inline) {
+            auto [it, inserted] = m_table.emplace(std::forward<Args>(args)...);
+            return {to_iterator(it), inserted};
+        }
+        if (m_num_inline != N) {
+            // construct right where it belongs, and only keep it when the key is new
+            auto* value = ::new (static_cast<void*>(inline_data() + m_num_inline)) value_type(std::forward<Args>(args)...);
+            auto idx = find_inline(get_key(*value));
+            if (idx != m_num_inline) {
+                std::destroy_at(value);
+                return {inline_data() + idx, false};
+            }
+            ++m_num_inline;
+            return {value, true};
+        }
+        auto value = value_type(std::forward<Args>(args)...);
+        auto idx = find_inline(get_key(value));
+        if (idx != m_num_inline) {
+            return {inline_data() + idx, false};
+        }
+        move_to_table(N + 1);
+        auto [it, inserted] = m_table.emplace(std::move(value));
+        return {to_iterator(it), inserted};
     }
 
-    auto erase(const_iterator first, const_iterator last) -> iterator {
-        auto const idx_first = first - cbegin();
-        auto const idx_last = last - cbegin();
-        auto const first_to_last = std::distance(first, last);
-        auto const last_to_end = std::distance(last, cend());
+    template <class... Args>
+    auto emplace_hint(const_iterator /*hint*/, Args&&... args) -> iterator {
+        return emplace(std::forward<Args>(args)...).first;
+    }
 
-        // remove elements from left to right which moves elements from the end back
-        auto const mid = idx_first + (std::min)(first_to_last, last_to_end);
-        auto idx = idx_first;
-        while (idx != mid) {
-            erase(begin() + idx);
-            ++idx;
-        }
+    template <class... Args, typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
+    auto try_emplace(Key const& key, Args&&... args) -> std::pair<iterator, bool> {
+        return do_try_emplace(key, std::forward<Args>(args)...);
+    }
 
-        // all elements from the right are moved, now remove the last element until all done
-        idx = idx_last;
-        while (idx != mid) {
-            --idx;
-            erase(begin() + idx);
-        }
+    template <class... Args, typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
+    auto try_emplace(Key&& key, Args&&... args) -> std::pair<iterator, bool> {
+        return do_try_emplace(std::move(key), std::forward<Args>(args)...);
+    }
 
-        return begin() + idx_first;
+    template <class M, typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
+    auto insert_or_assign(Key const& key, M&& mapped) -> std::pair<iterator, bool> {
+        return do_insert_or_assign(key, std::forward<M>(mapped));
     }
 
-    auto erase(Key const& key) -> std::size_t {
-        return do_erase_key(key, [](value_type const& /*unused*/) -> void {
-        });
+    template <class M, typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
+    auto insert_or_assign(Key&& key, M&& mapped) -> std::pair<iterator, bool> {
+        return do_insert_or_assign(std::move(key), std::forward<M>(mapped));
     }
 
-    auto extract(Key const& key) -> std::optional<value_type> {
-        auto tmp = std::optional<value_type>{};
-        do_erase_key(key, [&tmp](value_type&& val) -> void {
-            tmp = std::move(val);
-        });
-        return tmp;
+    // Like in the table, the last element is moved into the erased spot, so the returned iterator is it.
+    auto erase(const_iterator it) -> iterator {
+        auto const idx = it - cbegin();
+        if (m_is_inline) {
+            erase_inline(static_cast<std::size_t>(idx));
+        } else {
+            m_table.erase(m_table.cbegin() + idx);
+        }
+        return begin() + idx;
     }
 
-    template <class K, class H = Hash, class KE = KeyEqual, std::enable_if_t<is_transparent_v<H, KE>, bool> = true>
-    auto erase(K&& key) -> std::size_t {
-        return do_erase_key(std::forward<K>(key), [](value_type const& /*unused*/) -> void {
-        });
+    auto erase(Key const& key) -> std::size_t {
+        return do_erase_key(key);
     }
 
     template <class K, class H = Hash, class KE = KeyEqual, std::enable_if_t<is_transparent_v<H, KE>, bool> = true>
-    auto extract(K&& key) -> std::optional<value_type> {
-        auto tmp = std::optional<value_type>{};
-        do_erase_key(std::forward<K>(key), [&tmp](value_type&& val) -> void {
-            tmp = std::move(val);
-        });
-        return tmp;
+    auto erase(K const& key) -> std::size_t {
+        return do_erase_key(key);
     }
 
-    void swap(table& other) noexcept(noexcept(std::is_nothrow_swappable_v<value_container_type> &&
-                                              std::is_nothrow_swappable_v<Hash> && std::is_nothrow_swappable_v<KeyEqual>)) {
+    void swap(small_table& other) noexcept(std::is_nothrow_move_constructible_v<value_type>) {
         using std::swap;
-        swap(other, *this);
+        swap(*this, other);
     }
 
     // lookup /////////////////////////////////////////////////////////////////
 
     template <typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
     auto at(key_type const& key) -> Q& {
-        return do_at(key);
-    }
-
-    template <typename K,
-              typename Q = T,
-              typename H = Hash,
-              typename KE = KeyEqual,
-              std::enable_if_t<is_map_v<Q> && is_transparent_v<H, KE>, bool> = true>
-    auto at(K const& key) -> Q& {
-        return do_at(key);
+        return const_cast<Q&>(do_at(key)); // NOLINT(cppcoreguidelines-pro-type-const-cast)
     }
 
     template <typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
@@ -1912,15 +5870,6 @@ public:
         return do_at(key);
     }
 
-    template <typename K,
-              typename Q = T,
-              typename H = Hash,
-              typename KE = KeyEqual,
-              std::enable_if_t<is_map_v<Q> && is_transparent_v<H, KE>, bool> = true>
-    auto at(K const& key) const -> Q const& {
-        return do_at(key);
-    }
-
     template <typename Q = T, std::enable_if_t<is_map_v<Q>, bool> = true>
     auto operator[](Key const& key) -> Q& {
         return try_emplace(key).first->second;
@@ -1931,15 +5880,6 @@ public:
         return try_emplace(std::move(key)).first->second;
     }
 
-    template <typename K,
-              typename Q = T,
-              typename H = Hash,
-              typename KE = KeyEqual,
-              std::enable_if_t<is_map_v<Q> && is_transparent_v<H, KE>, bool> = true>
-    auto operator[](K&& key) -> Q& {
-        return try_emplace(std::forward<K>(key)).first->second;
-    }
-
     auto count(Key const& key) const -> std::size_t {
         return find(key) == end() ? 0 : 1;
     }
@@ -1976,100 +5916,19 @@ public:
         return find(key) != end();
     }
 
-    auto equal_range(Key const& key) -> std::pair<iterator, iterator> {
-        auto it = do_find(key);
-        return {it, it == end() ? end() : it + 1};
-    }
-
-    auto equal_range(const Key& key) const -> std::pair<const_iterator, const_iterator> {
-        auto it = do_find(key);
-        return {it, it == end() ? end() : it + 1};
-    }
-
-    template <class K, class H = Hash, class KE = KeyEqual, std::enable_if_t<is_transparent_v<H, KE>, bool> = true>
-    auto equal_range(K const& key) -> std::pair<iterator, iterator> {
-        auto it = do_find(key);
-        return {it, it == end() ? end() : it + 1};
-    }
-
-    template <class K, class H = Hash, class KE = KeyEqual, std::enable_if_t<is_transparent_v<H, KE>, bool> = true>
-    auto equal_range(K const& key) const -> std::pair<const_iterator, const_iterator> {
-        auto it = do_find(key);
-        return {it, it == end() ? end() : it + 1};
-    }
-
-    // bucket interface ///////////////////////////////////////////////////////
-
-    auto bucket_count() const noexcept -> std::size_t { // NOLINT(modernize-use-nodiscard)
-        return m_buckets.size();
-    }
-
-    static constexpr auto max_bucket_count() noexcept -> std::size_t { // NOLINT(modernize-use-nodiscard)
-        return max_size();
-    }
-
-    // hash policy ////////////////////////////////////////////////////////////
-
-    [[nodiscard]] auto load_factor() const -> float {
-        return bucket_count() ? static_cast<float>(size()) / static_cast<float>(bucket_count()) : 0.0F;
-    }
-
-    [[nodiscard]] auto max_load_factor() const -> float {
-        return m_max_load_factor;
-    }
-
-    void max_load_factor(float ml) {
-        m_max_load_factor = ml;
-        if (bucket_count() != max_bucket_count()) {
-            m_max_bucket_capacity = static_cast<value_idx_type>(static_cast<float>(bucket_count()) * max_load_factor());
-        }
-    }
-
-    void rehash(std::size_t count) {
-        count = (std::min)(count, max_size());
-        auto shifts = calc_shifts_for_size((std::max)(count, size()));
-        if (shifts != m_shifts) {
-            m_shifts = shifts;
-            deallocate_buckets();
-            m_values.shrink_to_fit();
-            allocate_buckets_from_shift();
-            clear_and_fill_buckets_from_values();
-        }
-    }
-
-    void reserve(std::size_t capa) {
-        capa = (std::min)(capa, max_size());
-        if constexpr (has_reserve<value_container_type>) {
-            // std::deque doesn't have reserve(). Make sure we only call when available
-            m_values.reserve(capa);
-        }
-        auto shifts = calc_shifts_for_size((std::max)(capa, size()));
-        if (0 == bucket_count() || shifts < m_shifts) {
-            m_shifts = shifts;
-            deallocate_buckets();
-            allocate_buckets_from_shift();
-            clear_and_fill_buckets_from_values();
-        }
-    }
-
     // observers //////////////////////////////////////////////////////////////
 
     auto hash_function() const -> hasher {
-        return m_hash;
+        return m_table.hash_function();
     }
 
     auto key_eq() const -> key_equal {
-        return m_equal;
-    }
-
-    // nonstandard API: expose the underlying values container
-    [[nodiscard]] auto values() const noexcept -> value_container_type const& {
-        return m_values;
+        return m_table.key_eq();
     }
 
     // non-member functions ///////////////////////////////////////////////////
 
-    friend auto operator==(table const& a, table const& b) -> bool {
+    friend auto operator==(small_table const& a, small_table const& b) -> bool {
         if (&a == &b) {
             return true;
         }
@@ -2093,46 +5952,192 @@ public:
         return true;
     }
 
-    friend auto operator!=(table const& a, table const& b) -> bool {
+    friend auto operator!=(small_table const& a, small_table const& b) -> bool {
         return !(a == b);
     }
 };
 
 } // namespace detail
 
+// A map that stores up to N elements inline, without any allocation. Beyond that it becomes an
+// ankerl::unordered_dense::map.
 template <class Key,
           class T,
+          std::size_t N,
           class Hash = hash<Key>,
           class KeyEqual = std::equal_to<Key>,
-          class AllocatorOrContainer = std::allocator<std::pair<Key, T>>,
-          class Bucket = bucket_type::standard,
-          class BucketContainer = detail::default_container_t>
-using map = detail::table<Key, T, Hash, KeyEqual, AllocatorOrContainer, Bucket, BucketContainer, false>;
+          class Allocator = std::allocator<std::pair<Key, T>>>
+using small_map = detail::small_table<Key, T, N, Hash, KeyEqual, Allocator>;
 
+// A set that stores up to N elements inline, without any allocation. Beyond that it becomes an
+// ankerl::unordered_dense::set.
 template <class Key,
-          class T,
+          std::size_t N,
           class Hash = hash<Key>,
           class KeyEqual = std::equal_to<Key>,
-          class AllocatorOrContainer = std::allocator<std::pair<Key, T>>,
-          class Bucket = bucket_type::standard,
-          class BucketContainer = detail::default_container_t>
-using segmented_map = detail::table<Key, T, Hash, KeyEqual, AllocatorOrContainer, Bucket, BucketContainer, true>;
+          class Allocator = std::allocator<Key>>
+using small_set = detail::small_table<Key, void, N, Hash, KeyEqual, Allocator>;
+
+// inplace_map and inplace_set ////////////////////////////////////////////////
+
+namespace detail {
+
+// Smallest power of two number of buckets, at least 4, that holds capacity elements with the default max_load_factor.
+[[nodiscard]] constexpr auto inplace_bucket_count(std::size_t capacity) -> std::size_t {
+    auto num_buckets = std::size_t{4};
+    while (num_buckets * 4 / 5 < capacity) {
+        num_buckets *= 2;
+    }
+    return num_buckets;
+}
 
+template <class Key, class T, std::size_t Capacity, class Hash, class KeyEqual, class Bucket>
+using inplace_table = table<Key,
+                            T,
+                            Hash,
+                            KeyEqual,
+                            inplace_vector<std::conditional_t<is_map_v<T>, std::pair<Key, T>, Key>, Capacity>,
+                            Bucket,
+                            inplace_vector<Bucket, inplace_bucket_count(Capacity)>,
+                            false,
+                            growth_policy::standard>;
+
+} // namespace detail
+
+// A map with all its values and buckets stored inside the object, so it never allocates. It holds at most Capacity
+// elements, inserting more calls on_error_bucket_overflow(). All buckets are used from the start, so it never rehashes.
+// Unlike inplace_vector the map can't be constructed in a constant expression, because each table picks its bucket
+// permutation from its address.
 template <class Key,
+          class T,
+          std::size_t Capacity,
           class Hash = hash<Key>,
           class KeyEqual = std::equal_to<Key>,
-          class AllocatorOrContainer = std::allocator<Key>,
-          class Bucket = bucket_type::standard,
-          class BucketContainer = detail::default_container_t>
-using set = detail::table<Key, void, Hash, KeyEqual, AllocatorOrContainer, Bucket, BucketContainer, false>;
+          class Bucket = bucket_type::standard>
+using inplace_map = detail::inplace_table<Key, T, Capacity, Hash, KeyEqual, Bucket>;
 
+// A set with all its values and buckets stored inside the object, so it never allocates. It holds at most Capacity
+// elements, inserting more calls on_error_bucket_overflow(). Like inplace_map it can't be constructed in a constant
+// expression.
 template <class Key,
+          std::size_t Capacity,
           class Hash = hash<Key>,
           class KeyEqual = std::equal_to<Key>,
-          class AllocatorOrContainer = std::allocator<Key>,
-          class Bucket = bucket_type::standard,
-          class BucketContainer = detail::default_container_t>
-using segmented_set = detail::table<Key, void, Hash, KeyEqual, AllocatorOrContainer, Bucket, BucketContainer, true>;
+          class Bucket = bucket_type::standard>
+using inplace_set = detail::inplace_table<Key, void, Capacity, Hash, KeyEqual, Bucket>;
+
+// table_pool /////////////////////////////////////////////////////////////////
+
+// Recycles maps or sets together with their buckets and values capacity, for code that creates and destroys lots of short
+// lived tables. acquire() hands out an empty table, and release() clears a table and keeps it for a later acquire(), so
+// the next user neither allocates nor grows through all the bucket counts again. The pooled tables are grouped by their
+// bucket_count(). To not hoard memory, each group keeps at most max_tables_per_class tables, and tables with more than
+// max_bucket_count buckets are not kept at all. Settings like max_load_factor() stay as they were. The pool is not
+// thread safe, use one per thread.
+template <class Table>
+class table_pool {
+public:
+    using table_type = Table;
+    using allocator_type = typename Table::allocator_type;
+
+private:
+    std::vector<std::vector<Table>> m_classes{}; // m_classes[c] holds tables with 2^c buckets
+    std::size_t m_size = 0;
+    std::size_t m_max_tables_per_class;
+    std::size_t m_max_bucket_count;
+    allocator_type m_alloc;
+
+    // log2 of the number of buckets, which is a power of two.
+    [[nodiscard]] static auto class_of_bucket_count(std::size_t bucket_count) -> std::size_t {
+        auto c = std::size_t{};
+        while ((std::size_t{1} << c) < bucket_count) {
+            ++c;
+        }
+        return c;
+    }
+
+    // Smallest class with tables that hold num_elements without growing, for the default max_load_factor().
+    [[nodiscard]] static auto class_of_size(std::size_t num_elements) -> std::size_t {
+        auto c = std::size_t{};
+        while (c < 63 && static_cast<std::size_t>(static_cast<float>(std::size_t{1} << c) * 0.8F) < num_elements) {
+            ++c;
+        }
+        return c;
+    }
+
+public:
+    explicit table_pool(std::size_t max_tables_per_class = 64,
+                        std::size_t max_bucket_count = std::size_t{1} << 16U,
+                        allocator_type const& alloc = allocator_type())
+        : m_max_tables_per_class(max_tables_per_class)
+        , m_max_bucket_count(max_bucket_count)
+        , m_alloc(alloc) {}
+
+    // An empty table that has room for at least expected_size elements. A pooled table from the smallest class that fits
+    // is reused if there is one, otherwise a new table is created.
+    [[nodiscard]] auto acquire(std::size_t expected_size = 0) -> Table {
+        for (auto c = class_of_size(expected_size); c < m_classes.size(); ++c) {
+            auto& tables = m_classes[c];
+            if (!tables.empty()) {
+                auto table = std::move(tables.back());
+                tables.pop_back();
+                --m_size;
+                table.reserve(expected_size); // no-op, unless the table has a smaller max_load_factor()
+                return table;
+            }
+        }
+        return Table(expected_size, m_alloc);
+    }
+
+    // Clears the table and keeps it for acquire(), or destroys it when it has no buckets, has too many buckets, or when
+    // its class is full.
+    void release(Table table) {
+        table.clear();
+        auto const bucket_count = table.bucket_count();
+        if (bucket_count == 0 || bucket_count > m_max_bucket_count) {
+            return;
+        }
+        auto const c = class_of_bucket_count(bucket_count);
+        if (c >= m_classes.size()) {
+            m_classes.resize(c + 1);
+        }
+        auto& tables = m_classes[c];
+        if (tables.size() < m_max_tables_per_class) {
+            tables.push_back(std::move(table));
+            ++m_size;
+        }
+    }
+
+    // Number of pooled tables.
+    [[nodiscard]] auto size() const noexcept -> std::size_t {
+        return m_size;
+    }
+
+    [[nodiscard]] auto empty() const noexcept -> bool {
+        return 0 == m_size;
+    }
+
+    // Destroys all pooled tables.
+    void clear() {
+        m_classes.clear();
+        m_size = 0;
+    }
+
+    // Bytes held by the pooled tables.
+    [[nodiscard]] auto memory_usage() const -> std::size_t {
+        auto bytes = std::size_t{};
+        for (auto const& tables : m_classes) {
+            for (auto const& table : tables) {
+                bytes += table.memory_usage();
+            }
+        }
+        return bytes;
+    }
+
+    [[nodiscard]] auto get_allocator() const -> allocator_type {
+        return m_alloc;
+    }
+};
 
 #    if defined(ANKERL_UNORDERED_DENSE_PMR)
 
@@ -2210,14 +6215,14 @@ template <class Key,
           class Bucket,
           class Pred,
           class BucketContainer,
-          bool IsSegmented>
+          bool IsSegmented,
+          class GrowthPolicy>
 // NOLINTNEXTLINE(cert-dcl58-cpp)
-auto erase_if(
-    ankerl::unordered_dense::detail::table<Key, T, Hash, KeyEqual, AllocatorOrContainer, Bucket, BucketContainer, IsSegmented>&
-        map,
-    Pred pred) -> std::size_t {
+auto erase_if(ankerl::unordered_dense::detail::
+                  table<Key, T, Hash, KeyEqual, AllocatorOrContainer, Bucket, BucketContainer, IsSegmented, GrowthPolicy>& map,
+              Pred pred) -> std::size_t {
     using map_t = ankerl::unordered_dense::detail::
-        table<Key, T, Hash, KeyEqual, AllocatorOrContainer, Bucket, BucketContainer, IsSegmented>;
+        table<Key, T, Hash, KeyEqual, AllocatorOrContainer, Bucket, BucketContainer, IsSegmented, GrowthPolicy>;
 
     // going back to front because erase() invalidates the end iterator
     auto const old_size = map.size();
@@ -2233,6 +6238,23 @@ auto erase_if(
     return old_size - map.size();
 }
 
+template <class Key, class T, std::size_t N, class Hash, class KeyEqual, class Allocator, class Pred>
+// NOLINTNEXTLINE(cert-dcl58-cpp)
+auto erase_if(ankerl::unordered_dense::detail::small_table<Key, T, N, Hash, KeyEqual, Allocator>& map, Pred pred)
+    -> std::size_t {
+    // going back to front because erase() moves the last element into the erased spot
+    auto const old_size = map.size();
+    auto idx = old_size;
+    while (idx) {
+        --idx;
+        auto it = map.begin() + static_cast<std::ptrdiff_t>(idx);
+        if (pred(*it)) {
+            map.erase(it);
+        }
+    }
+    return old_size - map.size();
+}
+
 } // namespace std
 
 #endif
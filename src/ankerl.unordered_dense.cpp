@@ -22,11 +22,45 @@ export module ankerl.unordered_dense;
 export namespace ankerl::unordered_dense {
     inline namespace ANKERL_UNORDERED_DENSE_NAMESPACE {
       using ankerl::unordered_dense::hash;
+      using ankerl::unordered_dense::contiguous_equal;
+      using ankerl::unordered_dense::contiguous_hash;
+      using ankerl::unordered_dense::hash_aes;
+      using ankerl::unordered_dense::hash_identity_avalanching;
+      using ankerl::unordered_dense::hash_many;
+      using ankerl::unordered_dense::hash_multiply_shift;
+      using ankerl::unordered_dense::is_bytewise_hashable;
+      using ankerl::unordered_dense::member_hash;
+      using ankerl::unordered_dense::streaming_hash;
+      using ankerl::unordered_dense::tuple_equal;
+      using ankerl::unordered_dense::seeded_hash;
 
       using ankerl::unordered_dense::map;
       using ankerl::unordered_dense::segmented_map;
       using ankerl::unordered_dense::set;
       using ankerl::unordered_dense::segmented_set;
+      using ankerl::unordered_dense::compact_map;
+      using ankerl::unordered_dense::compact_set;
+      using ankerl::unordered_dense::static_map;
+      using ankerl::unordered_dense::make_static_map;
+      using ankerl::unordered_dense::small_map;
+      using ankerl::unordered_dense::small_set;
+      using ankerl::unordered_dense::inplace_map;
+      using ankerl::unordered_dense::inplace_set;
+      using ankerl::unordered_dense::table_pool;
+      using ankerl::unordered_dense::probe_statistics;
+      namespace growth_policy {
+        using ankerl::unordered_dense::growth_policy::standard;
+        using ankerl::unordered_dense::growth_policy::factor;
+        using ankerl::unordered_dense::growth_policy::increment;
+      }
+#if ANKERL_UNORDERED_DENSE_STATS
+      using ankerl::unordered_dense::operation_stats;
+      using ankerl::unordered_dense::rehash_event;
+      using ankerl::unordered_dense::rehash_callback;
+#endif
+#if ANKERL_UNORDERED_DENSE_HASH_CHECK
+      using ankerl::unordered_dense::poor_hash_report;
+#endif
 #if defined(ANKERL_UNORDERED_DENSE_PMR)
       namespace pmr {
         using ankerl::unordered_dense::pmr::map;
@@ -0,0 +1,101 @@
+#include <ankerl/unordered_dense.h> // for map, set, hash
+
+#include <app/doctest.h>           // for TestCase, skip, ResultBuilder
+#include <app/name_of_type.h>      // for name_of_type
+#include <third-party/nanobench.h> // for Rng, Bench
+
+#include <fmt/core.h> // for format
+
+#include <algorithm>   // for sort
+#include <cstddef>     // for size_t
+#include <cstdint>     // for uint64_t
+#include <type_traits> // for is_same_v
+#include <vector>      // for vector
+
+namespace {
+
+template <typename Map>
+constexpr bool is_set_v = std::is_same_v<typename Map::key_type, typename Map::value_type>;
+
+template <typename Map>
+[[nodiscard]] auto make_value(uint64_t key) -> typename Map::value_type {
+    if constexpr (is_set_v<Map>) {
+        return key;
+    } else {
+        return {key, key};
+    }
+}
+
+template <typename Map>
+[[nodiscard]] auto key_of(typename Map::value_type const& vt) -> uint64_t {
+    if constexpr (is_set_v<Map>) {
+        return vt;
+    } else {
+        return vt.first;
+    }
+}
+
+// Filters one map into another by iteration, e.g. `for (auto& kv : a) if (p(kv)) b.insert(kv);`. A classic problem of
+// robin hood maps: when the source is iterated in bucket order and the destination uses the same hash, the keys arrive
+// sorted by their bucket index in the destination. Everything gets crammed into the first few buckets, and inserting
+// degrades quadratically until the destination has grown.
+//
+// The map itself iterates in insertion order, so it's not affected. But a source that is in bucket order of the same hash
+// (e.g. another hash map using ankerl::unordered_dense::hash) triggers this. This is simulated by sorting the keys by their
+// hash. Since each table uses a different permutation of the hash for its bucket index, this is fast too.
+template <typename Map>
+void bench_copy_by_iteration() {
+    static constexpr size_t num_elements = 500'000;
+
+    auto rng = ankerl::nanobench::Rng(123);
+    auto source = Map();
+    for (size_t i = 0; i < num_elements; ++i) {
+        source.insert(make_value<Map>(rng()));
+    }
+
+    auto bucket_ordered = std::vector<typename Map::value_type>(source.begin(), source.end());
+    std::sort(bucket_ordered.begin(), bucket_ordered.end(), [](auto const& a, auto const& b) {
+        auto const h = typename Map::hasher();
+        return ankerl::unordered_dense::detail::mixed_hash(h, key_of<Map>(a)) <
+               ankerl::unordered_dense::detail::mixed_hash(h, key_of<Map>(b));
+    });
+
+    auto bench = ankerl::nanobench::Bench().batch(num_elements / 2).relative(true);
+    bench.run(fmt::format("filter in iteration order {}", name_of_type<Map>()), [&] {
+        auto dest = Map();
+        for (auto const& vt : source) {
+            if (0 != (key_of<Map>(vt) & 1U)) {
+                dest.insert(vt);
+            }
+        }
+        ankerl::nanobench::doNotOptimizeAway(dest);
+    });
+    bench.run(fmt::format("filter in bucket order {}", name_of_type<Map>()), [&] {
+        auto dest = Map();
+        for (auto const& vt : bucket_ordered) {
+            if (0 != (key_of<Map>(vt) & 1U)) {
+                dest.insert(vt);
+            }
+        }
+        ankerl::nanobench::doNotOptimizeAway(dest);
+    });
+
+    auto bench_copy = ankerl::nanobench::Bench().batch(num_elements);
+    bench_copy.run(fmt::format("copy in bucket order {}", name_of_type<Map>()), [&] {
+        auto dest = Map();
+        for (auto const& vt : bucket_ordered) {
+            dest.insert(vt);
+        }
+        REQUIRE(dest.size() == source.size());
+    });
+}
+
+} // namespace
+
+TEST_CASE_MAP("bench_copy_by_iteration_map" * doctest::test_suite("bench") * doctest::skip(), uint64_t, uint64_t) {
+    bench_copy_by_iteration<map_t>();
+}
+
+TEST_CASE_SET("bench_copy_by_iteration_set" * doctest::test_suite("bench") * doctest::skip(), uint64_t) {
+    bench_copy_by_iteration<set_t>();
+}
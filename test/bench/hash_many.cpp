@@ -0,0 +1,45 @@
+#include <ankerl/unordered_dense.h> // for hash, hash_many
+
+#include <app/doctest.h>           // for TestCase, skip, ResultBuilder
+#include <third-party/nanobench.h> // for Rng, Bench
+
+#include <cstddef> // for size_t
+#include <cstdint> // for uint64_t, uint32_t
+#include <string>  // for string
+#include <vector>  // for vector
+
+namespace {
+
+template <typename Key>
+void bench_hash_many(ankerl::nanobench::Bench& bench, char const* key_name) {
+    static constexpr size_t num_keys = 1024;
+
+    auto rng = ankerl::nanobench::Rng(123);
+    auto keys = std::vector<Key>();
+    for (size_t i = 0; i < num_keys; ++i) {
+        keys.push_back(static_cast<Key>(rng()));
+    }
+    auto out = std::vector<uint64_t>(num_keys);
+
+    bench.batch(num_keys).unit("key");
+    bench.run(std::string("hash one at a time ") + key_name, [&] {
+        auto const h = ankerl::unordered_dense::hash<Key>();
+        for (size_t i = 0; i < num_keys; ++i) {
+            out[i] = h(keys[i]);
+        }
+        ankerl::nanobench::doNotOptimizeAway(out.data());
+    });
+    bench.run(std::string("hash_many ") + key_name, [&] {
+        ankerl::unordered_dense::hash_many(keys.data(), num_keys, out.data());
+        ankerl::nanobench::doNotOptimizeAway(out.data());
+    });
+}
+
+} // namespace
+
+// Throughput of hashing many keys at once. hash_many uses AVX-512 or AVX2 when the CPU has it.
+TEST_CASE("bench_hash_many" * doctest::test_suite("bench") * doctest::skip()) {
+    auto bench = ankerl::nanobench::Bench().relative(true).minEpochIterations(200);
+    bench_hash_many<uint64_t>(bench, "uint64_t");
+    bench_hash_many<uint32_t>(bench, "uint32_t");
+}
@@ -0,0 +1,110 @@
+#include <ankerl/unordered_dense.h> // for map, hash
+
+#include <app/doctest.h>           // for TestCase, skip, ResultBuilder
+#include <app/name_of_type.h>      // for name_of_type
+#include <third-party/nanobench.h> // for Rng
+
+#include <fmt/core.h> // for print, format
+
+#include <cstddef>     // for size_t
+#include <cstdint>     // for uint64_t
+#include <functional>  // for hash
+#include <string_view> // for string_view
+#include <vector>      // for vector
+
+namespace {
+
+// Scores how well a hash distributes keys into the buckets, without measuring any timings. This reports
+// * chi2/n: chi-squared statistic of the bucket occupancy divided by the number of buckets. Should be close to 1 for a good
+//   hash, much larger values mean the keys are clumped together.
+// * avg/max probe length: what the table actually has to deal with, see probe_stats().
+template <typename Hash>
+void score_hash(std::string_view key_pattern, std::vector<uint64_t> const& keys) {
+    auto map = ankerl::unordered_dense::map<uint64_t, uint64_t, Hash>();
+    for (auto k : keys) {
+        map.try_emplace(k, k);
+    }
+
+    // occupancy of the buckets when using the upper bits of the hash as the bucket index
+    auto const num_buckets = map.bucket_count();
+    auto shifts = 64U;
+    for (auto n = num_buckets; n > 1; n >>= 1U) {
+        --shifts;
+    }
+    auto occupancy = std::vector<uint64_t>(num_buckets);
+    for (auto k : keys) {
+        ++occupancy[ankerl::unordered_dense::detail::mixed_hash(Hash{}, k) >> shifts];
+    }
+    auto const expected = static_cast<double>(keys.size()) / static_cast<double>(num_buckets);
+    auto chi2 = 0.0;
+    for (auto o : occupancy) {
+        auto const diff = static_cast<double>(o) - expected;
+        chi2 += diff * diff / expected;
+    }
+
+    auto stats = map.probe_stats();
+    fmt::print("| {:>12.2f} | {:>9.2f} | {:>9} | {:>10} | {}\n",
+               chi2 / static_cast<double>(num_buckets),
+               stats.average_probe_length,
+               stats.max_probe_length,
+               key_pattern,
+               name_of_type<Hash>());
+}
+
+// Identity, but claims to be avalanching. Don't do this!
+struct identity_avalanching_hash {
+    using is_avalanching = void;
+
+    [[nodiscard]] auto operator()(uint64_t x) const noexcept -> uint64_t {
+        return x;
+    }
+};
+
+// std::hash is the identity for integers in libstdc++ and libc++, so claiming it is avalanching is a bad idea
+struct std_hash_avalanching {
+    using is_avalanching = void;
+
+    [[nodiscard]] auto operator()(uint64_t x) const noexcept -> uint64_t {
+        return std::hash<uint64_t>{}(x);
+    }
+};
+
+// No is_avalanching, so the table mixes the result itself
+struct std_hash_mixed {
+    [[nodiscard]] auto operator()(uint64_t x) const noexcept -> uint64_t {
+        return std::hash<uint64_t>{}(x);
+    }
+};
+
+template <typename Hash>
+void score_all_patterns(std::size_t num_keys) {
+    auto keys = std::vector<uint64_t>(num_keys);
+
+    for (std::size_t i = 0; i < num_keys; ++i) {
+        keys[i] = i;
+    }
+    score_hash<Hash>("sequential", keys);
+
+    for (std::size_t i = 0; i < num_keys; ++i) {
+        keys[i] = i << 32U;
+    }
+    score_hash<Hash>("i << 32", keys);
+
+    auto rng = ankerl::nanobench::Rng(123);
+    for (auto& k : keys) {
+        k = rng();
+    }
+    score_hash<Hash>("random", keys);
+}
+
+} // namespace
+
+TEST_CASE("bench_hash_quality" * doctest::test_suite("bench") * doctest::skip()) {
+    static constexpr std::size_t num_keys = 100'000;
+
+    fmt::print("| {:>12} | {:>9} | {:>9} | {:>10} | hash\n", "chi2/n", "avg probe", "max probe", "keys");
+    score_all_patterns<ankerl::unordered_dense::hash<uint64_t>>(num_keys);
+    score_all_patterns<std_hash_mixed>(num_keys);
+    score_all_patterns<std_hash_avalanching>(num_keys);
+    score_all_patterns<identity_avalanching_hash>(num_keys);
+}
@@ -0,0 +1,44 @@
+#include <ankerl/unordered_dense.h> // for hash, hash_aes
+
+#include <app/doctest.h>           // for TestCase, skip, ResultBuilder
+#include <app/name_of_type.h>      // for name_of_type
+#include <third-party/nanobench.h> // for Rng, Bench
+
+#include <fmt/core.h> // for format
+
+#include <cstddef>     // for size_t
+#include <cstdint>     // for uint64_t
+#include <string>      // for string
+#include <string_view> // for string_view
+
+namespace {
+
+template <typename Hash>
+void bench_hash_string(ankerl::nanobench::Bench& bench, std::string const& str, std::size_t len) {
+    auto const h = Hash();
+    auto sv = std::string_view(str.data(), len);
+    uint64_t x = 0;
+    bench.run(fmt::format("{} {} bytes", name_of_type<Hash>(), len), [&] {
+        x += h(sv);
+        // depend on the previous hash, so the string changes every time
+        sv = std::string_view(str.data() + (x & 7U), len);
+    });
+    ankerl::nanobench::doNotOptimizeAway(x);
+}
+
+} // namespace
+
+// Throughput in bytes/s of the string hashes. hash_aes uses AES-NI when the CPU has it, otherwise it's the same as hash.
+TEST_CASE("bench_hash_string" * doctest::test_suite("bench") * doctest::skip()) {
+    auto rng = ankerl::nanobench::Rng(123);
+    auto str = std::string(4096 + 8, '\0');
+    for (auto& c : str) {
+        c = static_cast<char>(rng());
+    }
+
+    for (std::size_t len = 1; len <= 4096; len *= 2) {
+        auto bench = ankerl::nanobench::Bench().batch(len).unit("byte").relative(true);
+        bench_hash_string<ankerl::unordered_dense::hash<std::string_view>>(bench, str, len);
+        bench_hash_string<ankerl::unordered_dense::hash_aes<std::string_view>>(bench, str, len);
+    }
+}
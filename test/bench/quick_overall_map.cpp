@@ -226,6 +226,52 @@ TEST_CASE("bench_quick_overall_udm" * doctest::test_suite("bench") * doctest::sk
     fmt::print("{} bench_quick_overall_map_udm\n", geomean1(bench));
 }
 
+// Compares the integer hashes on keys with different patterns. Identity is only good for random keys, for sequential and
+// strided keys it puts everything into the same few buckets.
+template <typename Hash>
+void bench_int_hash(ankerl::nanobench::Bench* bench,
+                    std::string_view hash_name,
+                    std::string_view keys_name,
+                    std::vector<uint64_t> const& keys) {
+    bench->run(fmt::format("{} {} insert & find", hash_name, keys_name), [&] {
+        auto map = ankerl::unordered_dense::map<uint64_t, size_t, Hash>();
+        for (auto k : keys) {
+            map[k] = k;
+        }
+        size_t sum = 0;
+        for (auto k : keys) {
+            sum += map.find(k)->second;
+            sum += map.count(k + 1);
+        }
+        ankerl::nanobench::doNotOptimizeAway(sum);
+    });
+}
+
+TEST_CASE("bench_quick_overall_int_hash" * doctest::test_suite("bench") * doctest::skip()) {
+    static constexpr size_t num_keys = 5'000;
+
+    auto keys_sequential = std::vector<uint64_t>();
+    auto keys_random = std::vector<uint64_t>();
+    auto keys_strided = std::vector<uint64_t>();
+    auto rng = ankerl::nanobench::Rng(123);
+    for (uint64_t i = 0; i < num_keys; ++i) {
+        keys_sequential.push_back(i);
+        keys_random.push_back(rng());
+        keys_strided.push_back(i << 20U);
+    }
+
+    ankerl::nanobench::Bench bench;
+    bench.title("integer hashes").batch(num_keys).relative(true);
+    for (auto const& [keys_name, keys] :
+         {std::pair{"sequential"sv, &keys_sequential}, {"random"sv, &keys_random}, {"strided"sv, &keys_strided}}) {
+        bench_int_hash<ankerl::unordered_dense::hash<uint64_t>>(&bench, "hash", keys_name, *keys);
+        bench_int_hash<ankerl::unordered_dense::hash_multiply_shift<uint64_t>>(
+            &bench, "hash_multiply_shift", keys_name, *keys);
+        bench_int_hash<ankerl::unordered_dense::hash_identity_avalanching<uint64_t>>(
+            &bench, "hash_identity_avalanching", keys_name, *keys);
+    }
+}
+
 TEST_CASE("bench_quick_overall_segmented_vector" * doctest::test_suite("bench") * doctest::skip()) {
     ankerl::nanobench::Bench bench;
     // bench.minEpochTime(1s);
@@ -0,0 +1,251 @@
+#include <ankerl/unordered_dense.h>
+
+#include <app/counter.h>
+#include <app/doctest.h>
+#include <third-party/nanobench.h> // for Rng
+
+#include <cstddef>       // for size_t
+#include <cstdint>       // for uint64_t
+#include <functional>    // for equal_to
+#include <memory>        // for allocator
+#include <stdexcept>     // for runtime_error
+#include <string>        // for string, to_string
+#include <type_traits>   // for is_nothrow_move_assignable_v
+#include <unordered_map> // for unordered_map
+#include <utility>       // for move, pair
+#include <vector>        // for vector
+
+namespace {
+
+std::size_t g_num_allocations = 0; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+template <typename T>
+struct counting_allocator {
+    using value_type = T;
+
+    counting_allocator() = default;
+
+    template <typename U>
+    counting_allocator(counting_allocator<U> const& /*unused*/) noexcept {} // NOLINT(hicpp-explicit-conversions)
+
+    auto allocate(std::size_t n) -> T* {
+        ++g_num_allocations;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U>
+    auto operator==(counting_allocator<U> const& /*unused*/) const noexcept -> bool {
+        return true;
+    }
+
+    template <typename U>
+    auto operator!=(counting_allocator<U> const& /*unused*/) const noexcept -> bool {
+        return false;
+    }
+};
+
+// Copies throw once g_copies_left is used up. The move isn't noexcept, so the vector has to copy when it grows.
+int g_copies_left = 0; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+struct throwing_copy {
+    uint64_t m_val;
+
+    explicit throwing_copy(uint64_t val)
+        : m_val(val) {}
+
+    throwing_copy(throwing_copy const& other)
+        : m_val(other.m_val) {
+        if (g_copies_left-- == 0) {
+            throw std::runtime_error("copy");
+        }
+    }
+
+    throwing_copy(throwing_copy&& other) // NOLINT(performance-noexcept-move-constructor)
+        : m_val(other.m_val) {
+        other.m_val = 0;
+    }
+
+    auto operator=(throwing_copy const&) -> throwing_copy& = default;
+    auto operator=(throwing_copy&&) -> throwing_copy& = default; // NOLINT(performance-noexcept-move-constructor)
+    ~throwing_copy() = default;
+};
+
+} // namespace
+
+TEST_CASE("compact_map_sizeof") {
+    static_assert(sizeof(ankerl::unordered_dense::compact_vector<uint64_t>) == sizeof(void*));
+    // values and buckets are a pointer each, instead of std::vector's three and the bucket array's two
+    static_assert(sizeof(ankerl::unordered_dense::compact_map<uint64_t, uint64_t>) <=
+                  sizeof(ankerl::unordered_dense::map<uint64_t, uint64_t>) - 3 * sizeof(void*));
+    static_assert(sizeof(ankerl::unordered_dense::compact_set<std::string>) <=
+                  sizeof(ankerl::unordered_dense::set<std::string>) - 3 * sizeof(void*));
+}
+
+TEST_CASE("compact_map") {
+    using map_t = ankerl::unordered_dense::compact_map<uint64_t,
+                                                       uint64_t,
+                                                       ankerl::unordered_dense::hash<uint64_t>,
+                                                       std::equal_to<uint64_t>,
+                                                       counting_allocator<std::pair<uint64_t, uint64_t>>>;
+    g_num_allocations = 0;
+    auto map = map_t();
+    REQUIRE(map.memory_usage() == 0U);
+    REQUIRE(map.find(1) == map.end());
+    auto copy = map;
+    REQUIRE(g_num_allocations == 0U);
+
+    // one allocation for the values and one for the buckets, with the size and capacity in front
+    map[1] = 2;
+    REQUIRE(g_num_allocations == 2U);
+    REQUIRE(map.values().capacity() == 1U);
+    for (uint64_t i = 0; i < 1000; ++i) {
+        map[i] = i;
+    }
+    REQUIRE(map.size() == 1000U);
+    for (uint64_t i = 0; i < 1000; ++i) {
+        REQUIRE(map.at(i) == i);
+    }
+
+    auto reserved = map_t();
+    reserved.reserve(1000);
+    REQUIRE(reserved.values().capacity() == 1000U);
+    REQUIRE(reserved.memory_usage() == map_t::estimated_memory(1000));
+
+    // stable index mode allocates its indices separately, switching it off releases them
+    map.stable_indices(true);
+    for (uint64_t i = 0; i < 1000; i += 2) {
+        REQUIRE(map.erase(i) == 1U);
+    }
+    REQUIRE(map.size() == 500U);
+    map.shrink_to_fit();
+    REQUIRE(map.values().capacity() == 500U);
+    for (uint64_t i = 1; i < 1000; i += 2) {
+        REQUIRE(map.at(i) == i);
+    }
+    map.stable_indices(false);
+
+    map.clear();
+    map.shrink_to_fit();
+    REQUIRE(map.memory_usage() == 0U);
+}
+
+TEST_CASE("compact_map_random") {
+    auto counts = counter();
+    INFO(counts);
+    {
+        using map_t = ankerl::unordered_dense::compact_map<counter::obj, counter::obj>;
+        auto rng = ankerl::nanobench::Rng(123);
+        auto maps = std::vector<map_t>(10);
+        auto refs = std::vector<std::unordered_map<size_t, size_t>>(10);
+        for (size_t i = 0; i < 20000; ++i) {
+            auto const m = rng.bounded(10);
+            auto& map = maps[m];
+            auto& ref = refs[m];
+            auto const key = rng.bounded(100);
+            switch (rng.bounded(6)) {
+            case 0:
+            case 1:
+                map.try_emplace({key, counts}, i, counts);
+                ref.try_emplace(key, i);
+                break;
+            case 2:
+                REQUIRE(map.erase({key, counts}) == ref.erase(key));
+                break;
+            case 3:
+                if (!map.empty()) {
+                    // the new element might refer to the old storage
+                    map.emplace(*map.begin());
+                }
+                break;
+            case 4:
+                if (rng.bounded(10) == 0) {
+                    map.shrink_to_fit();
+                } else if (rng.bounded(10) == 0) {
+                    map.clear();
+                    ref.clear();
+                }
+                break;
+            default: {
+                auto const other = rng.bounded(10);
+                if (rng.bounded(2) == 0) {
+                    maps[other] = map;
+                } else {
+                    maps[other] = map_t(map);
+                }
+                refs[other] = ref;
+                break;
+            }
+            }
+        }
+        for (size_t m = 0; m < maps.size(); ++m) {
+            REQUIRE(maps[m].size() == refs[m].size());
+            for (auto const& [key, val] : refs[m]) {
+                REQUIRE(maps[m].at({key, counts}).get() == val);
+            }
+        }
+    }
+    REQUIRE(counts.dtor() ==
+            counts.ctor() + counts.static_default_ctor + counts.copy_ctor() + counts.default_ctor() + counts.move_ctor());
+}
+
+TEST_CASE("compact_set") {
+    auto set = ankerl::unordered_dense::compact_set<std::string>{"a", "b", "b"};
+    REQUIRE(set.size() == 2U);
+    for (size_t i = 0; i < 100; ++i) {
+        set.insert(std::to_string(i));
+    }
+    REQUIRE(set.size() == 102U);
+    REQUIRE(set.contains("a"));
+    REQUIRE(set.contains("99"));
+    auto moved = std::move(set);
+    REQUIRE(set.empty()); // NOLINT(bugprone-use-after-move,hicpp-invalid-access-moved)
+    REQUIRE(moved.size() == 102U);
+    REQUIRE(std::erase_if(moved, [](std::string const& s) {
+                return s.size() == 1;
+            }) == 12U);
+    REQUIRE(moved.size() == 90U);
+}
+
+TEST_CASE("compact_vector_growth_throws") {
+    using vec_t = ankerl::unordered_dense::compact_vector<throwing_copy>;
+    static_assert(std::is_nothrow_move_assignable_v<ankerl::unordered_dense::compact_vector<uint64_t>>);
+#if defined(ANKERL_UNORDERED_DENSE_PMR)
+    // with an allocator that can differ the elements might have to be moved one by one into new storage
+    using pmr_vec_t =
+        ankerl::unordered_dense::compact_vector<uint64_t, ANKERL_UNORDERED_DENSE_PMR::polymorphic_allocator<uint64_t>>;
+    static_assert(!std::is_nothrow_move_assignable_v<pmr_vec_t>);
+#endif
+
+    g_copies_left = 100;
+    auto vec = vec_t();
+    for (uint64_t i = 1; i <= 4; ++i) {
+        vec.emplace_back(i);
+    }
+    REQUIRE(vec.capacity() == 4U);
+
+    // growing copies the elements, and when that throws the vector is unchanged
+    g_copies_left = 2;
+    REQUIRE_THROWS_AS(vec.reserve(100), std::runtime_error);
+    g_copies_left = 2;
+    REQUIRE_THROWS_AS(vec.emplace_back(uint64_t{5}), std::runtime_error);
+    g_copies_left = 2;
+    auto copy = vec_t();
+    copy.emplace_back(uint64_t{123});
+    REQUIRE_THROWS_AS(copy = vec, std::runtime_error);
+    REQUIRE(copy.size() == 1U);
+    REQUIRE(copy[0].m_val == 123U);
+    REQUIRE(vec.size() == 4U);
+    REQUIRE(vec.capacity() == 4U);
+    for (uint64_t i = 0; i < 4; ++i) {
+        REQUIRE(vec[i].m_val == i + 1);
+    }
+
+    g_copies_left = 4;
+    vec.emplace_back(uint64_t{5});
+    REQUIRE(vec.size() == 5U);
+    REQUIRE(vec[4].m_val == 5U);
+}
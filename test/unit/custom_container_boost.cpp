@@ -73,6 +73,14 @@ TEST_CASE_TEMPLATE(
 
     map.emplace(std::pair<int, std::string>(9999999, "hello"));
     REQUIRE(map.size() == static_cast<size_t>(total));
+
+    // stable index mode allocates its indices with the same allocator
+    map.stable_indices(true);
+    map.erase(1);
+    REQUIRE(map.find_index(2) == 2U);
+    REQUIRE(map.at_index(2).second == "2");
+    map.stable_indices(false);
+    REQUIRE(map.find_index(2) == 1U);
 }
 
 #endif // ANKERL_UNORDERED_DENSE_HAS_BOOST
@@ -90,5 +90,6 @@ static_assert(ankerl::unordered_dense::detail::is_detected_v<ankerl::unordered_d
 static_assert(ankerl::unordered_dense::detail::is_detected_v<ankerl::unordered_dense::detail::detect_avalanching,
                                                              custom_hash_unique_object_representation>);
 
+// point doesn't opt in with is_bytewise_hashable, so it is not hashed bytewise
 static_assert(!ankerl::unordered_dense::detail::is_detected_v<ankerl::unordered_dense::detail::detect_avalanching,
                                                               ankerl::unordered_dense::hash<point>>);
@@ -0,0 +1,94 @@
+#include <ankerl/unordered_dense.h>
+
+#include <app/counter.h>
+#include <app/doctest.h>
+
+#include <cstddef> // for size_t
+#include <string>  // for string
+#include <tuple>   // for forward_as_tuple
+#include <utility> // for pair, move, piecewise_construct
+
+namespace {
+
+// number of objects that were created or destroyed
+[[nodiscard]] auto num_lifetime_events(counter const& counts) -> size_t {
+    return counts.ctor() + counts.default_ctor() + counts.copy_ctor() + counts.move_ctor() + counts.dtor();
+}
+
+} // namespace
+
+TEST_CASE_MAP("emplace_existing_key_constructs_nothing", counter::obj, counter::obj) {
+    auto counts = counter();
+    INFO(counts);
+
+    auto map = map_t();
+    for (size_t i = 0; i < 100; ++i) {
+        map.try_emplace(counter::obj{i, counts}, i, counts);
+    }
+
+    auto const key = counter::obj{7, counts};
+    auto const val = counter::obj{1000, counts};
+    auto const vt = typename map_t::value_type{key, val};
+    auto vt_movable = typename map_t::value_type{key, val};
+    auto const before = num_lifetime_events(counts);
+
+    REQUIRE_FALSE(map.insert(vt).second);
+    REQUIRE_FALSE(map.insert(std::move(vt_movable)).second);
+    REQUIRE_FALSE(map.emplace(vt).second);
+    REQUIRE_FALSE(map.emplace(key, val).second);
+    REQUIRE_FALSE(map.emplace(std::pair<counter::obj const&, counter::obj const&>(key, val)).second);
+    REQUIRE_FALSE(map.emplace(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(val)).second);
+    REQUIRE(num_lifetime_events(counts) == before);
+
+    // nothing was moved out of the value_type
+    REQUIRE(vt_movable.first.get() == 7U);
+    REQUIRE(vt_movable.second.get() == 1000U);
+    REQUIRE(map.find(key)->second.get() == 7U);
+    REQUIRE(map.size() == 100U);
+
+    // new keys are still constructed in place
+    REQUIRE(map.emplace(counter::obj{100, counts}, counter::obj{100, counts}).second);
+    REQUIRE(map.emplace(std::piecewise_construct, std::forward_as_tuple(101, counts), std::forward_as_tuple(101, counts))
+                .second);
+    REQUIRE(map.insert(typename map_t::value_type{counter::obj{102, counts}, counter::obj{102, counts}}).second);
+    REQUIRE(map.size() == 103U);
+    for (size_t i = 100; i < 103; ++i) {
+        REQUIRE(map.find(counter::obj{i, counts})->second.get() == i);
+    }
+}
+
+TEST_CASE_SET("emplace_existing_key_constructs_nothing_set", counter::obj) {
+    auto counts = counter();
+    INFO(counts);
+
+    auto set = set_t();
+    for (size_t i = 0; i < 100; ++i) {
+        set.emplace(i, counts);
+    }
+
+    auto const key = counter::obj{7, counts};
+    auto key_movable = counter::obj{8, counts};
+    auto const before = num_lifetime_events(counts);
+    REQUIRE_FALSE(set.insert(key).second);
+    REQUIRE_FALSE(set.insert(std::move(key_movable)).second);
+    REQUIRE_FALSE(set.emplace(key).second);
+    REQUIRE(num_lifetime_events(counts) == before);
+    REQUIRE(key_movable.get() == 8U);
+
+    // the key can't be taken from the arguments, so it is constructed first
+    REQUIRE_FALSE(set.emplace(9, counts).second);
+    REQUIRE(num_lifetime_events(counts) > before);
+    REQUIRE(set.size() == 100U);
+}
+
+TEST_CASE_MAP("emplace_key_convertible", std::string, size_t) {
+    auto map = map_t();
+    REQUIRE(map.emplace("a", 1U).second);
+    REQUIRE_FALSE(map.emplace("a", 2U).second);
+    REQUIRE(map.emplace(std::pair<char const*, size_t>("b", 3U)).second);
+    REQUIRE_FALSE(map.emplace(std::string("b"), 4U).second);
+    REQUIRE_FALSE(map.insert(std::pair<std::string, size_t>("b", 5U)).second);
+    REQUIRE(map.size() == 2U);
+    REQUIRE(map["a"] == 1U);
+    REQUIRE(map["b"] == 3U);
+}
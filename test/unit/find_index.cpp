@@ -0,0 +1,104 @@
+#include <ankerl/unordered_dense.h>
+
+#include <app/doctest.h>
+
+#include <cstddef>     // for size_t
+#include <cstdint>     // for uint64_t
+#include <functional>  // for equal_to
+#include <stdexcept>   // for out_of_range
+#include <string>      // for string
+#include <string_view> // for string_view
+#include <tuple>       // for ignore
+#include <utility>     // for as_const
+#include <vector>      // for vector
+
+TEST_CASE_MAP("find_index", uint64_t, std::string) {
+    auto map = map_t();
+    for (uint64_t i = 0; i < 100; ++i) {
+        map.try_emplace(i, std::to_string(i));
+    }
+
+    for (uint64_t i = 0; i < 100; ++i) {
+        auto idx = map.find_index(i);
+        REQUIRE(idx);
+        REQUIRE(*idx == i); // inserted in order
+        REQUIRE(map.at_index(*idx).first == i);
+        REQUIRE(&map.at_index(*idx) == &*map.find(i));
+        REQUIRE(map.find_ptr(i) == &map.find(i)->second);
+    }
+    REQUIRE_FALSE(map.find_index(100));
+    REQUIRE(map.find_ptr(100) == nullptr);
+    REQUIRE(std::as_const(map).find_ptr(100) == nullptr);
+    REQUIRE_THROWS_AS(std::ignore = map.at_index(100), std::out_of_range);
+
+    *map.find_ptr(7) = "seven";
+    REQUIRE(map[7] == "seven");
+    map.at_index(8).second = "eight";
+    REQUIRE(map[8] == "eight");
+    REQUIRE(*std::as_const(map).find_ptr(8) == "eight");
+    REQUIRE(std::as_const(map).at_index(8).second == "eight");
+}
+
+TEST_CASE_MAP("find_index_invalidation", uint64_t, uint64_t) {
+    auto map = map_t();
+    for (uint64_t i = 0; i < 100; ++i) {
+        map.try_emplace(i, i);
+    }
+
+    // store indices in a side structure
+    auto indices = std::vector<size_t>();
+    for (uint64_t i = 0; i < 100; ++i) {
+        indices.push_back(*map.find_index(i));
+    }
+
+    // inserting and growing doesn't move anything
+    for (uint64_t i = 100; i < 1000; ++i) {
+        map.try_emplace(i, i);
+    }
+    map.rehash(10000);
+    for (uint64_t i = 0; i < 100; ++i) {
+        REQUIRE(map.at_index(indices[i]).first == i);
+    }
+
+    // erase moves the last element into the hole
+    auto const last_key = map.values().back().first;
+    REQUIRE(map.erase(uint64_t{10}) == 1U);
+    REQUIRE(*map.find_index(last_key) == indices[10]);
+    for (uint64_t i = 0; i < 100; ++i) {
+        if (i != 10) {
+            REQUIRE(map.at_index(indices[i]).first == i);
+        }
+    }
+}
+
+TEST_CASE_SET("find_index_set", std::string) {
+    auto set = set_t();
+    set.insert("a");
+    set.insert("b");
+    REQUIRE(set.find_index("b") == 1U);
+    REQUIRE(set.at_index(0) == "a");
+    REQUIRE(set.find_ptr("a") == &*set.find("a"));
+    REQUIRE(set.find_ptr("c") == nullptr);
+    REQUIRE_FALSE(set.find_index("c"));
+}
+
+namespace {
+
+struct string_hash {
+    using is_transparent = void;
+    using is_avalanching = void;
+
+    [[nodiscard]] auto operator()(std::string_view str) const noexcept -> uint64_t {
+        return ankerl::unordered_dense::hash<std::string_view>{}(str);
+    }
+};
+
+} // namespace
+
+TEST_CASE("find_index_transparent") {
+    auto map = ankerl::unordered_dense::map<std::string, int, string_hash, std::equal_to<>>();
+    map.try_emplace("hello", 1);
+    REQUIRE(map.find_index(std::string_view("hello")) == 0U);
+    REQUIRE(*map.find_ptr(std::string_view("hello")) == 1);
+    REQUIRE(map.find_ptr(std::string_view("world")) == nullptr);
+}
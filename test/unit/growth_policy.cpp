@@ -0,0 +1,160 @@
+#include <ankerl/unordered_dense.h>
+
+#include <app/doctest.h>
+
+#include <cstddef>    // for size_t
+#include <cstdint>    // for uint64_t, uint8_t
+#include <functional> // for equal_to
+#include <memory>     // for allocator
+#include <utility>    // for pair
+#include <vector>     // for vector
+
+namespace {
+
+template <class GrowthPolicy, class Alloc = std::allocator<std::pair<uint64_t, uint64_t>>>
+using map_with_growth = ankerl::unordered_dense::map<uint64_t,
+                                                     uint64_t,
+                                                     ankerl::unordered_dense::hash<uint64_t>,
+                                                     std::equal_to<uint64_t>,
+                                                     Alloc,
+                                                     ankerl::unordered_dense::bucket_type::standard,
+                                                     ankerl::unordered_dense::detail::default_container_t,
+                                                     GrowthPolicy>;
+
+struct quadruple_buckets {
+    static constexpr std::uint8_t bucket_growth_shifts = 2;
+};
+
+// bytes currently allocated by all tracking_allocator, and the peak since the last reset
+struct allocation_stats {
+    std::size_t current = 0;
+    std::size_t peak = 0;
+};
+
+allocation_stats g_allocations{}; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+template <typename T>
+struct tracking_allocator {
+    using value_type = T;
+
+    tracking_allocator() = default;
+
+    template <typename U>
+    tracking_allocator(tracking_allocator<U> const& /*unused*/) noexcept {} // NOLINT(hicpp-explicit-conversions)
+
+    auto allocate(std::size_t n) -> T* {
+        g_allocations.current += n * sizeof(T);
+        if (g_allocations.current > g_allocations.peak) {
+            g_allocations.peak = g_allocations.current;
+        }
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        g_allocations.current -= n * sizeof(T);
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U>
+    auto operator==(tracking_allocator<U> const& /*unused*/) const noexcept -> bool {
+        return true;
+    }
+
+    template <typename U>
+    auto operator!=(tracking_allocator<U> const& /*unused*/) const noexcept -> bool {
+        return false;
+    }
+};
+
+template <typename Map>
+auto capacities_while_inserting(size_t num_elements) -> std::vector<size_t> {
+    auto map = Map();
+    auto capacities = std::vector<size_t>();
+    for (uint64_t i = 0; i < num_elements; ++i) {
+        map.try_emplace(i, i);
+        if (capacities.empty() || capacities.back() != map.values().capacity()) {
+            capacities.push_back(map.values().capacity());
+        }
+    }
+    return capacities;
+}
+
+} // namespace
+
+TEST_CASE("growth_policy_factor") {
+    using map_t = map_with_growth<ankerl::unordered_dense::growth_policy::factor<3, 2>>;
+    auto capacities = capacities_while_inserting<map_t>(100000);
+    REQUIRE(capacities.size() > 20U);
+    for (size_t i = 10; i < capacities.size(); ++i) {
+        auto const ratio = static_cast<double>(capacities[i]) / static_cast<double>(capacities[i - 1]);
+        REQUIRE(ratio > 1.4);
+        REQUIRE(ratio < 1.6);
+    }
+}
+
+TEST_CASE("growth_policy_increment") {
+    using map_t = map_with_growth<ankerl::unordered_dense::growth_policy::increment<1000>>;
+    auto capacities = capacities_while_inserting<map_t>(10500);
+    REQUIRE(capacities.size() == 11U);
+    for (size_t i = 0; i < capacities.size(); ++i) {
+        REQUIRE(capacities[i] == (i + 1) * 1000);
+    }
+
+    // an exact reserve() is kept, and the policy takes over from there
+    auto map = map_t();
+    map.reserve(1234);
+    for (uint64_t i = 0; i < 1235; ++i) {
+        map.try_emplace(i, i);
+    }
+    REQUIRE(map.values().capacity() == 2234U);
+}
+
+TEST_CASE("growth_policy_buckets") {
+    auto map = map_with_growth<quadruple_buckets>();
+    map.try_emplace(0, 0);
+    auto bucket_counts = std::vector<size_t>{map.bucket_count()};
+    for (uint64_t i = 1; i < 100000; ++i) {
+        map.try_emplace(i, i);
+        if (map.bucket_count() != bucket_counts.back()) {
+            REQUIRE(map.bucket_count() == bucket_counts.back() * 4);
+            bucket_counts.push_back(map.bucket_count());
+        }
+    }
+    REQUIRE(bucket_counts.size() > 5U);
+    for (uint64_t i = 0; i < 100000; ++i) {
+        REQUIRE(map.at(i) == i);
+    }
+}
+
+TEST_CASE("growth_peak_memory") {
+    // the projected peak is an upper bound of what is actually allocated while inserting
+    auto check = [](auto map) {
+        auto num_growths = size_t{};
+        for (uint64_t i = 0; i < 50000; ++i) {
+            auto const projected = map.growth_peak_memory();
+            auto const before = g_allocations.current;
+            g_allocations.peak = g_allocations.current;
+            map.try_emplace(i, i);
+            REQUIRE(g_allocations.peak <= projected);
+            if (g_allocations.current != before) {
+                ++num_growths;
+            }
+            REQUIRE(g_allocations.current == map.memory_usage());
+        }
+        REQUIRE(num_growths > 10U);
+    };
+
+    using alloc_t = tracking_allocator<std::pair<uint64_t, uint64_t>>;
+    check(map_with_growth<ankerl::unordered_dense::growth_policy::standard, alloc_t>());
+    check(map_with_growth<ankerl::unordered_dense::growth_policy::factor<3, 2>, alloc_t>());
+    check(map_with_growth<ankerl::unordered_dense::growth_policy::increment<1000>, alloc_t>());
+    check(map_with_growth<quadruple_buckets, alloc_t>());
+    REQUIRE(g_allocations.current == 0U);
+
+    // 1.5x needs less memory while growing
+    auto std_map = map_with_growth<ankerl::unordered_dense::growth_policy::standard>();
+    auto factor_map = map_with_growth<ankerl::unordered_dense::growth_policy::factor<3, 2>>();
+    std_map.reserve(10000);
+    factor_map.reserve(10000);
+    REQUIRE(factor_map.growth_peak_memory() < std_map.growth_peak_memory());
+}
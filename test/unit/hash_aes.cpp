@@ -0,0 +1,82 @@
+#include <ankerl/unordered_dense.h>
+
+#include <app/doctest.h>
+
+#include <bitset>      // for bitset
+#include <cstddef>     // for size_t
+#include <cstdint>     // for uint64_t
+#include <string>      // for string
+#include <string_view> // for string_view
+#include <vector>      // for vector
+
+TYPE_TO_STRING_MAP(std::string, std::size_t, ankerl::unordered_dense::hash_aes<std::string>);
+
+TEST_CASE("hash_aes_string_and_string_view") {
+    auto const hs = ankerl::unordered_dense::hash_aes<std::string>();
+    auto const hsv = ankerl::unordered_dense::hash_aes<std::string_view>();
+
+    auto str = std::string();
+    for (std::size_t i = 0; i < 300; ++i) {
+        REQUIRE(hs(str) == hsv(str));
+        str.push_back(static_cast<char>('a' + (i % 26)));
+    }
+
+    auto const hws = ankerl::unordered_dense::hash_aes<std::wstring>();
+    auto const hwsv = ankerl::unordered_dense::hash_aes<std::wstring_view>();
+    REQUIRE(hws(L"hello, world!") == hwsv(L"hello, world!"));
+}
+
+TEST_CASE("hash_aes_distinct") {
+    auto const h = ankerl::unordered_dense::hash_aes<std::string_view>();
+
+    // all lengths and each single changed byte give different hashes, this covers all the code paths
+    auto hashes = ankerl::unordered_dense::set<uint64_t>();
+    auto buf = std::string(400, '\0');
+    for (std::size_t len = 0; len <= buf.size(); ++len) {
+        REQUIRE(hashes.insert(h(std::string_view(buf.data(), len))).second);
+    }
+    for (std::size_t len : {1U, 3U, 4U, 8U, 16U, 17U, 33U, 64U, 127U, 128U, 129U, 257U, 300U, 400U}) {
+        for (std::size_t i = 0; i < len; ++i) {
+            buf[i] = 1;
+            REQUIRE(hashes.insert(h(std::string_view(buf.data(), len))).second);
+            buf[i] = 0;
+        }
+    }
+}
+
+TEST_CASE("hash_aes_avalanche") {
+    auto const h = ankerl::unordered_dense::hash_aes<std::string_view>();
+
+    // flipping a single input bit should flip about half of the output bits
+    for (std::size_t len : {1U, 7U, 16U, 40U, 100U, 300U, 1000U}) {
+        auto buf = std::string(len, 'x');
+        auto const base = h(buf);
+        auto num_flipped = std::size_t();
+        auto num_tries = std::size_t();
+        for (std::size_t i = 0; i < len; ++i) {
+            for (unsigned bit = 0; bit < 8; ++bit) {
+                buf[i] = static_cast<char>(buf[i] ^ (1U << bit));
+                num_flipped += std::bitset<64>(base ^ h(buf)).count();
+                ++num_tries;
+                buf[i] = static_cast<char>(buf[i] ^ (1U << bit));
+            }
+        }
+        auto const avg = static_cast<double>(num_flipped) / static_cast<double>(num_tries);
+        REQUIRE(avg > 28.0);
+        REQUIRE(avg < 36.0);
+    }
+}
+
+TEST_CASE_MAP("hash_aes_map", std::string, std::size_t, ankerl::unordered_dense::hash_aes<std::string>) {
+    auto map = map_t();
+    auto keys = std::vector<std::string>();
+    for (std::size_t i = 0; i < 10000; ++i) {
+        keys.push_back(std::string(i % 100, 'k') + std::to_string(i));
+        map[keys.back()] = i;
+    }
+    REQUIRE(map.size() == keys.size());
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+        REQUIRE(map.at(keys[i]) == i);
+    }
+    REQUIRE(map.probe_stats().max_probe_length < 32U);
+}
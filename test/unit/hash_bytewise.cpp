@@ -0,0 +1,171 @@
+#include <ankerl/unordered_dense.h>
+
+#include <app/doctest.h>
+
+#include <array>    // for array
+#include <cstddef>  // for size_t
+#include <cstdint>    // for uint8_t, uint64_t
+#include <functional> // for reference_wrapper
+#include <memory>     // for unique_ptr
+#include <optional>   // for optional, nullopt
+#include <string>     // for string
+
+namespace {
+
+struct point {
+    using is_bytewise_hashable = void;
+
+    int x;
+    int y;
+
+    auto operator==(point const& other) const -> bool {
+        return x == other.x && y == other.y;
+    }
+};
+
+// has padding, so it can't be hashed bytewise even though it opts in
+struct padded {
+    using is_bytewise_hashable = void;
+
+    char c;
+    int i;
+};
+
+// {1, 2} and {2, 4} are equal, but their bytes differ. Doesn't opt in, so it's not hashed bytewise.
+struct frac {
+    int num;
+    int den;
+
+    auto operator==(frac const& other) const -> bool {
+        return num * other.den == other.num * den;
+    }
+};
+
+// can't be changed, so it opts in by specializing is_bytewise_hashable
+struct external_id {
+    std::uint32_t hi;
+    std::uint32_t lo;
+
+    auto operator==(external_id const& other) const -> bool {
+        return hi == other.hi && lo == other.lo;
+    }
+};
+
+// unique object representation, but std::hash is specialized, so that one has to be used
+struct custom_std_hash {
+    std::uint64_t v;
+};
+
+} // namespace
+
+template <>
+struct ankerl::unordered_dense::is_bytewise_hashable<external_id> : std::true_type {};
+
+template <>
+struct std::hash<custom_std_hash> {
+    auto operator()(custom_std_hash const& obj) const noexcept -> std::size_t {
+        return static_cast<std::size_t>(obj.v);
+    }
+};
+
+TYPE_TO_STRING_MAP(point, std::size_t);
+TYPE_TO_STRING_MAP(external_id, std::size_t);
+TYPE_TO_STRING_SET(std::array<std::uint8_t, 16>);
+
+TEST_CASE("hash_bytewise_traits") {
+    using ankerl::unordered_dense::detail::detect_avalanching;
+    using ankerl::unordered_dense::detail::is_bytewise_hashable_v;
+    using ankerl::unordered_dense::detail::is_detected_v;
+
+    static_assert(is_bytewise_hashable_v<point>);
+    static_assert(is_bytewise_hashable_v<external_id>);
+    static_assert(!is_bytewise_hashable_v<padded>);
+    static_assert(!is_bytewise_hashable_v<frac>);
+    static_assert(!is_bytewise_hashable_v<custom_std_hash>);
+    static_assert(!is_bytewise_hashable_v<int>);
+
+    // they have a unique object representation, but equal objects can be stored at different addresses
+    static_assert(!is_bytewise_hashable_v<std::reference_wrapper<std::string const>>);
+    static_assert(!is_bytewise_hashable_v<std::unique_ptr<int>>);
+
+    // arrays hash their elements, which gives the same bytes
+    static_assert(!is_bytewise_hashable_v<std::array<std::uint8_t, 16>>);
+    static_assert(is_detected_v<detect_avalanching, ankerl::unordered_dense::hash<std::array<std::uint8_t, 16>>>);
+    static_assert(is_detected_v<detect_avalanching, ankerl::unordered_dense::hash<std::array<point, 3>>>);
+
+    static_assert(is_detected_v<detect_avalanching, ankerl::unordered_dense::hash<point>>);
+    static_assert(is_detected_v<detect_avalanching, ankerl::unordered_dense::hash<std::optional<int>>>);
+    static_assert(!is_detected_v<detect_avalanching, ankerl::unordered_dense::hash<custom_std_hash>>);
+    REQUIRE(ankerl::unordered_dense::hash<custom_std_hash>{}(custom_std_hash{123}) == 123U);
+}
+
+TEST_CASE_MAP("hash_bytewise_struct", point, std::size_t) {
+    auto const h = ankerl::unordered_dense::hash<point>();
+    REQUIRE(h(point{1, 2}) == h(point{1, 2}));
+    REQUIRE(h(point{1, 2}) != h(point{2, 1}));
+
+    auto map = map_t();
+    for (int x = 0; x < 100; ++x) {
+        for (int y = 0; y < 100; ++y) {
+            map[point{x, y}] = static_cast<std::size_t>(x * 100 + y);
+        }
+    }
+    REQUIRE(map.size() == 10000U);
+    REQUIRE(map.at(point{12, 34}) == 1234U);
+    REQUIRE(map.probe_stats().max_probe_length < 32U);
+}
+
+TEST_CASE_MAP("hash_bytewise_external", external_id, std::size_t) {
+    auto map = map_t();
+    for (std::uint32_t i = 0; i < 1000; ++i) {
+        map[external_id{i, i * 7U}] = i;
+    }
+    REQUIRE(map.size() == 1000U);
+    REQUIRE(map.at(external_id{12, 84}) == 12U);
+    static_assert(ankerl::unordered_dense::detail::is_detected_v<ankerl::unordered_dense::detail::detect_avalanching,
+                                                                 ankerl::unordered_dense::hash<external_id>>);
+}
+
+TEST_CASE_SET("hash_bytewise_uuid", std::array<std::uint8_t, 16>) {
+    auto set = set_t();
+    auto uuid = std::array<std::uint8_t, 16>{};
+    for (std::size_t i = 0; i < uuid.size(); ++i) {
+        for (unsigned v = 0; v < 256; ++v) {
+            uuid[i] = static_cast<std::uint8_t>(v);
+            set.insert(uuid);
+        }
+        uuid[i] = 0;
+    }
+    // all zeros is inserted 16 times
+    REQUIRE(set.size() == 16U * 255U + 1U);
+}
+
+#if defined(__SIZEOF_INT128__)
+TEST_CASE("hash_bytewise_int128") {
+    using ankerl::unordered_dense::detail::uint128_t;
+
+    auto set = ankerl::unordered_dense::set<uint128_t>();
+    for (std::uint64_t i = 0; i < 1000; ++i) {
+        set.insert(uint128_t{i});
+        set.insert(uint128_t{i} << 64U);
+    }
+    REQUIRE(set.size() == 1999U);
+    REQUIRE(set.contains(uint128_t{999} << 64U));
+    REQUIRE_FALSE(set.contains(uint128_t{1000}));
+}
+#endif
+
+TEST_CASE("hash_bytewise_optional") {
+    auto set = ankerl::unordered_dense::set<std::optional<int>>();
+    set.insert(std::nullopt);
+    for (int i = 0; i < 1000; ++i) {
+        set.insert(i);
+    }
+    REQUIRE(set.size() == 1001U);
+    REQUIRE(set.contains(std::nullopt));
+    REQUIRE(set.contains(0));
+    REQUIRE_FALSE(set.contains(1000));
+
+    // the inner hash is avalanching, so there is no additional mixing
+    REQUIRE(ankerl::unordered_dense::hash<std::optional<int>>{}(42) == ankerl::unordered_dense::hash<int>{}(42));
+}
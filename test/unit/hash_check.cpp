@@ -0,0 +1,129 @@
+#include <cstddef> // for size_t
+#include <cstdint> // for uint64_t
+#include <string>  // for string
+#include <vector>  // for vector
+
+namespace {
+
+template <typename Report>
+void record_poor_hash(Report const& report);
+
+} // namespace
+
+#define ANKERL_UNORDERED_DENSE_HASH_CHECK 1                                 // NOLINT(cppcoreguidelines-macro-usage)
+#define ANKERL_UNORDERED_DENSE_ON_POOR_HASH(report) record_poor_hash(report) // NOLINT(cppcoreguidelines-macro-usage)
+#include <ankerl/unordered_dense.h>
+
+#include <app/doctest.h>
+
+#include <third-party/nanobench.h> // for Rng
+
+namespace {
+
+struct recorded_report {
+    std::string key_type;
+    std::string hasher;
+    double average_probe_length;
+    double expected_probe_length;
+};
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+auto g_reports = std::vector<recorded_report>();
+
+template <typename Report>
+void record_poor_hash(Report const& report) {
+    g_reports.push_back({std::string(report.key_type),
+                         std::string(report.hasher),
+                         report.average_probe_length,
+                         report.expected_probe_length});
+}
+
+// Claims to be avalanching but is the identity, so sequential keys are all crammed into the first buckets
+struct identity_avalanching_hash {
+    using is_avalanching = void;
+
+    [[nodiscard]] auto operator()(uint64_t x) const noexcept -> uint64_t {
+        return x;
+    }
+};
+
+// Same as identity_avalanching_hash, but a separate type so it hasn't been reported yet
+struct other_identity_avalanching_hash {
+    using is_avalanching = void;
+
+    [[nodiscard]] auto operator()(uint64_t x) const noexcept -> uint64_t {
+        return x;
+    }
+};
+
+// Only uses the lower bits of the key, so keys that differ in the upper bits collide
+struct low_bits_avalanching_hash {
+    using is_avalanching = void;
+
+    [[nodiscard]] auto operator()(uint64_t x) const noexcept -> uint64_t {
+        return ankerl::unordered_dense::detail::wyhash::hash(x & 0xFFFFU);
+    }
+};
+
+} // namespace
+
+TEST_CASE("hash_check_good_hash") {
+    g_reports.clear();
+
+    auto map = ankerl::unordered_dense::map<uint64_t, uint64_t>();
+    for (uint64_t i = 0; i < 300000; ++i) {
+        map.try_emplace(i, i);
+    }
+    auto rng = ankerl::nanobench::Rng(123);
+    auto set = ankerl::unordered_dense::set<uint64_t>();
+    for (uint64_t i = 0; i < 300000; ++i) {
+        set.emplace(rng());
+    }
+    auto str_set = ankerl::unordered_dense::set<std::string>();
+    for (uint64_t i = 0; i < 100000; ++i) {
+        str_set.emplace(std::to_string(i));
+    }
+    REQUIRE(g_reports.empty());
+}
+
+TEST_CASE("hash_check_identity") {
+    g_reports.clear();
+
+    auto map = ankerl::unordered_dense::map<uint64_t, uint64_t, identity_avalanching_hash>();
+    for (uint64_t i = 0; i < 10000; ++i) {
+        map.try_emplace(i, i);
+    }
+
+    // reported only once
+    REQUIRE(g_reports.size() == 1U);
+    auto const& report = g_reports.front();
+    REQUIRE(report.hasher.find("identity_avalanching_hash") != std::string::npos);
+    REQUIRE_FALSE(report.key_type.empty());
+    REQUIRE(report.average_probe_length > report.expected_probe_length * 4.0);
+}
+
+TEST_CASE("hash_check_low_bits") {
+    g_reports.clear();
+
+    auto set = ankerl::unordered_dense::set<uint64_t, low_bits_avalanching_hash>();
+    for (uint64_t i = 0; i < 10000; ++i) {
+        set.emplace(i << 16U);
+    }
+    REQUIRE(g_reports.size() == 1U);
+    REQUIRE(g_reports.front().hasher.find("low_bits_avalanching_hash") != std::string::npos);
+}
+
+TEST_CASE("hash_check_once_per_key_and_hash") {
+    g_reports.clear();
+
+    // different table types with the same key type & hasher
+    auto map = ankerl::unordered_dense::map<uint64_t, uint64_t, other_identity_avalanching_hash>();
+    auto set = ankerl::unordered_dense::set<uint64_t, other_identity_avalanching_hash>();
+    auto segmented = ankerl::unordered_dense::segmented_map<uint64_t, std::string, other_identity_avalanching_hash>();
+    for (uint64_t i = 0; i < 10000; ++i) {
+        map.try_emplace(i, i);
+        set.emplace(i);
+        segmented.try_emplace(i, "x");
+    }
+    REQUIRE(g_reports.size() == 1U);
+}
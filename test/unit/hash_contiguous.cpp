@@ -0,0 +1,94 @@
+#include <ankerl/unordered_dense.h>
+
+#include <app/doctest.h>
+
+#include <array>   // for array
+#include <cstddef> // for size_t
+#include <cstdint> // for uint64_t
+#include <string>  // for string
+#include <vector>  // for vector
+
+#if ANKERL_UNORDERED_DENSE_HAS_SPAN()
+#    include <span> // for span
+#endif
+
+TYPE_TO_STRING_MAP(std::vector<int>, std::size_t);
+TYPE_TO_STRING_SET(std::vector<bool>);
+TYPE_TO_STRING_MAP(std::vector<int>,
+                   std::size_t,
+                   ankerl::unordered_dense::contiguous_hash<int>,
+                   ankerl::unordered_dense::contiguous_equal<int>);
+
+TEST_CASE("hash_contiguous_traits") {
+    using ankerl::unordered_dense::detail::detect_avalanching;
+    using ankerl::unordered_dense::detail::is_detected_v;
+
+    static_assert(is_detected_v<detect_avalanching, ankerl::unordered_dense::hash<std::vector<int>>>);
+    static_assert(is_detected_v<detect_avalanching, ankerl::unordered_dense::hash<std::vector<std::uint8_t>>>);
+    static_assert(is_detected_v<detect_avalanching, ankerl::unordered_dense::hash<std::array<int, 3>>>);
+
+    // doubles don't have a unique object representation (0.0 == -0.0), so there's no hash for them
+    static_assert(!is_detected_v<detect_avalanching, ankerl::unordered_dense::hash<std::vector<double>>>);
+
+    static_assert(ankerl::unordered_dense::detail::is_contiguous_range_of_v<std::vector<int>, int>);
+    static_assert(ankerl::unordered_dense::detail::is_contiguous_range_of_v<std::array<int, 2>, int>);
+    static_assert(!ankerl::unordered_dense::detail::is_contiguous_range_of_v<std::vector<unsigned>, int>);
+    static_assert(!ankerl::unordered_dense::detail::is_contiguous_range_of_v<int, int>);
+}
+
+TEST_CASE_MAP("hash_contiguous_vector", std::vector<int>, std::size_t) {
+    auto map = map_t();
+    auto key = std::vector<int>();
+    for (std::size_t i = 0; i < 1000; ++i) {
+        map[key] = i;
+        key.push_back(static_cast<int>(i));
+    }
+    REQUIRE(map.size() == 1000U);
+    REQUIRE(map.at(std::vector<int>{}) == 0U);
+    REQUIRE(map.at(std::vector<int>{0, 1, 2}) == 3U);
+    REQUIRE_FALSE(map.contains(std::vector<int>{1, 2, 3}));
+
+    auto const h = ankerl::unordered_dense::hash<std::vector<int>>();
+    auto const arr = std::array<int, 3>{0, 1, 2};
+    REQUIRE(h(std::vector<int>{0, 1, 2}) == ankerl::unordered_dense::contiguous_hash<int>{}(arr));
+}
+
+// std::vector<bool> has no data(), so it's not hashed as a contiguous range but with std::hash
+TEST_CASE_SET("hash_contiguous_vector_bool", std::vector<bool>) {
+    static_assert(!ankerl::unordered_dense::detail::is_contiguous_range_v<std::vector<bool>>);
+
+    auto set = set_t();
+    set.insert(std::vector<bool>{});
+    set.insert(std::vector<bool>{true, false});
+    set.insert(std::vector<bool>{false, true});
+    set.insert(std::vector<bool>{true, false});
+    REQUIRE(set.size() == 3U);
+    REQUIRE(set.contains(std::vector<bool>{false, true}));
+    REQUIRE_FALSE(set.contains(std::vector<bool>{true}));
+}
+
+TEST_CASE_MAP("hash_contiguous_transparent",
+              std::vector<int>,
+              std::size_t,
+              ankerl::unordered_dense::contiguous_hash<int>,
+              ankerl::unordered_dense::contiguous_equal<int>) {
+    auto map = map_t();
+    map[std::vector<int>{1, 2, 3}] = 123;
+    map[std::vector<int>{}] = 0;
+
+    // queried without creating a vector
+    auto const arr = std::array<int, 3>{1, 2, 3};
+    REQUIRE(map.contains(arr));
+    REQUIRE(map.find(arr)->second == 123U);
+    REQUIRE(map.contains(std::array<int, 0>{}));
+    REQUIRE_FALSE(map.contains(std::array<int, 2>{1, 2}));
+
+#if ANKERL_UNORDERED_DENSE_HAS_SPAN()
+    auto const data = std::vector<int>{0, 1, 2, 3, 4};
+    REQUIRE(map.contains(std::span<int const>(data).subspan(1, 3)));
+    REQUIRE(map.find(std::span<int const>(data).subspan(1, 3))->second == 123U);
+    REQUIRE_FALSE(map.contains(std::span<int const>(data).subspan(0, 3)));
+    REQUIRE(ankerl::unordered_dense::hash<std::span<int const>>{}(std::span<int const>(data).subspan(1, 3)) ==
+            ankerl::unordered_dense::hash<std::vector<int>>{}(std::vector<int>{1, 2, 3}));
+#endif
+}
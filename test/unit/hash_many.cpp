@@ -0,0 +1,137 @@
+#include <ankerl/unordered_dense.h>
+
+#include <app/doctest.h>
+
+#include <array>   // for array
+#include <cstddef> // for size_t
+#include <cstdint> // for uint64_t, int64_t, int32_t, uint16_t, int8_t
+#include <utility> // for declval
+#include <vector>  // for vector
+
+namespace {
+
+enum class small_enum : int8_t { a = -3, b = 0, c = 7 };
+enum class big_enum : int64_t { a = -1, b = 1, c = INT64_C(0x7FFFFFFFFFFFFFFF) };
+
+// hash_many has to produce exactly the same values as hash, for all lengths so the scalar tail is covered too. Starts at
+// different offsets so the loads are unaligned.
+template <typename Key>
+void require_same_as_hash(std::vector<Key> const& keys) {
+    auto const h = ankerl::unordered_dense::hash<Key>();
+    auto out = std::vector<uint64_t>(keys.size());
+    for (size_t offset = 0; offset < 3 && offset <= keys.size(); ++offset) {
+        for (size_t n = 0; offset + n <= keys.size(); n += (n < 70 ? 1 : 37)) {
+            ankerl::unordered_dense::hash_many(keys.data() + offset, n, out.data());
+            for (size_t i = 0; i < n; ++i) {
+                REQUIRE(out[i] == h(keys[offset + i]));
+            }
+        }
+    }
+}
+
+template <typename Key>
+[[nodiscard]] auto make_keys(size_t n) -> std::vector<Key> {
+    auto keys = std::vector<Key>();
+    for (size_t i = 0; i < n; ++i) {
+        auto const x = ankerl::unordered_dense::detail::wyhash::hash(i + 1);
+        // include some small values and the extremes
+        switch (i % 4) {
+        case 0:
+            keys.push_back(static_cast<Key>(i));
+            break;
+        case 1:
+            keys.push_back(static_cast<Key>(~uint64_t{} - i));
+            break;
+        default:
+            keys.push_back(static_cast<Key>(x));
+        }
+    }
+    return keys;
+}
+
+template <typename Key>
+using detect_hash_many =
+    decltype(ankerl::unordered_dense::hash_many(std::declval<Key const*>(), std::size_t{}, std::declval<uint64_t*>()));
+
+} // namespace
+
+// unsupported keys are rejected by overload resolution, not by an error inside hash_many
+static_assert(ankerl::unordered_dense::detail::is_detected_v<detect_hash_many, uint64_t>);
+static_assert(!ankerl::unordered_dense::detail::is_detected_v<detect_hash_many, double>);
+#if defined(__SIZEOF_INT128__)
+static_assert(!ankerl::unordered_dense::detail::is_detected_v<detect_hash_many, ankerl::unordered_dense::detail::int128_t>);
+static_assert(!ankerl::unordered_dense::detail::is_detected_v<detect_hash_many, ankerl::unordered_dense::detail::uint128_t>);
+#endif
+
+TEST_CASE("hash_many_integers") {
+    require_same_as_hash(make_keys<uint64_t>(300));
+    require_same_as_hash(make_keys<int64_t>(300));
+    require_same_as_hash(make_keys<long long>(300));
+    require_same_as_hash(make_keys<uint32_t>(300));
+    require_same_as_hash(make_keys<int32_t>(300));
+    require_same_as_hash(make_keys<uint16_t>(300));
+    require_same_as_hash(make_keys<int8_t>(300));
+    require_same_as_hash(make_keys<char>(300));
+}
+
+TEST_CASE("hash_many_bool") {
+    // std::vector<bool> has no data(), so use an array
+    auto bools = std::array<bool, 100>();
+    for (size_t i = 0; i < bools.size(); ++i) {
+        bools[i] = (i % 3) == 0;
+    }
+    auto out = std::array<uint64_t, 100>();
+    ankerl::unordered_dense::hash_many(bools.data(), bools.size(), out.data());
+    for (size_t i = 0; i < bools.size(); ++i) {
+        REQUIRE(out[i] == ankerl::unordered_dense::hash<bool>{}(bools[i]));
+    }
+}
+
+TEST_CASE("hash_many_enums_and_pointers") {
+    auto small = std::vector<small_enum>();
+    auto big = std::vector<big_enum>();
+    for (size_t i = 0; i < 100; ++i) {
+        small.push_back(i % 3 == 0 ? small_enum::a : (i % 3 == 1 ? small_enum::b : small_enum::c));
+        big.push_back(i % 3 == 0 ? big_enum::a : (i % 3 == 1 ? big_enum::b : big_enum::c));
+    }
+    require_same_as_hash(small);
+    require_same_as_hash(big);
+
+    auto values = std::vector<int>(100);
+    auto ptrs = std::vector<int const*>();
+    for (auto const& v : values) {
+        ptrs.push_back(&v);
+    }
+    ptrs.push_back(nullptr);
+    require_same_as_hash(ptrs);
+}
+
+#if ANKERL_UNORDERED_DENSE_HAS_SIMD_IMPL()
+// hash_many uses the widest instructions the CPU has. Call the narrower kernels directly so they are tested too.
+TEST_CASE("hash_many_avx2") {
+    if (!ankerl::unordered_dense::detail::simd::cpu().avx2) {
+        return;
+    }
+    auto keys = make_keys<int32_t>(100);
+    auto out = std::vector<uint64_t>(keys.size());
+    auto const num = ankerl::unordered_dense::detail::simd::hash_ints_avx2<int32_t>(keys.data(), keys.size(), out.data());
+    REQUIRE(num == 100U);
+    for (size_t i = 0; i < num; ++i) {
+        REQUIRE(out[i] == ankerl::unordered_dense::hash<int32_t>{}(keys[i]));
+    }
+}
+#endif
+
+TEST_CASE_MAP("hash_many_prehashed_insert", uint64_t, size_t) {
+    // hashes computed in a batch are the same the map computes, e.g. to shard the keys by their hash first
+    auto keys = make_keys<uint64_t>(1000);
+    auto hashes = std::vector<uint64_t>(keys.size());
+    ankerl::unordered_dense::hash_many(keys.data(), keys.size(), hashes.data());
+
+    auto map = map_t();
+    for (size_t i = 0; i < keys.size(); ++i) {
+        REQUIRE(hashes[i] == map.hash_function()(keys[i]));
+        map.try_emplace(keys[i], i);
+    }
+    REQUIRE(map.size() == keys.size());
+}
@@ -0,0 +1,116 @@
+#include <ankerl/unordered_dense.h>
+
+#include <app/doctest.h>
+
+#include <cstddef> // for size_t
+#include <cstdint> // for uint64_t, uint32_t
+#include <vector>  // for vector
+
+TYPE_TO_STRING_MAP(uint64_t, uint64_t, ankerl::unordered_dense::hash_multiply_shift<uint64_t>);
+TYPE_TO_STRING_MAP(uint64_t, uint64_t, ankerl::unordered_dense::hash_identity_avalanching<uint64_t>);
+TYPE_TO_STRING_MAP(uint32_t, uint64_t, ankerl::unordered_dense::hash_multiply_shift<uint32_t>);
+
+namespace {
+
+enum class color : uint8_t { red, green, blue };
+
+template <typename Map>
+void require_map_works(std::vector<typename Map::key_type> const& keys) {
+    auto map = Map();
+    for (size_t i = 0; i < keys.size(); ++i) {
+        map.try_emplace(keys[i], i);
+    }
+    REQUIRE(map.size() == keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        auto it = map.find(keys[i]);
+        REQUIRE(it != map.end());
+        REQUIRE(it->second == i);
+    }
+    for (auto const& k : keys) {
+        REQUIRE(map.erase(k) == 1U);
+    }
+    REQUIRE(map.empty());
+}
+
+} // namespace
+
+TEST_CASE("hash_policies_traits") {
+    using ankerl::unordered_dense::detail::detect_avalanching;
+    using ankerl::unordered_dense::detail::is_detected_v;
+
+    static_assert(is_detected_v<detect_avalanching, ankerl::unordered_dense::hash_identity_avalanching<uint64_t>>);
+    static_assert(is_detected_v<detect_avalanching, ankerl::unordered_dense::hash_multiply_shift<uint64_t>>);
+    static_assert(is_detected_v<detect_avalanching, ankerl::unordered_dense::hash_multiply_shift<color>>);
+
+    static_assert(ankerl::unordered_dense::hash_identity_avalanching<uint64_t>{}(12345) == 12345U);
+    static_assert(ankerl::unordered_dense::hash_multiply_shift<uint64_t>{}(0) == 0U);
+    static_assert(ankerl::unordered_dense::hash_multiply_shift<uint64_t>{}(1) != 1U);
+
+    REQUIRE(ankerl::unordered_dense::hash_multiply_shift<color>{}(color::green) !=
+            ankerl::unordered_dense::hash_multiply_shift<color>{}(color::blue));
+}
+
+TEST_CASE("hash_multiply_shift_spreads_bits") {
+    // sequential and strided keys need to differ in the bits that are used for the bucket index and the fingerprint. Check
+    // that every 8 bit window of the hash takes many different values.
+    auto const h = ankerl::unordered_dense::hash_multiply_shift<uint64_t>();
+    for (auto stride : {uint64_t{1}, uint64_t{8}, uint64_t{1} << 20U, uint64_t{1} << 31U}) {
+        for (uint64_t shift = 0; shift <= 56; shift += 8) {
+            auto seen = std::vector<bool>(256);
+            size_t num_different = 0;
+            for (uint64_t i = 0; i < 256; ++i) {
+                auto const bits = static_cast<size_t>((h(i * stride) >> shift) & 0xffU);
+                if (!seen[bits]) {
+                    seen[bits] = true;
+                    ++num_different;
+                }
+            }
+            // a random function hits about 162 of the 256 values. Multiply-shift is a bit weaker, but far from the few values
+            // that identity would produce.
+            REQUIRE(num_different > 96U);
+        }
+    }
+}
+
+TEST_CASE_MAP("hash_policies_sequential_keys",
+              uint64_t,
+              uint64_t,
+              ankerl::unordered_dense::hash_multiply_shift<uint64_t>) {
+    auto keys = std::vector<uint64_t>();
+    for (uint64_t i = 0; i < 10000; ++i) {
+        keys.push_back(i);
+    }
+    require_map_works<map_t>(keys);
+
+    keys.clear();
+    for (uint64_t i = 0; i < 10000; ++i) {
+        keys.push_back(i << 24U);
+    }
+    require_map_works<map_t>(keys);
+}
+
+TEST_CASE_MAP("hash_policies_small_keys", uint32_t, uint64_t, ankerl::unordered_dense::hash_multiply_shift<uint32_t>) {
+    auto keys = std::vector<uint32_t>();
+    for (uint32_t i = 0; i < 10000; ++i) {
+        keys.push_back(i * 3U);
+    }
+    require_map_works<map_t>(keys);
+}
+
+TEST_CASE_MAP("hash_policies_random_keys",
+              uint64_t,
+              uint64_t,
+              ankerl::unordered_dense::hash_identity_avalanching<uint64_t>) {
+    // identity is only usable when the keys are already random
+    auto keys = std::vector<uint64_t>();
+    for (uint64_t i = 0; i < 10000; ++i) {
+        keys.push_back(ankerl::unordered_dense::detail::wyhash::hash(i));
+    }
+    require_map_works<map_t>(keys);
+
+    auto map = map_t();
+    for (auto k : keys) {
+        map.try_emplace(k, k);
+    }
+    REQUIRE(map.probe_stats().max_probe_length < 32U);
+}
@@ -0,0 +1,231 @@
+#include <ankerl/unordered_dense.h>
+
+#include <app/counter.h>
+#include <app/doctest.h>
+#include <third-party/nanobench.h> // for Rng
+
+#include <cstddef>       // for size_t
+#include <cstdint>       // for uint64_t
+#include <memory>        // for unique_ptr, make_unique
+#include <stdexcept>     // for overflow_error
+#include <string>        // for string, to_string
+#include <unordered_map> // for unordered_map
+#include <utility>       // for move
+
+namespace {
+
+// Not default constructible, so the storage mustn't construct any elements
+struct no_default_ctor {
+    explicit no_default_ctor(uint64_t v)
+        : m_v(v) {}
+
+    uint64_t m_v;
+};
+
+#if defined(__cpp_constinit)
+// the constructors are constexpr, so this is constant initialized
+constinit ankerl::unordered_dense::inplace_vector<std::string, 4> g_static_vector; // NOLINT
+#else
+ankerl::unordered_dense::inplace_vector<std::string, 4> g_static_vector; // NOLINT
+#endif
+
+} // namespace
+
+TEST_CASE("inplace_map") {
+    using map_t = ankerl::unordered_dense::inplace_map<uint64_t, uint64_t, 100>;
+    static_assert(map_t::max_bucket_count() == 128U);
+
+    auto map = map_t();
+    REQUIRE(map.empty());
+    REQUIRE(map.memory_usage() == 0U);
+    REQUIRE(map.growth_peak_memory() == 0U);
+    REQUIRE(map_t::estimated_memory(100) == 0U);
+    REQUIRE(map.find(1) == map.end());
+
+    // all buckets are used right away, so there's never a rehash
+    map[0] = 0;
+    REQUIRE(map.bucket_count() == 128U);
+    for (uint64_t i = 1; i < 100; ++i) {
+        REQUIRE(map.try_emplace(i, i).second);
+        REQUIRE(map.bucket_count() == 128U);
+    }
+    REQUIRE(map.size() == 100U);
+    REQUIRE(map.memory_usage() == 0U);
+
+    // no more room: the table stays as it is
+    REQUIRE_THROWS_AS(map.try_emplace(100, 100), std::overflow_error);
+    REQUIRE_THROWS_AS(map.emplace(101, 101), std::overflow_error);
+    REQUIRE_THROWS_AS(map[102], std::overflow_error);
+    REQUIRE_FALSE(map.try_emplace(99, 0).second);
+    REQUIRE(map.size() == 100U);
+    for (uint64_t i = 0; i < 100; ++i) {
+        REQUIRE(map.at(i) == i);
+    }
+    REQUIRE_FALSE(map.contains(100));
+    REQUIRE_THROWS_AS(map.reserve(101), std::overflow_error);
+
+    // erasing makes room again
+    REQUIRE(map.erase(50) == 1U);
+    REQUIRE(map.try_emplace(100, 100).second);
+    REQUIRE(map.at(100) == 100U);
+    REQUIRE_FALSE(map.contains(50));
+
+    map.rehash(1000);
+    map.shrink_to_fit();
+    REQUIRE(map.bucket_count() == 128U);
+    REQUIRE(map.at(100) == 100U);
+
+    map.clear();
+    REQUIRE(map.empty());
+    map[1] = 2;
+    REQUIRE(map.at(1) == 2U);
+}
+
+TEST_CASE("inplace_map_copy_and_move") {
+    using map_t = ankerl::unordered_dense::inplace_map<std::string, uint64_t, 20>;
+    auto map = map_t();
+    for (uint64_t i = 0; i < 20; ++i) {
+        map[std::to_string(i)] = i;
+    }
+
+    auto copy = map;
+    REQUIRE(copy == map);
+    REQUIRE(copy.erase("3") == 1U);
+    REQUIRE(copy != map);
+
+    auto moved = std::move(copy);
+    REQUIRE(moved.size() == 19U);
+    REQUIRE(copy.empty()); // NOLINT(bugprone-use-after-move,hicpp-invalid-access-moved)
+    copy["x"] = 1;         // NOLINT(bugprone-use-after-move,hicpp-invalid-access-moved)
+    REQUIRE(copy.at("x") == 1U);
+
+    copy = map;
+    REQUIRE(copy == map);
+    moved = std::move(copy);
+    REQUIRE(moved == map);
+
+    auto other = map_t{{"a", 1}};
+    other.swap(moved);
+    REQUIRE(other == map);
+    REQUIRE(moved.size() == 1U);
+    REQUIRE(moved.at("a") == 1U);
+}
+
+TEST_CASE("inplace_map_move_only") {
+    // moving the map moves the values, it never copies them
+    using map_t = ankerl::unordered_dense::inplace_map<uint64_t, std::unique_ptr<uint64_t>, 8>;
+    auto map = map_t();
+    for (uint64_t i = 0; i < 8; ++i) {
+        map.try_emplace(i, std::make_unique<uint64_t>(i * 10));
+    }
+    auto moved = std::move(map);
+    REQUIRE(moved.size() == 8U);
+    REQUIRE(*moved.at(7) == 70U);
+
+    map = std::move(moved);
+    REQUIRE(map.size() == 8U);
+    for (uint64_t i = 0; i < 8; ++i) {
+        REQUIRE(*map.at(i) == i * 10);
+    }
+    REQUIRE(map.erase(3) == 1U);
+    map.try_emplace(100, std::make_unique<uint64_t>(1000));
+    REQUIRE(*map.at(100) == 1000U);
+}
+
+TEST_CASE("inplace_vector_storage") {
+    auto vec = ankerl::unordered_dense::inplace_vector<no_default_ctor, 4>();
+    REQUIRE(vec.empty());
+    vec.emplace_back(uint64_t{123});
+    REQUIRE(vec[0].m_v == 123U);
+
+    REQUIRE(g_static_vector.empty());
+    g_static_vector.emplace_back("static");
+    REQUIRE(g_static_vector.back() == "static");
+    g_static_vector.clear();
+}
+
+TEST_CASE("inplace_map_max_load_factor") {
+    // 100 values in 128 buckets: a lower max_load_factor() can't be kept, so it is clamped
+    using map_t = ankerl::unordered_dense::inplace_map<uint64_t, uint64_t, 100>;
+    auto map = map_t();
+    map.max_load_factor(0.1F);
+    REQUIRE(static_cast<double>(map.max_load_factor()) == doctest::Approx(100.0 / 128.0));
+    for (uint64_t i = 0; i < 100; ++i) {
+        REQUIRE(map.try_emplace(i, i).second);
+        REQUIRE(map.bucket_count() == 128U);
+    }
+    map.max_load_factor(0.95F);
+    REQUIRE(static_cast<double>(map.max_load_factor()) == doctest::Approx(0.95));
+    REQUIRE_THROWS_AS(map.try_emplace(100, 100), std::overflow_error);
+    REQUIRE(map.size() == 100U);
+}
+
+TEST_CASE("inplace_map_lifetime") {
+    auto counts = counter();
+    INFO(counts);
+    {
+        using map_t = ankerl::unordered_dense::inplace_map<counter::obj, counter::obj, 8>;
+        auto rng = ankerl::nanobench::Rng(123);
+        auto map = map_t();
+        for (size_t i = 0; i < 5000; ++i) {
+            auto key = rng.bounded(12);
+            switch (rng.bounded(4)) {
+            case 0:
+            case 1:
+                if (map.size() < 8 || map.contains({key, counts})) {
+                    map.try_emplace({key, counts}, i, counts);
+                } else {
+                    REQUIRE_THROWS_AS(map.try_emplace({key, counts}, i, counts), std::overflow_error);
+                }
+                break;
+            case 2:
+                map.erase({key, counts});
+                break;
+            default:
+                if (rng.bounded(50) == 0) {
+                    auto copy = map;
+                    map = std::move(copy);
+                }
+                break;
+            }
+            REQUIRE(map.size() <= 8U);
+        }
+    }
+    REQUIRE(counts.dtor() ==
+            counts.ctor() + counts.static_default_ctor + counts.copy_ctor() + counts.default_ctor() + counts.move_ctor());
+}
+
+TEST_CASE("inplace_map_random") {
+    auto rng = ankerl::nanobench::Rng(321);
+    auto map = ankerl::unordered_dense::inplace_map<uint64_t, uint64_t, 30>();
+    auto ref = std::unordered_map<uint64_t, uint64_t>();
+    for (size_t i = 0; i < 20000; ++i) {
+        auto key = rng.bounded(40);
+        if (rng.bounded(3) == 0) {
+            REQUIRE(map.erase(key) == ref.erase(key));
+        } else if (ref.size() < 30 || ref.count(key) != 0) {
+            map[key] = i;
+            ref[key] = i;
+        }
+        REQUIRE(map.size() == ref.size());
+    }
+    for (auto const& [k, v] : ref) {
+        REQUIRE(map.at(k) == v);
+    }
+}
+
+TEST_CASE("inplace_set") {
+    using set_t = ankerl::unordered_dense::inplace_set<uint64_t, 3>;
+    static_assert(set_t::max_bucket_count() == 4U);
+    auto set = set_t{1, 2, 2, 3};
+    REQUIRE(set.size() == 3U);
+    REQUIRE(set.bucket_count() == 4U);
+    REQUIRE_THROWS_AS(set.insert(4), std::overflow_error);
+    REQUIRE(set.erase(1) == 1U);
+    REQUIRE(set.insert(4).second);
+    REQUIRE(set == set_t{2, 3, 4});
+    REQUIRE(std::erase_if(set, [](uint64_t x) {
+                return x > 2;
+            }) == 2U);
+    REQUIRE(set.size() == 1U);
+}
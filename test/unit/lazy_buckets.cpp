@@ -0,0 +1,138 @@
+#include <ankerl/unordered_dense.h>
+
+#include <app/doctest.h>
+
+#include <cstddef>    // for size_t
+#include <cstdint>    // for uint64_t
+#include <functional> // for equal_to
+#include <memory>     // for allocator
+#include <utility>    // for move, pair
+#include <vector>     // for vector
+
+namespace {
+
+std::size_t g_num_allocations = 0; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+template <typename T>
+struct counting_allocator {
+    using value_type = T;
+
+    counting_allocator() = default;
+
+    template <typename U>
+    counting_allocator(counting_allocator<U> const& /*unused*/) noexcept {} // NOLINT(hicpp-explicit-conversions)
+
+    auto allocate(std::size_t n) -> T* {
+        ++g_num_allocations;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U>
+    auto operator==(counting_allocator<U> const& /*unused*/) const noexcept -> bool {
+        return true;
+    }
+
+    template <typename U>
+    auto operator!=(counting_allocator<U> const& /*unused*/) const noexcept -> bool {
+        return false;
+    }
+};
+
+template <typename Map>
+void check_no_allocations() {
+    g_num_allocations = 0;
+    {
+        auto maps = std::vector<Map>(1000);
+        g_num_allocations = 0;
+        for (auto& map : maps) {
+            REQUIRE(map.find(123) == map.end());
+            REQUIRE(map.count(123) == 0U);
+            REQUIRE(map.erase(123) == 0U);
+            map.clear();
+            map.reserve(0);
+            map.rehash(0);
+        }
+        auto copy = maps[0];
+        auto moved = std::move(copy);
+        maps[1] = moved;
+        maps[2] = std::move(moved);
+        REQUIRE(g_num_allocations == 0U);
+
+        maps[3][1] = 2;
+        REQUIRE(g_num_allocations != 0U);
+    }
+}
+
+} // namespace
+
+TEST_CASE("lazy_buckets_no_allocation") {
+    using alloc_t = counting_allocator<std::pair<uint64_t, uint64_t>>;
+    check_no_allocations<ankerl::unordered_dense::map<uint64_t,
+                                                      uint64_t,
+                                                      ankerl::unordered_dense::hash<uint64_t>,
+                                                      std::equal_to<uint64_t>,
+                                                      alloc_t>>();
+    check_no_allocations<ankerl::unordered_dense::segmented_map<uint64_t,
+                                                                uint64_t,
+                                                                ankerl::unordered_dense::hash<uint64_t>,
+                                                                std::equal_to<uint64_t>,
+                                                                alloc_t>>();
+}
+
+TEST_CASE_MAP("lazy_buckets", uint64_t, uint64_t) {
+    auto map = map_t();
+    REQUIRE(map.bucket_count() == 0U);
+    REQUIRE(map.memory_usage() == 0U);
+    REQUIRE(static_cast<double>(map.load_factor()) == doctest::Approx(0.0));
+    REQUIRE(map.find(1) == map.end());
+    REQUIRE_FALSE(map.find_index(1));
+    REQUIRE(map.find_ptr(1) == nullptr);
+    REQUIRE(map.probe_stats().max_probe_length == 0U);
+
+    // every kind of insert allocates the buckets
+    map[1] = 2;
+    REQUIRE(map.bucket_count() > 0U);
+    REQUIRE(map.at(1) == 2U);
+
+    auto emplaced = map_t();
+    REQUIRE(emplaced.emplace(std::pair<uint64_t, uint64_t>(3, 4)).second);
+    REQUIRE(emplaced.at(3) == 4U);
+
+    auto prepared = map_t();
+    auto slot = prepared.prepare_insert(5);
+    REQUIRE_FALSE(slot.found());
+    prepared.commit(slot, uint64_t{5}, uint64_t{6});
+    REQUIRE(prepared.at(5) == 6U);
+
+    // moved-from and copies of empty maps don't have buckets either, and are still usable
+    auto moved = std::move(map);
+    REQUIRE(map.bucket_count() == 0U); // NOLINT(bugprone-use-after-move,hicpp-invalid-access-moved)
+    map[7] = 8;                         // NOLINT(bugprone-use-after-move,hicpp-invalid-access-moved)
+    REQUIRE(map.size() == 1U);
+
+    auto empty = map_t();
+    auto copy = empty;
+    REQUIRE(copy.bucket_count() == 0U);
+    copy[9] = 10;
+    REQUIRE(copy.at(9) == 10U);
+
+    // clear() keeps the buckets for the next inserts, shrink_to_fit() releases them
+    auto const num_buckets = moved.bucket_count();
+    moved.clear();
+    REQUIRE(moved.bucket_count() == num_buckets);
+    moved.shrink_to_fit();
+    REQUIRE(moved.bucket_count() == 0U);
+    moved[11] = 12;
+    REQUIRE(moved.at(11) == 12U);
+
+    // with a min_load_factor(), erasing the last element releases them
+    moved.min_load_factor(0.1F);
+    REQUIRE(moved.erase(11) == 1U);
+    REQUIRE(moved.bucket_count() == 0U);
+    moved[13] = 14;
+    REQUIRE(moved.size() == 1U);
+}
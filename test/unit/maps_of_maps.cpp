@@ -58,6 +58,7 @@ void test() {
 
 TYPE_TO_STRING_MAP(counter::obj, ankerl::unordered_dense::map<counter::obj, counter::obj>);
 TYPE_TO_STRING_MAP(counter::obj, ankerl::unordered_dense::segmented_map<counter::obj, counter::obj>);
+TYPE_TO_STRING_MAP(counter::obj, ankerl::unordered_dense::compact_map<counter::obj, counter::obj>);
 
 TEST_CASE_MAP("mapmap_map", counter::obj, ankerl::unordered_dense::map<counter::obj, counter::obj>) {
     test<map_t>();
@@ -66,3 +67,7 @@ TEST_CASE_MAP("mapmap_map", counter::obj, ankerl::unordered_dense::map<counter::
 TEST_CASE_MAP("mapmap_segmented_map", counter::obj, ankerl::unordered_dense::segmented_map<counter::obj, counter::obj>) {
     test<map_t>();
 }
+
+TEST_CASE_MAP("mapmap_compact_map", counter::obj, ankerl::unordered_dense::compact_map<counter::obj, counter::obj>) {
+    test<map_t>();
+}
@@ -0,0 +1,164 @@
+#include <ankerl/unordered_dense.h>
+
+#include <app/doctest.h>
+
+#include <cstddef> // for size_t
+#include <cstdint> // for uint64_t
+#include <vector>  // for vector
+
+namespace {
+
+// Deliberately bad: claims to be avalanching but isn't, so sequential keys all end up in a few buckets
+struct bad_avalanching_hash {
+    using is_avalanching = void;
+
+    [[nodiscard]] auto operator()(uint64_t x) const noexcept -> uint64_t {
+        return x;
+    }
+};
+
+#if defined(ANKERL_UNORDERED_DENSE_PMR)
+
+class counting_memory_resource : public ANKERL_UNORDERED_DENSE_PMR::memory_resource {
+    std::size_t m_current = 0;
+
+    auto do_allocate(std::size_t bytes, std::size_t alignment) -> void* override {
+        m_current += bytes;
+        return ANKERL_UNORDERED_DENSE_PMR::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+        m_current -= bytes;
+        return ANKERL_UNORDERED_DENSE_PMR::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    [[nodiscard]] auto do_is_equal(const ANKERL_UNORDERED_DENSE_PMR::memory_resource& other) const noexcept -> bool override {
+        return this == &other;
+    }
+
+public:
+    [[nodiscard]] auto current() const -> std::size_t {
+        return m_current;
+    }
+};
+
+#endif
+
+} // namespace
+
+TYPE_TO_STRING_MAP(uint64_t, uint64_t, bad_avalanching_hash);
+
+TEST_CASE_MAP("memory_usage", uint64_t, uint64_t) {
+    auto map = map_t();
+    auto before = map.memory_usage();
+    REQUIRE(before >= map.bucket_count() * sizeof(typename map_t::bucket_type));
+
+    for (uint64_t i = 0; i < 10000; ++i) {
+        map.try_emplace(i, i);
+    }
+    REQUIRE(map.memory_usage() > before);
+    REQUIRE(map.memory_usage() >= map.size() * sizeof(typename map_t::value_type) +
+                                      map.bucket_count() * sizeof(typename map_t::bucket_type));
+}
+
+TEST_CASE("sizeof_map") {
+    // stable index mode and min_load_factor() allocate their state when they are used, other tables don't pay for it
+    static_assert(sizeof(ankerl::unordered_dense::map<int, int>) <= 64);
+    auto map = ankerl::unordered_dense::map<int, int>();
+    auto const empty_memory = map.memory_usage();
+    map.min_load_factor(0.1F);
+    REQUIRE(map.memory_usage() > empty_memory);
+    map.min_load_factor(0.0F);
+    REQUIRE(map.memory_usage() == empty_memory);
+}
+
+TEST_CASE("estimated_memory") {
+    using map_t = ankerl::unordered_dense::map<uint64_t, uint64_t>;
+    using segmented_map_t = ankerl::unordered_dense::segmented_map<uint64_t, uint64_t>;
+
+    for (std::size_t n : {0U, 1U, 10U, 1000U, 12345U}) {
+        auto map = map_t();
+        map.reserve(n);
+        REQUIRE(map.memory_usage() == map_t::estimated_memory(n));
+
+        auto segmented_map = segmented_map_t();
+        segmented_map.reserve(n);
+        REQUIRE(segmented_map.memory_usage() == segmented_map_t::estimated_memory(n));
+    }
+
+    static_assert(map_t::estimated_memory(1000) > 1000 * sizeof(map_t::value_type));
+}
+
+#if defined(ANKERL_UNORDERED_DENSE_PMR)
+
+TEST_CASE_PMR_MAP("memory_usage_pmr", uint64_t, uint64_t) {
+    auto mr = counting_memory_resource();
+    {
+        auto map = map_t(&mr);
+        REQUIRE(map.memory_usage() == mr.current());
+        for (uint64_t i = 0; i < 20000; ++i) {
+            map.try_emplace(i, i);
+            if (0 == i % 1000) {
+                REQUIRE(map.memory_usage() == mr.current());
+            }
+        }
+        map.clear();
+        REQUIRE(map.memory_usage() == mr.current());
+        map.rehash(0);
+        REQUIRE(map.memory_usage() == mr.current());
+    }
+    REQUIRE(mr.current() == 0U);
+}
+
+#endif
+
+TEST_CASE_MAP("probe_stats", uint64_t, uint64_t) {
+    auto map = map_t();
+    auto stats = map.probe_stats();
+    REQUIRE(stats.histogram.empty());
+    REQUIRE(stats.max_probe_length == 0U);
+    REQUIRE(stats.empty_bucket_fraction == doctest::Approx(0.0)); // no buckets allocated yet
+
+    for (uint64_t i = 0; i < 10000; ++i) {
+        map.try_emplace(i, i);
+    }
+    stats = map.probe_stats();
+
+    auto num_elements = std::size_t{};
+    for (auto n : stats.histogram) {
+        num_elements += n;
+    }
+    REQUIRE(num_elements == map.size());
+    REQUIRE(stats.histogram.size() == stats.max_probe_length + 1U);
+    REQUIRE(stats.average_probe_length < 2.0);
+    auto const expected_empty_fraction =
+        1.0 - static_cast<double>(map.size()) / static_cast<double>(map.bucket_count());
+    REQUIRE(stats.empty_bucket_fraction == doctest::Approx(expected_empty_fraction));
+}
+
+TEST_CASE_MAP("probe_stats_table_addresses", uint64_t, uint64_t) {
+    // Each table permutes the hash depending on its address. Whichever permutation it gets, the probe lengths have to
+    // stay as short as with a good hash.
+    auto maps = std::vector<map_t>(16);
+    for (auto& map : maps) {
+        for (uint64_t i = 0; i < 150000; ++i) {
+            map.try_emplace(i, i);
+        }
+        // load factor 0.57, where a good hash averages 0.67
+        auto const stats = map.probe_stats();
+        REQUIRE(stats.average_probe_length < 1.0);
+        REQUIRE(stats.max_probe_length < 24U);
+        map = map_t();
+    }
+}
+
+TEST_CASE_MAP("probe_stats_bad_hash", uint64_t, uint64_t, bad_avalanching_hash) {
+    auto map = map_t();
+    for (uint64_t i = 0; i < 1000; ++i) {
+        map.try_emplace(i, i);
+    }
+    auto stats = map.probe_stats();
+    // the bucket index ignores the lowest 8 bits, so that's 4 groups of 256 keys
+    REQUIRE(stats.max_probe_length > 200U);
+    REQUIRE(stats.average_probe_length > 100.0);
+}
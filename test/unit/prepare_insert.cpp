@@ -0,0 +1,88 @@
+#include <ankerl/unordered_dense.h>
+
+#include <app/doctest.h>
+
+#include <cstddef>     // for size_t
+#include <cstdint>     // for uint64_t
+#include <string>      // for string
+#include <string_view> // for string_view
+
+namespace {
+
+struct string_hash {
+    using is_transparent = void;
+    using is_avalanching = void;
+
+    [[nodiscard]] auto operator()(std::string_view str) const noexcept -> uint64_t {
+        return ankerl::unordered_dense::hash<std::string_view>{}(str);
+    }
+};
+
+struct string_eq {
+    using is_transparent = void;
+
+    [[nodiscard]] auto operator()(std::string_view a, std::string_view b) const noexcept -> bool {
+        return a == b;
+    }
+};
+
+} // namespace
+
+TYPE_TO_STRING_MAP(std::string, size_t, string_hash, string_eq);
+
+TEST_CASE_MAP("prepare_insert", uint64_t, std::string) {
+    auto map = map_t();
+    size_t num_computed = 0;
+    auto compute = [&](uint64_t key) {
+        ++num_computed;
+        return std::to_string(key);
+    };
+
+    // inserts plenty of keys so commit() has to grow the table several times, and every key is looked up a second time
+    for (uint64_t i = 0; i < 2000; ++i) {
+        for (uint64_t key : {i, i / 2}) {
+            auto slot = map.prepare_insert(key);
+            auto it = slot.found() ? slot.position() : map.commit(slot, key, compute(key));
+            REQUIRE(it->first == key);
+            REQUIRE(it->second == std::to_string(key));
+        }
+    }
+    REQUIRE(map.size() == 2000U);
+    REQUIRE(num_computed == 2000U);
+    for (uint64_t i = 0; i < 2000; ++i) {
+        REQUIRE(map.find(i)->second == std::to_string(i));
+    }
+
+    auto slot = map.prepare_insert(1234);
+    REQUIRE(slot.found());
+    REQUIRE(slot.position() == map.find(1234));
+    REQUIRE_FALSE(map.prepare_insert(2000).found());
+}
+
+TEST_CASE_SET("prepare_insert_set", uint64_t) {
+    auto set = set_t();
+    for (uint64_t i = 0; i < 1000; ++i) {
+        auto slot = set.prepare_insert(i % 500);
+        if (i < 500) {
+            REQUIRE_FALSE(slot.found());
+            REQUIRE(*set.commit(slot, i) == i);
+        } else {
+            REQUIRE(slot.found());
+            REQUIRE(*slot.position() == i % 500);
+        }
+    }
+    REQUIRE(set.size() == 500U);
+}
+
+TEST_CASE_MAP("prepare_insert_transparent", std::string, size_t, string_hash, string_eq) {
+    auto map = map_t();
+    for (size_t i = 0; i < 100; ++i) {
+        auto const str = std::to_string(i % 50);
+        auto slot = map.prepare_insert(std::string_view(str));
+        if (!slot.found()) {
+            map.commit(slot, std::string_view(str), i);
+        }
+    }
+    REQUIRE(map.size() == 50U);
+    REQUIRE(map.find(std::string_view("7"))->second == 7U);
+}
@@ -0,0 +1,91 @@
+#include <ankerl/unordered_dense.h>
+
+#include <app/doctest.h>
+
+#include <cstddef> // for size_t
+#include <cstdint> // for uint64_t
+#include <string>  // for string, to_string
+
+namespace {
+
+// Claims to be avalanching but isn't. Sequential keys differ only in the lower bits, so they all end up in the first
+// buckets without a seed.
+struct identity_avalanching_hash {
+    using is_avalanching = void;
+
+    [[nodiscard]] auto operator()(uint64_t x) const noexcept -> uint64_t {
+        return x;
+    }
+};
+
+// Keys below 1000 all have exactly the same hash, no seed can help with that.
+struct colliding_hash {
+    [[nodiscard]] auto operator()(uint64_t x) const noexcept -> uint64_t {
+        return x < 1000 ? 0 : x;
+    }
+};
+
+} // namespace
+
+TYPE_TO_STRING_MAP(uint64_t, uint64_t, ankerl::unordered_dense::seeded_hash<uint64_t, identity_avalanching_hash>);
+TYPE_TO_STRING_SET(uint64_t, ankerl::unordered_dense::seeded_hash<uint64_t, colliding_hash>);
+
+TEST_CASE("seeded_hash_differs_per_instance") {
+    using map_t = ankerl::unordered_dense::map<std::string, std::size_t, ankerl::unordered_dense::seeded_hash<std::string>>;
+
+    auto a = map_t();
+    auto b = map_t();
+    REQUIRE(a.hash_function().seed() != b.hash_function().seed());
+
+    for (std::size_t i = 0; i < 1000; ++i) {
+        a[std::to_string(i)] = i;
+        b[std::to_string(i)] = i;
+    }
+    REQUIRE(a == b);
+
+    // a copy has to use the same seed, because the buckets are copied as they are
+    auto c = a;
+    REQUIRE(c.hash_function().seed() == a.hash_function().seed());
+    REQUIRE(c == a);
+    for (std::size_t i = 0; i < 1000; ++i) {
+        REQUIRE(c.at(std::to_string(i)) == i);
+    }
+
+    auto const fixed = ankerl::unordered_dense::seeded_hash<std::string>(123);
+    REQUIRE(fixed.seed() == ankerl::unordered_dense::seeded_hash<std::string>(123).seed());
+    REQUIRE(fixed.seed() != ankerl::unordered_dense::seeded_hash<std::string>(124).seed());
+}
+
+TEST_CASE("seeded_hash_process_secret") {
+    // read once, so all seeds of the process depend on the same random bits
+    auto const& secret = ankerl::unordered_dense::detail::process_secret();
+    REQUIRE(&secret == &ankerl::unordered_dense::detail::process_secret());
+    REQUIRE(secret[0] != secret[1]);
+}
+
+TEST_CASE_MAP("seeded_hash_fixes_bad_hash",
+              uint64_t,
+              uint64_t,
+              ankerl::unordered_dense::seeded_hash<uint64_t, identity_avalanching_hash>) {
+    auto map = map_t();
+    for (uint64_t i = 0; i < 10000; ++i) {
+        map.try_emplace(i, i);
+    }
+    REQUIRE(map.probe_stats().max_probe_length < 64U);
+    REQUIRE(map.hash_function().num_reseeds() == 0U);
+}
+
+TEST_CASE_SET("seeded_hash_gives_up_reseeding", uint64_t, ankerl::unordered_dense::seeded_hash<uint64_t, colliding_hash>) {
+    using hash_t = ankerl::unordered_dense::seeded_hash<uint64_t, colliding_hash>;
+
+    auto set = set_t();
+    for (uint64_t i = 0; i < 1100; ++i) {
+        set.insert(i);
+    }
+    REQUIRE(set.size() == 1100U);
+    REQUIRE(set.hash_function().num_reseeds() == hash_t::max_num_reseeds);
+    for (uint64_t i = 0; i < 1100; ++i) {
+        REQUIRE(set.contains(i));
+    }
+    REQUIRE_FALSE(set.contains(2000));
+}
@@ -0,0 +1,159 @@
+#include <ankerl/unordered_dense.h>
+
+#include <app/doctest.h>
+
+#include <cstddef> // for size_t
+#include <cstdint> // for uint64_t
+#include <string>  // for string, to_string
+
+TEST_CASE_MAP("shrink_disabled_by_default", uint64_t, uint64_t) {
+    auto map = map_t();
+    REQUIRE(static_cast<double>(map.min_load_factor()) == doctest::Approx(0.0));
+    for (uint64_t i = 0; i < 10000; ++i) {
+        map.try_emplace(i, i);
+    }
+    auto const num_buckets = map.bucket_count();
+    for (uint64_t i = 10; i < 10000; ++i) {
+        REQUIRE(map.erase(i) == 1U);
+    }
+    REQUIRE(map.bucket_count() == num_buckets);
+    map.clear();
+    REQUIRE(map.bucket_count() == num_buckets);
+}
+
+TEST_CASE_MAP("shrink_min_load_factor", uint64_t, std::string) {
+    auto map = map_t();
+    map.min_load_factor(0.1F);
+    REQUIRE(static_cast<double>(map.min_load_factor()) == doctest::Approx(0.1));
+    map.min_load_factor(0.5F);
+    REQUIRE(static_cast<double>(map.min_load_factor()) == doctest::Approx(0.2));
+    map.min_load_factor(0.1F);
+
+    for (uint64_t i = 0; i < 100000; ++i) {
+        map.try_emplace(i, std::to_string(i));
+    }
+    auto const full_buckets = map.bucket_count();
+    auto const full_memory = map.memory_usage();
+
+    auto num_shrinks = size_t{};
+    auto num_buckets = map.bucket_count();
+    for (uint64_t i = 1000; i < 100000; ++i) {
+        REQUIRE(map.erase(i) == 1U);
+        REQUIRE(map.load_factor() >= map.min_load_factor());
+        if (map.bucket_count() != num_buckets) {
+            ++num_shrinks;
+            // shrinking leaves room in both directions
+            REQUIRE(map.bucket_count() < num_buckets);
+            REQUIRE(map.load_factor() <= map.max_load_factor() / 2);
+            num_buckets = map.bucket_count();
+        }
+    }
+    REQUIRE(num_shrinks > 0U);
+    REQUIRE(num_shrinks < 10U); // shrinks in big steps, not at every erase
+    REQUIRE(map.bucket_count() <= full_buckets / 16);
+    REQUIRE(map.memory_usage() < full_memory / 16);
+    for (uint64_t i = 0; i < 1000; ++i) {
+        REQUIRE(map.at(i) == std::to_string(i));
+    }
+
+    // hysteresis: inserting and erasing around the current size doesn't resize
+    num_buckets = map.bucket_count();
+    for (uint64_t i = 0; i < 1000; ++i) {
+        map.try_emplace(1000000 + i, "x");
+        REQUIRE(map.erase(1000000 + i) == 1U);
+    }
+    REQUIRE(map.bucket_count() == num_buckets);
+
+    // erase_if and clear shrink too
+    std::erase_if(map, [](auto const& kv) {
+        return kv.first >= 10;
+    });
+    REQUIRE(map.size() == 10U);
+    REQUIRE(map.bucket_count() < num_buckets);
+    REQUIRE(map.load_factor() >= map.min_load_factor());
+
+    map.clear();
+    auto empty = map_t();
+    empty.min_load_factor(0.1F);
+    REQUIRE(map.bucket_count() == empty.bucket_count());
+    REQUIRE(map.memory_usage() == empty.memory_usage());
+
+    // still usable
+    for (uint64_t i = 0; i < 1000; ++i) {
+        map.try_emplace(i, std::to_string(i));
+    }
+    REQUIRE(map.size() == 1000U);
+    REQUIRE(map.at(999) == "999");
+
+    // copies keep the setting, max_load_factor() limits it
+    auto copy = map;
+    REQUIRE(static_cast<double>(copy.min_load_factor()) == doctest::Approx(0.1));
+    copy.max_load_factor(0.2F);
+    REQUIRE(static_cast<double>(copy.min_load_factor()) == doctest::Approx(0.05));
+}
+
+TEST_CASE_MAP("shrink_min_load_factor_stable_indices", uint64_t, uint64_t) {
+    auto map = map_t();
+    map.stable_indices(true);
+    map.min_load_factor(0.2F);
+    for (uint64_t i = 0; i < 100000; ++i) {
+        map.try_emplace(i, i);
+    }
+    auto const full_buckets = map.bucket_count();
+    for (uint64_t i = 0; i < 90000; ++i) {
+        REQUIRE(map.erase(i) == 1U);
+    }
+
+    // the values stay dense, so the table shrinks like without stable indices, and the indices don't change
+    REQUIRE(map.values().size() == 10000U);
+    REQUIRE(map.bucket_count() < full_buckets);
+    REQUIRE(map.load_factor() >= map.min_load_factor());
+    for (uint64_t i = 90000; i < 100000; ++i) {
+        REQUIRE(map.find_index(i) == i);
+    }
+
+    auto const num_buckets = map.bucket_count();
+    for (uint64_t i = 0; i < 1000; ++i) {
+        map.try_emplace(1000000 + i, i);
+        REQUIRE(map.find_index(1000000 + i) == 89999U);
+        REQUIRE(map.erase(1000000 + i) == 1U);
+    }
+    REQUIRE(map.bucket_count() == num_buckets);
+    REQUIRE(map.size() == 10000U);
+}
+
+TEST_CASE_MAP("shrink_to_fit", uint64_t, uint64_t) {
+    auto map = map_t();
+    map.reserve(100000);
+    for (uint64_t i = 0; i < 100; ++i) {
+        map.try_emplace(i, i);
+    }
+    auto const reserved_memory = map.memory_usage();
+    map.shrink_to_fit();
+    REQUIRE(map.memory_usage() < reserved_memory / 100);
+    REQUIRE(map.load_factor() > map.max_load_factor() / 2);
+    REQUIRE(map.size() == 100U);
+    for (uint64_t i = 0; i < 100; ++i) {
+        REQUIRE(map.at(i) == i);
+    }
+
+    // stable indices stay the same
+    map.stable_indices(true);
+    for (uint64_t i = 0; i < 90; ++i) {
+        REQUIRE(map.erase(i) == 1U);
+    }
+    auto const sparse_memory = map.memory_usage();
+    map.shrink_to_fit();
+    REQUIRE(map.memory_usage() < sparse_memory);
+    for (uint64_t i = 90; i < 100; ++i) {
+        REQUIRE(map.find_index(i) == i);
+    }
+    map.try_emplace(uint64_t{1000}, uint64_t{1000});
+    REQUIRE(map.find_index(1000) == 89U);
+
+    auto empty = map_t();
+    empty.shrink_to_fit();
+    REQUIRE(empty.empty());
+    empty[1] = 2;
+    REQUIRE(empty.size() == 1U);
+}
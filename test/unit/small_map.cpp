@@ -0,0 +1,252 @@
+#include <ankerl/unordered_dense.h>
+
+#include <app/counter.h>
+#include <app/doctest.h>
+#include <third-party/nanobench.h> // for Rng
+
+#include <cstddef>       // for size_t
+#include <cstdint>       // for uint64_t
+#include <stdexcept>     // for out_of_range, runtime_error
+#include <string>        // for string, to_string
+#include <tuple>         // for forward_as_tuple
+#include <unordered_map> // for unordered_map
+#include <utility>       // for move, pair, piecewise_construct
+#include <vector>        // for vector
+
+namespace {
+
+// Throws for one key, but only once the elements are in a table: inline lookups don't hash.
+struct throwing_hash {
+    using is_avalanching = void;
+
+    [[nodiscard]] auto operator()(std::string const& key) const -> uint64_t {
+        if (key == "throw") {
+            throw std::runtime_error("throwing_hash");
+        }
+        return ankerl::unordered_dense::hash<std::string>{}(key);
+    }
+};
+
+} // namespace
+
+TEST_CASE("small_map") {
+    using map_t = ankerl::unordered_dense::small_map<std::string, uint64_t, 4>;
+    static_assert(map_t::inline_capacity() == 4U);
+
+    auto map = map_t();
+    REQUIRE(map.empty());
+    REQUIRE(map.is_inline());
+    REQUIRE(map.begin() == map.end());
+    REQUIRE(map.find("a") == map.end());
+
+    REQUIRE(map.try_emplace("a", 1).second);
+    REQUIRE_FALSE(map.try_emplace("a", 2).second);
+    REQUIRE(map.emplace("b", 2).second);
+    REQUIRE_FALSE(map.emplace("b", 3).second);
+    REQUIRE(map.insert({"c", 3}).second);
+    map["d"] = 4;
+    REQUIRE(map.insert_or_assign("d", 5).second == false);
+    REQUIRE(map.size() == 4U);
+    REQUIRE(map.is_inline());
+    REQUIRE(map.memory_usage() == 0U);
+    REQUIRE(map.at("b") == 2U);
+    REQUIRE(map.at("d") == 5U);
+    REQUIRE(map.contains("c"));
+    REQUIRE(map.count("x") == 0U);
+    REQUIRE_THROWS_AS(map.at("x"), std::out_of_range);
+
+    // the fifth element moves everything to the heap
+    map["e"] = 6;
+    REQUIRE_FALSE(map.is_inline());
+    REQUIRE(map.memory_usage() > 0U);
+    REQUIRE(map.size() == 5U);
+    uint64_t sum = 0;
+    for (auto const& [key, val] : map) {
+        REQUIRE(map.find(key)->second == val);
+        sum += val;
+    }
+    REQUIRE(sum == 1 + 2 + 3 + 5 + 6);
+
+    // erase and shrink back into inline storage
+    REQUIRE(map.erase("a") == 1U);
+    REQUIRE(map.erase("a") == 0U);
+    REQUIRE_FALSE(map.is_inline());
+    map.shrink_to_fit();
+    REQUIRE(map.is_inline());
+    REQUIRE(map.memory_usage() == 0U);
+    REQUIRE(map.size() == 4U);
+    REQUIRE(map.at("e") == 6U);
+
+    auto it = map.erase(map.find("b"));
+    REQUIRE(map.size() == 3U);
+    REQUIRE(it != map.end());
+    REQUIRE_FALSE(map.contains("b"));
+
+    REQUIRE(std::erase_if(map, [](auto const& kv) {
+                return kv.second > 4;
+            }) == 2U);
+    REQUIRE(map.size() == 1U);
+    REQUIRE(map.at("c") == 3U);
+
+    map.clear();
+    REQUIRE(map.empty());
+}
+
+TEST_CASE("small_map_copy_and_move") {
+    using map_t = ankerl::unordered_dense::small_map<uint64_t, std::string, 3>;
+    for (uint64_t num_elements : {0U, 2U, 3U, 10U}) {
+        auto map = map_t();
+        for (uint64_t i = 0; i < num_elements; ++i) {
+            map[i] = std::to_string(i);
+        }
+
+        auto copy = map;
+        REQUIRE(copy == map);
+        REQUIRE(copy.is_inline() == map.is_inline());
+        copy[100] = "100";
+        REQUIRE(copy != map);
+
+        auto moved = std::move(copy);
+        REQUIRE(moved.size() == num_elements + 1);
+        REQUIRE(moved.at(100) == "100");
+        REQUIRE(copy.empty()); // NOLINT(bugprone-use-after-move,hicpp-invalid-access-moved)
+        REQUIRE(copy.is_inline());
+        copy[1] = "x";
+        REQUIRE(copy.size() == 1U);
+
+        copy = map;
+        REQUIRE(copy == map);
+        moved = std::move(copy);
+        REQUIRE(moved == map);
+
+        auto swapped = map_t{{7, "7"}};
+        swapped.swap(moved);
+        REQUIRE(swapped == map);
+        REQUIRE(moved.size() == 1U);
+    }
+}
+
+TEST_CASE("small_map_copy_assign_releases_table") {
+    using map_t = ankerl::unordered_dense::small_map<uint64_t, uint64_t, 2>;
+    auto map = map_t();
+    for (uint64_t i = 0; i < 100; ++i) {
+        map[i] = i;
+    }
+    REQUIRE(map.memory_usage() > 0U);
+
+    // switching back to inline through assignment doesn't keep the table's memory
+    auto const small = map_t{{1, 2}};
+    map = small;
+    REQUIRE(map.is_inline());
+    REQUIRE(map.memory_usage() == 0U);
+    REQUIRE(map == small);
+}
+
+TEST_CASE("small_map_move_to_table_throws") {
+    // std::string moves without throwing, so the elements are moved into the table and back out again
+    using map_t = ankerl::unordered_dense::small_map<std::string, std::string, 3, throwing_hash>;
+    auto map = map_t();
+    map["a"] = std::string(100, 'a');
+    map["throw"] = std::string(100, 't');
+    map["c"] = std::string(100, 'c');
+    REQUIRE(map.is_inline());
+
+    REQUIRE_THROWS_AS(map["d"], std::runtime_error);
+    REQUIRE(map.is_inline());
+    REQUIRE(map.size() == 3U);
+    REQUIRE(map.memory_usage() == 0U);
+    REQUIRE(map.at("a") == std::string(100, 'a'));
+    REQUIRE(map.at("throw") == std::string(100, 't'));
+    REQUIRE(map.at("c") == std::string(100, 'c'));
+}
+
+TEST_CASE("small_map_lifetime") {
+    auto counts = counter();
+    INFO(counts);
+    {
+        using map_t = ankerl::unordered_dense::small_map<counter::obj, counter::obj, 8>;
+        auto rng = ankerl::nanobench::Rng(123);
+        auto maps = std::vector<map_t>(10);
+        for (size_t i = 0; i < 2000; ++i) {
+            auto& map = maps[rng.bounded(10)];
+            auto key = rng.bounded(12);
+            switch (rng.bounded(5)) {
+            case 0:
+                map.try_emplace({key, counts}, i, counts);
+                break;
+            case 1:
+                map.emplace(std::piecewise_construct,
+                            std::forward_as_tuple(key, counts),
+                            std::forward_as_tuple(i, counts));
+                break;
+            case 2:
+                map.erase({key, counts});
+                break;
+            case 3:
+                if (rng.bounded(20) == 0) {
+                    map.shrink_to_fit();
+                } else if (rng.bounded(20) == 0) {
+                    map.clear();
+                }
+                break;
+            default:
+                maps[rng.bounded(10)] = map;
+                break;
+            }
+        }
+    }
+    REQUIRE(counts.dtor() ==
+            counts.ctor() + counts.static_default_ctor + counts.copy_ctor() + counts.default_ctor() + counts.move_ctor());
+}
+
+TEST_CASE("small_map_random") {
+    auto rng = ankerl::nanobench::Rng(321);
+    auto map = ankerl::unordered_dense::small_map<uint64_t, uint64_t, 8>();
+    auto ref = std::unordered_map<uint64_t, uint64_t>();
+    for (size_t i = 0; i < 20000; ++i) {
+        auto key = rng.bounded(16);
+        switch (rng.bounded(4)) {
+        case 0:
+        case 1:
+            map[key] = i;
+            ref[key] = i;
+            break;
+        case 2:
+            REQUIRE(map.erase(key) == ref.erase(key));
+            break;
+        default:
+            if (rng.bounded(10) == 0) {
+                map.shrink_to_fit();
+                REQUIRE(map.is_inline() == (map.size() <= 8));
+            }
+            break;
+        }
+        REQUIRE(map.size() == ref.size());
+        for (auto const& [k, v] : ref) {
+            REQUIRE(map.at(k) == v);
+        }
+    }
+}
+
+TEST_CASE("small_set") {
+    using set_t = ankerl::unordered_dense::small_set<uint64_t, 2>;
+    auto set = set_t{1, 2, 2};
+    REQUIRE(set.size() == 2U);
+    REQUIRE(set.is_inline());
+    REQUIRE(set.insert(3).second);
+    REQUIRE_FALSE(set.insert(3).second);
+    REQUIRE_FALSE(set.is_inline());
+    REQUIRE(set.contains(1));
+    REQUIRE(set.erase(1) == 1U);
+    set.shrink_to_fit();
+    REQUIRE(set.is_inline());
+    REQUIRE(set == set_t{2, 3});
+
+    // reserve() beyond the inline capacity moves to the heap right away
+    auto reserved = set_t();
+    reserved.reserve(2);
+    REQUIRE(reserved.is_inline());
+    reserved.reserve(100);
+    REQUIRE_FALSE(reserved.is_inline());
+    REQUIRE(reserved.empty());
+}
@@ -0,0 +1,284 @@
+#include <ankerl/unordered_dense.h>
+
+#include <app/doctest.h>
+#include <third-party/nanobench.h> // for Rng
+
+#include <cstddef>       // for size_t
+#include <cstdint>       // for uint64_t
+#include <iterator>      // for distance
+#include <memory>        // for shared_ptr, make_shared
+#include <stdexcept>     // for out_of_range
+#include <string>        // for string, to_string
+#include <unordered_map> // for unordered_map
+#include <utility>       // for move
+#include <vector>        // for vector
+
+namespace {
+
+// Checks that the map has exactly the content of ref, and that all elements are found through their index.
+template <typename Map>
+void require_same(Map const& map, std::unordered_map<uint64_t, uint64_t> const& ref) {
+    REQUIRE(map.size() == ref.size());
+    REQUIRE(static_cast<size_t>(std::distance(map.begin(), map.end())) == ref.size());
+    for (auto it = map.begin(); it != map.end(); ++it) {
+        REQUIRE(ref.at(it->first) == it->second);
+        auto const idx = map.index_of(it);
+        REQUIRE(map.find_index(it->first) == idx);
+        REQUIRE_FALSE(map.is_free_index(idx));
+        REQUIRE(&map.at_index(idx) == &*it);
+    }
+}
+
+} // namespace
+
+TEST_CASE_MAP("stable_indices", uint64_t, std::string) {
+    auto map = map_t();
+    REQUIRE_FALSE(map.stable_indices());
+    map.stable_indices(true);
+    REQUIRE(map.stable_indices());
+
+    // a side array with one attribute per element, indexed the same way as the map
+    auto side = std::vector<uint64_t>();
+    for (uint64_t i = 0; i < 100; ++i) {
+        map.try_emplace(i, std::to_string(i));
+        side.push_back(i * 10);
+    }
+
+    auto is_erased = [](uint64_t i) {
+        return i % 3 == 0 && i != 99;
+    };
+    for (uint64_t i = 0; i < 99; i += 3) {
+        REQUIRE(map.erase(i) == 1U);
+    }
+
+    // the values stay dense, only the indices have holes
+    REQUIRE(map.size() == 67U);
+    REQUIRE(map.values().size() == 67U);
+    REQUIRE(static_cast<size_t>(map.end() - map.begin()) == map.size());
+    for (uint64_t i = 0; i < 100; ++i) {
+        REQUIRE(map.is_free_index(i) == is_erased(i));
+        if (!is_erased(i)) {
+            // the side array is still in sync
+            auto idx = map.find_index(i);
+            REQUIRE(idx == i);
+            REQUIRE(side[*idx] == i * 10);
+            REQUIRE(map.at_index(*idx).second == std::to_string(i));
+        } else {
+            REQUIRE_FALSE(map.find_index(i));
+            REQUIRE_THROWS_AS(map.at_index(i), std::out_of_range);
+        }
+    }
+    REQUIRE_THROWS_AS(map.at_index(100), std::out_of_range);
+
+    // new elements take the free indices, the most recently freed one first
+    for (uint64_t i = 1000; i < 1033; ++i) {
+        auto it = map.try_emplace(i, std::to_string(i)).first;
+        auto idx = map.index_of(it);
+        REQUIRE(idx == 96 - (i - 1000) * 3);
+        side[idx] = i * 10;
+    }
+    REQUIRE(map.size() == 100U);
+    REQUIRE(map.values().size() == 100U);
+    REQUIRE_FALSE(map.is_free_index(0));
+    map.try_emplace(2000, "2000");
+    REQUIRE(map.find_index(2000) == 100U);
+    side.push_back(20000);
+    for (auto const& [key, val] : map) {
+        REQUIRE(side[*map.find_index(key)] == key * 10);
+        REQUIRE(val == std::to_string(key));
+    }
+}
+
+TEST_CASE_MAP("stable_indices_destroys_erased", uint64_t, std::shared_ptr<int>) {
+    auto map = map_t();
+    map.stable_indices(true);
+    auto ptr = std::make_shared<int>(123);
+    for (uint64_t i = 0; i < 10; ++i) {
+        map.try_emplace(i, ptr);
+    }
+    REQUIRE(ptr.use_count() == 11);
+
+    REQUIRE(map.erase(uint64_t{3}) == 1U);
+    REQUIRE(map.extract(uint64_t{5})->second == ptr);
+    REQUIRE(map.erase(map.find(7)) != map.end());
+    REQUIRE(ptr.use_count() == 8);
+
+    // copies only see the elements, so they can't resurrect erased keys
+    auto copy = map_t(map.begin(), map.end());
+    REQUIRE(copy.size() == 7U);
+    REQUIRE_FALSE(copy.contains(3));
+    REQUIRE_FALSE(copy.contains(5));
+    REQUIRE_FALSE(copy.contains(7));
+    REQUIRE(ptr.use_count() == 15);
+}
+
+TEST_CASE_MAP("stable_indices_compact", uint64_t, std::string) {
+    auto map = map_t();
+    map.stable_indices(true);
+    for (uint64_t i = 0; i < 10; ++i) {
+        map.try_emplace(i, std::to_string(i));
+    }
+
+    // erasing the element with the highest index doesn't leave a free index behind
+    REQUIRE(map.erase(uint64_t{9}) == 1U);
+    REQUIRE_FALSE(map.is_free_index(9));
+    REQUIRE(map.index_of(map.try_emplace(uint64_t{9}, "9").first) == 9U);
+    REQUIRE(map.erase(uint64_t{9}) == 1U);
+
+    REQUIRE(map.erase(uint64_t{1}) == 1U);
+    REQUIRE(map.extract(uint64_t{4})->second == "4");
+    auto it = map.erase(map.find(5));
+    REQUIRE(it->first == 6U); // the last element has moved into the hole
+    REQUIRE(map.values().size() == 6U);
+    REQUIRE(map.size() == 6U);
+    REQUIRE(map.is_free_index(5));
+
+    map.compact();
+    REQUIRE_FALSE(map.is_free_index(5));
+    auto expected = std::vector<uint64_t>{0, 2, 3, 6, 7, 8};
+    for (size_t i = 0; i < expected.size(); ++i) {
+        REQUIRE(map.find_index(expected[i]) == i);
+        REQUIRE(map.at_index(i).second == std::to_string(expected[i]));
+        REQUIRE_FALSE(map.is_free_index(i));
+    }
+    REQUIRE(map.stable_indices());
+
+    // switching off sorts the values by index, so the indices stay valid
+    REQUIRE(map.erase(uint64_t{0}) == 1U);
+    map.stable_indices(false);
+    REQUIRE_FALSE(map.stable_indices());
+    REQUIRE(map.values().size() == 5U);
+    for (size_t i = 1; i < expected.size(); ++i) {
+        REQUIRE(map.values()[i - 1].first == expected[i]);
+        REQUIRE(map.find_index(expected[i]) == i - 1);
+    }
+    REQUIRE(map.erase(uint64_t{2}) == 1U);
+    REQUIRE(map.values()[0].first == 8U); // back to moving the last element into the hole
+    REQUIRE(map.find_index(8) == 0U);
+}
+
+TEST_CASE_MAP("stable_indices_whole_table", uint64_t, uint64_t) {
+    auto map = map_t();
+    map.stable_indices(true);
+    for (uint64_t i = 0; i < 100; ++i) {
+        map.try_emplace(i, i);
+    }
+    REQUIRE(map.erase(uint64_t{50}) == 1U);
+    REQUIRE(map.erase(uint64_t{10}) == 1U);
+
+    auto copy = map;
+    REQUIRE(copy.stable_indices());
+    REQUIRE(copy == map);
+    REQUIRE(copy.is_free_index(10));
+    auto it_inserted = copy.try_emplace(200, 200).first;
+    REQUIRE(copy.index_of(it_inserted) == 10U);
+    REQUIRE(copy != map);
+    REQUIRE(copy.erase(uint64_t{200}) == 1U);
+    REQUIRE(copy == map);
+
+    auto moved = std::move(copy);
+    REQUIRE(moved == map);
+    REQUIRE(moved.is_free_index(10));
+
+    REQUIRE(std::erase_if(moved, [](auto const& kv) {
+                return kv.first < 20;
+            }) == 19U);
+    REQUIRE(moved.size() == 79U);
+    REQUIRE(moved.find_index(20) == 20U);
+    REQUIRE(moved.find_index(99) == 99U);
+    auto it = moved.erase(moved.begin() + 40, moved.begin() + 60);
+    REQUIRE(moved.size() == 59U);
+    REQUIRE(it == moved.begin() + 40);
+    REQUIRE(static_cast<size_t>(moved.end() - moved.begin()) == 59U);
+    require_same(moved, {moved.begin(), moved.end()});
+
+    // the extracted container only has the elements
+    auto values = std::move(moved).extract();
+    REQUIRE(values.size() == 59U);
+}
+
+TEST_CASE_MAP("stable_indices_replace", uint64_t, uint64_t) {
+    auto map = map_t();
+    map.stable_indices(true);
+    for (uint64_t i = 0; i < 10; ++i) {
+        map.try_emplace(i, i);
+    }
+    REQUIRE(map.erase(uint64_t{3}) == 1U);
+
+    // the new elements are numbered by their position again
+    auto container = typename map_t::value_container_type();
+    container.emplace_back(5, 5);
+    container.emplace_back(6, 6);
+    container.emplace_back(5, 7);
+    container.emplace_back(8, 8);
+    map.replace(std::move(container));
+    REQUIRE(map.size() == 3U);
+    REQUIRE_FALSE(map.is_free_index(3));
+    for (auto it = map.begin(); it != map.end(); ++it) {
+        REQUIRE(map.index_of(it) == static_cast<size_t>(it - map.begin()));
+    }
+    map.try_emplace(uint64_t{100}, uint64_t{100});
+    REQUIRE(map.find_index(100) == 3U);
+
+    map.clear();
+    REQUIRE(map.empty());
+    REQUIRE(map.try_emplace(uint64_t{1}, uint64_t{1}).first == map.begin());
+    REQUIRE(map.find_index(1) == 0U);
+}
+
+TEST_CASE_MAP("stable_indices_random", uint64_t, uint64_t) {
+    auto rng = ankerl::nanobench::Rng(123);
+    auto map = map_t();
+    map.stable_indices(true);
+    auto ref = std::unordered_map<uint64_t, uint64_t>();
+
+    for (size_t i = 0; i < 20000; ++i) {
+        auto key = rng.bounded(2000);
+        switch (rng.bounded(8)) {
+        case 0:
+        case 1:
+        case 2: {
+            auto val = rng();
+            map[key] = val;
+            ref[key] = val;
+            break;
+        }
+        case 3:
+        case 4:
+            REQUIRE(map.erase(key) == ref.erase(key));
+            break;
+        case 5: {
+            // all other elements keep their index
+            auto idx = map.find_index(key);
+            auto other_key = rng.bounded(2000);
+            auto other_idx = map.find_index(other_key);
+            REQUIRE(map.erase(key) == ref.erase(key));
+            if (idx && other_key != key) {
+                REQUIRE(map.find_index(other_key) == other_idx);
+            }
+            break;
+        }
+        case 6:
+            if (rng.bounded(100) == 0) {
+                map.compact();
+                for (size_t idx = 0; idx < map.size(); ++idx) {
+                    REQUIRE_FALSE(map.is_free_index(idx));
+                }
+            }
+            break;
+        default:
+            if (rng.bounded(100) == 0) {
+                map.rehash(rng.bounded(5000));
+            }
+            break;
+        }
+        if (i % 1000 == 0) {
+            require_same(map, ref);
+        }
+    }
+    require_same(map, ref);
+    map.compact();
+    require_same(map, ref);
+    map.stable_indices(false);
+    require_same(map, ref);
+}
@@ -0,0 +1,88 @@
+#include <ankerl/unordered_dense.h>
+
+#include <app/doctest.h>
+
+#include <cstdint>     // for uint64_t
+#include <string>      // for string
+#include <string_view> // for string_view
+#include <tuple>       // for ignore
+
+using namespace std::literals;
+
+namespace {
+
+enum class opcode : std::uint8_t { nop, load, store, jump };
+
+constexpr auto keywords = ankerl::unordered_dense::make_static_map<std::string_view, int>(
+    {{"if", 1}, {"else", 2}, {"while", 3}, {"for", 4}, {"return", 5}, {"break", 6}, {"continue", 7}});
+
+constexpr auto opcodes = ankerl::unordered_dense::static_map<std::uint8_t, opcode, 4>{
+    {{0x00, opcode::nop}, {0x10, opcode::load}, {0x11, opcode::store}, {0x20, opcode::jump}}};
+
+constexpr auto opcode_names = ankerl::unordered_dense::make_static_map<opcode, std::string_view>(
+    {{opcode::nop, "nop"}, {opcode::load, "load"}, {opcode::store, "store"}, {opcode::jump, "jump"}});
+
+// everything is available at compile time
+static_assert(keywords.size() == 7);
+static_assert(keywords.contains("while"));
+static_assert(!keywords.contains("whilst"));
+static_assert(keywords.find("return")->second == 5);
+static_assert(keywords.find("goto") == keywords.end());
+static_assert(keywords.at("continue") == 7);
+static_assert(keywords.count("for") == 1);
+static_assert(opcodes.at(0x11) == opcode::store);
+static_assert(opcode_names.at(opcode::jump) == "jump");
+
+// hashing is possible at compile time, and gives the same result as at runtime
+constexpr auto hash_of_long_string = ankerl::unordered_dense::hash<std::string_view>{}(
+    "a string that is longer than 48 bytes, so that all the different code paths are used"sv);
+constexpr auto hash_of_u16string = ankerl::unordered_dense::hash<std::u16string_view>{}(u"wide chars"sv);
+constexpr auto hash_of_int = ankerl::unordered_dense::hash<int>{}(-123);
+
+} // namespace
+
+TEST_CASE("static_map") {
+    REQUIRE(keywords.size() == 7);
+    for (auto const& [key, val] : keywords) {
+        REQUIRE(keywords.find(key)->second == val);
+    }
+
+    // lookup with runtime data, which implicitly converts to std::string_view
+    auto const str = std::string("else");
+    REQUIRE(keywords.contains(str));
+    REQUIRE(keywords.at(str) == 2);
+    REQUIRE_FALSE(keywords.contains(std::string("els")));
+    REQUIRE_THROWS_AS(std::ignore = keywords.at("elsewhere"), std::out_of_range);
+
+    for (auto [key, val] : opcodes) {
+        REQUIRE(opcodes.at(key) == val);
+        REQUIRE(opcode_names.contains(val));
+    }
+    REQUIRE_FALSE(opcodes.contains(0x12));
+}
+
+TEST_CASE("static_map_empty") {
+    constexpr auto empty = ankerl::unordered_dense::static_map<int, int, 0>({});
+    static_assert(empty.empty());
+    static_assert(!empty.contains(123));
+    REQUIRE(empty.begin() == empty.end());
+}
+
+TEST_CASE("static_map_bad_init") {
+    using map_t = ankerl::unordered_dense::static_map<int, int, 2>;
+    REQUIRE_THROWS_AS(map_t({{1, 1}, {1, 2}}), std::invalid_argument);
+    REQUIRE_THROWS_AS(map_t({{1, 1}, {2, 2}, {3, 3}}), std::invalid_argument);
+}
+
+TEST_CASE("constexpr_hash_same_as_runtime") {
+    auto const str = std::string("a string that is longer than 48 bytes, so that all the different code paths are used");
+    REQUIRE(hash_of_long_string == ankerl::unordered_dense::hash<std::string>{}(str));
+    REQUIRE(hash_of_u16string == ankerl::unordered_dense::hash<std::u16string>{}(u"wide chars"));
+    REQUIRE(hash_of_int == ankerl::unordered_dense::hash<int>{}(-123));
+
+    for (std::size_t len = 0; len <= str.size(); ++len) {
+        auto const sv = std::string_view(str).substr(0, len);
+        REQUIRE(ankerl::unordered_dense::detail::wyhash::hash(static_cast<void const*>(sv.data()), sv.size()) ==
+                ankerl::unordered_dense::hash<std::string_view>{}(sv));
+    }
+}
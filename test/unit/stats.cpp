@@ -0,0 +1,87 @@
+#define ANKERL_UNORDERED_DENSE_STATS 1 // NOLINT(cppcoreguidelines-macro-usage)
+#include <ankerl/unordered_dense.h>
+
+#include <app/doctest.h>
+
+#include <cstddef> // for size_t
+#include <cstdint> // for uint64_t
+#include <tuple>   // for ignore
+#include <vector>  // for vector
+
+TEST_CASE_MAP("stats_find", uint64_t, uint64_t) {
+    auto map = map_t();
+    REQUIRE(map.stats().finds == 0U);
+
+    for (uint64_t i = 0; i < 1000; ++i) {
+        map.try_emplace(i, i);
+    }
+    for (uint64_t i = 0; i < 2000; ++i) {
+        std::ignore = map.contains(i);
+    }
+
+    auto const& stats = map.stats();
+    REQUIRE(stats.finds == 2000U);
+    REQUIRE(stats.hits == 1000U);
+    REQUIRE(stats.misses == 1000U);
+    REQUIRE(stats.hits + stats.misses == stats.finds);
+    REQUIRE(stats.equal_calls >= stats.hits);
+    REQUIRE(stats.increase_size_events > 0U);
+    REQUIRE(stats.rehashes == stats.increase_size_events);
+
+    map.reset_stats();
+    REQUIRE(map.stats().finds == 0U);
+    REQUIRE(map.stats().rehashes == 0U);
+}
+
+TEST_CASE_MAP("stats_shifts", uint64_t, uint64_t) {
+    auto map = map_t();
+    map.reserve(3000);
+    for (uint64_t i = 0; i < 3000; ++i) {
+        map.try_emplace(i, i);
+    }
+    REQUIRE(map.stats().increase_size_events == 0U);
+    REQUIRE(map.stats().shift_down_steps == 0U);
+
+    for (uint64_t i = 0; i < 3000; ++i) {
+        map.erase(i);
+    }
+    REQUIRE(map.empty());
+
+    // with 3000 elements in 4096 buckets there are plenty of collisions
+    REQUIRE(map.stats().shift_up_steps > 0U);
+    REQUIRE(map.stats().shift_down_steps > 0U);
+}
+
+TEST_CASE_MAP("stats_rehash_callback", uint64_t, uint64_t) {
+    auto events = std::vector<ankerl::unordered_dense::rehash_event>();
+    auto map = map_t();
+    map.set_rehash_callback([&events](ankerl::unordered_dense::rehash_event const& ev) {
+        events.push_back(ev);
+    });
+
+    for (uint64_t i = 0; i < 1000; ++i) {
+        map.try_emplace(i, i);
+    }
+    REQUIRE(events.size() == map.stats().increase_size_events);
+    REQUIRE(events.size() == map.stats().rehashes);
+    for (auto const& ev : events) {
+        REQUIRE(ev.new_bucket_count == ev.old_bucket_count * 2);
+        REQUIRE(ev.elapsed.count() >= 0);
+    }
+    REQUIRE(events.back().new_bucket_count == map.bucket_count());
+
+    events.clear();
+    map.rehash(100000);
+    REQUIRE(events.size() == 1U);
+    REQUIRE(events.front().size == map.size());
+    REQUIRE(events.front().new_bucket_count == map.bucket_count());
+
+    // moved-to map takes the callback along
+    auto map2 = std::move(map);
+    map2.reserve(1000000);
+    REQUIRE(events.size() == 2U);
+
+    map2.set_rehash_callback({});
+    map2.reserve(10000000);
+    REQUIRE(events.size() == 2U);
+}
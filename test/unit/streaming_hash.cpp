@@ -0,0 +1,134 @@
+#include <ankerl/unordered_dense.h>
+
+#include <app/doctest.h>
+
+#include <third-party/nanobench.h> // for Rng
+
+#include <cstddef>     // for size_t
+#include <cstdint>     // for uint32_t, uint64_t
+#include <cstring>     // for memcpy
+#include <string>      // for string
+#include <string_view> // for string_view
+
+TEST_CASE("streaming_hash_same_as_concatenated") {
+    auto rng = ankerl::nanobench::Rng(123);
+    auto str = std::string(400, '\0');
+    for (auto& c : str) {
+        c = static_cast<char>(rng());
+    }
+
+    auto const h = ankerl::unordered_dense::hash<std::string_view>();
+    for (std::size_t len = 0; len <= str.size(); ++len) {
+        auto const sv = std::string_view(str.data(), len);
+        auto const expected = h(sv);
+
+        // all at once
+        auto sh = ankerl::unordered_dense::streaming_hash();
+        sh.update(sv);
+        REQUIRE(sh.finish() == expected);
+
+        // byte by byte
+        sh = ankerl::unordered_dense::streaming_hash();
+        for (auto c : sv) {
+            sh.update(&c, 1);
+        }
+        REQUIRE(sh.finish() == expected);
+
+        // random pieces, including empty ones
+        for (int round = 0; round < 4; ++round) {
+            sh = ankerl::unordered_dense::streaming_hash();
+            auto pos = std::size_t();
+            while (pos < len) {
+                auto const n = (std::min)(len - pos, static_cast<std::size_t>(rng.bounded(70)));
+                sh.update(sv.substr(pos, n));
+                pos += n;
+            }
+            REQUIRE(sh.finish() == expected);
+        }
+    }
+}
+
+TEST_CASE("streaming_hash_finish_then_continue") {
+    auto sh = ankerl::unordered_dense::streaming_hash();
+    sh.update(std::string_view("hello, "));
+    REQUIRE(sh.finish() == ankerl::unordered_dense::hash<std::string_view>{}("hello, "));
+    sh.update(std::string_view("world!"));
+    REQUIRE(sh.finish() == ankerl::unordered_dense::hash<std::string_view>{}("hello, world!"));
+}
+
+namespace {
+
+// A key that is stored as one string "<tenant>/<body>" followed by the 4 bytes of the id
+struct composite_key_view {
+    std::string_view tenant;
+    std::string_view body;
+    std::uint32_t id;
+};
+
+auto make_key(composite_key_view const& k) -> std::string {
+    auto str = std::string(k.tenant);
+    str += '/';
+    str += k.body;
+    auto id_bytes = std::string(sizeof(k.id), '\0');
+    std::memcpy(id_bytes.data(), &k.id, sizeof(k.id));
+    return str + id_bytes;
+}
+
+struct composite_hash {
+    using is_transparent = void;
+    using is_avalanching = void;
+
+    [[nodiscard]] auto operator()(std::string_view str) const noexcept -> std::uint64_t {
+        return ankerl::unordered_dense::hash<std::string_view>{}(str);
+    }
+
+    [[nodiscard]] auto operator()(composite_key_view const& k) const noexcept -> std::uint64_t {
+        auto sh = ankerl::unordered_dense::streaming_hash();
+        sh.update(k.tenant);
+        sh.update("/", 1);
+        sh.update(k.body);
+        sh.update_value(k.id);
+        return sh.finish();
+    }
+};
+
+struct composite_equal {
+    using is_transparent = void;
+
+    [[nodiscard]] auto operator()(std::string_view a, std::string_view b) const noexcept -> bool {
+        return a == b;
+    }
+
+    [[nodiscard]] auto operator()(std::string_view str, composite_key_view const& k) const noexcept -> bool {
+        auto const body_pos = k.tenant.size() + 1;
+        auto const id_pos = body_pos + k.body.size();
+        if (str.size() != id_pos + sizeof(k.id)) {
+            return false;
+        }
+        auto id = std::uint32_t();
+        std::memcpy(&id, str.data() + id_pos, sizeof(id));
+        return str.substr(0, k.tenant.size()) == k.tenant && str[k.tenant.size()] == '/' &&
+               str.substr(body_pos, k.body.size()) == k.body && id == k.id;
+    }
+
+    [[nodiscard]] auto operator()(composite_key_view const& k, std::string_view str) const noexcept -> bool {
+        return (*this)(str, k);
+    }
+};
+
+} // namespace
+
+TEST_CASE("streaming_hash_composite_lookup") {
+    auto map = ankerl::unordered_dense::map<std::string, int, composite_hash, composite_equal>();
+    for (std::uint32_t i = 0; i < 100; ++i) {
+        auto const body = std::to_string(i * 1000);
+        map[make_key({"tenant", body, i})] = static_cast<int>(i);
+    }
+
+    auto const body = std::string("42000");
+    auto it = map.find(composite_key_view{"tenant", body, 42});
+    REQUIRE(it != map.end());
+    REQUIRE(it->second == 42);
+    REQUIRE_FALSE(map.contains(composite_key_view{"tenant", body, 43}));
+    REQUIRE_FALSE(map.contains(composite_key_view{"other", body, 42}));
+}
@@ -0,0 +1,126 @@
+#include <ankerl/unordered_dense.h>
+
+#include <app/doctest.h>
+
+#include <cstddef>    // for size_t
+#include <cstdint>    // for uint64_t
+#include <functional> // for equal_to
+#include <memory>     // for allocator
+#include <utility>    // for move, pair
+#include <vector>     // for vector
+
+namespace {
+
+std::size_t g_num_allocations = 0; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+template <typename T>
+struct counting_allocator {
+    using value_type = T;
+
+    counting_allocator() = default;
+
+    template <typename U>
+    counting_allocator(counting_allocator<U> const& /*unused*/) noexcept {} // NOLINT(hicpp-explicit-conversions)
+
+    auto allocate(std::size_t n) -> T* {
+        ++g_num_allocations;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U>
+    auto operator==(counting_allocator<U> const& /*unused*/) const noexcept -> bool {
+        return true;
+    }
+
+    template <typename U>
+    auto operator!=(counting_allocator<U> const& /*unused*/) const noexcept -> bool {
+        return false;
+    }
+};
+
+} // namespace
+
+TEST_CASE("table_pool_no_allocation") {
+    using map_t = ankerl::unordered_dense::map<uint64_t,
+                                               uint64_t,
+                                               ankerl::unordered_dense::hash<uint64_t>,
+                                               std::equal_to<uint64_t>,
+                                               counting_allocator<std::pair<uint64_t, uint64_t>>>;
+    auto pool = ankerl::unordered_dense::table_pool<map_t>();
+    for (size_t request = 0; request < 100; ++request) {
+        auto const before = g_num_allocations;
+        auto map = pool.acquire();
+        REQUIRE(map.empty());
+        for (uint64_t i = 0; i < 1000; ++i) {
+            map[i] = request;
+        }
+        REQUIRE(map.at(999) == request);
+        pool.release(std::move(map));
+        REQUIRE(pool.size() == 1U);
+        if (request > 0) {
+            // the recycled map already has all the capacity it needs
+            REQUIRE(g_num_allocations == before);
+        }
+    }
+}
+
+TEST_CASE_MAP("table_pool", uint64_t, uint64_t) {
+    auto pool = ankerl::unordered_dense::table_pool<map_t>(2, 1024);
+    REQUIRE(pool.empty());
+    REQUIRE(pool.memory_usage() == 0U);
+
+    // maps without buckets, or with too many, are not kept
+    pool.release(map_t());
+    auto big = map_t();
+    for (uint64_t i = 0; i < 2000; ++i) {
+        big[i] = i;
+    }
+    pool.release(std::move(big));
+    REQUIRE(pool.empty());
+
+    auto small = pool.acquire();
+    small[1] = 1;
+    auto const small_buckets = small.bucket_count();
+    auto medium = pool.acquire(500);
+    REQUIRE(medium.bucket_count() >= 512U);
+    auto const medium_buckets = medium.bucket_count();
+    medium[1] = 1;
+    pool.release(std::move(small));
+    pool.release(std::move(medium));
+    REQUIRE(pool.size() == 2U);
+    REQUIRE(pool.memory_usage() > 0U);
+
+    // the smallest one that fits is handed out, cleared
+    auto a = pool.acquire(100);
+    REQUIRE(a.empty());
+    REQUIRE(a.bucket_count() == medium_buckets);
+    auto b = pool.acquire();
+    REQUIRE(b.empty());
+    REQUIRE(b.bucket_count() == small_buckets);
+    REQUIRE(pool.empty());
+    auto c = pool.acquire(10);
+    REQUIRE(c.size() == 0U);
+    c[2] = 3;
+    REQUIRE(c.at(2) == 3U);
+
+    // at most 2 per class
+    for (size_t i = 0; i < 4; ++i) {
+        auto m = pool.acquire();
+        m[1] = 2;
+        auto n = pool.acquire();
+        n[1] = 2;
+        auto o = map_t();
+        o[1] = 2;
+        pool.release(std::move(m));
+        pool.release(std::move(n));
+        pool.release(std::move(o));
+        REQUIRE(pool.size() == 2U);
+    }
+
+    pool.clear();
+    REQUIRE(pool.empty());
+}
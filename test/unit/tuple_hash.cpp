@@ -4,9 +4,45 @@
 
 #include <third-party/nanobench.h> // for Rng, doNotOptimizeAway, Bench
 
+#include <cstdint> // for uint16_t, uint32_t, uint64_t
+#include <numeric> // for gcd
 #include <string>
 #include <string_view>
 
+namespace {
+
+struct composite_key {
+    std::uint32_t a;
+    std::string b;
+    std::uint64_t c;
+
+    auto operator==(composite_key const& other) const -> bool {
+        return a == other.a && b == other.b && c == other.c;
+    }
+};
+
+// {1, 2} and {2, 4} are equal. Has a unique object representation, but must not be packed bytewise into the tuple's buffer.
+struct frac {
+    int num;
+    int den;
+
+    auto operator==(frac const& other) const -> bool {
+        return num * other.den == other.num * den;
+    }
+};
+
+} // namespace
+
+ANKERL_UNORDERED_DENSE_HASH_MEMBERS(composite_key, &composite_key::a, &composite_key::b, &composite_key::c);
+
+template <>
+struct ankerl::unordered_dense::hash<frac> {
+    auto operator()(frac const& f) const noexcept -> std::uint64_t {
+        auto const d = std::gcd(f.num, f.den);
+        return detail::hash_packed(f.num / d, f.den / d);
+    }
+};
+
 TEST_CASE("tuple_hash") {
     auto m = ankerl::unordered_dense::map<std::pair<int, std::string>, int>();
     auto pair_hash = ankerl::unordered_dense::hash<std::pair<int, std::string>>{};
@@ -45,6 +81,92 @@ TEST_CASE("tuple_hash_with_stringview") {
     REQUIRE(h1 != h2);
 }
 
+TEST_CASE("tuple_hash_packed") {
+    using T = std::tuple<std::uint32_t, std::uint16_t, std::uint64_t>;
+    auto const t = T{1, 2, 3};
+
+    // Trivially copyable members are packed into a 14 byte buffer and hashed in one go. The uint64_t spans two words, every
+    // bit of it has to make a difference.
+    auto const h = ankerl::unordered_dense::hash<T>{}(t);
+    auto hashes = ankerl::unordered_dense::set<uint64_t>();
+    REQUIRE(hashes.insert(h).second);
+    for (unsigned bit = 0; bit < 64; ++bit) {
+        auto t2 = t;
+        std::get<2>(t2) ^= std::uint64_t{1} << bit;
+        REQUIRE(hashes.insert(ankerl::unordered_dense::hash<T>{}(t2)).second);
+    }
+    for (unsigned bit = 0; bit < 16; ++bit) {
+        auto t2 = t;
+        std::get<1>(t2) = static_cast<std::uint16_t>(std::get<1>(t2) ^ (1U << bit));
+        REQUIRE(hashes.insert(ankerl::unordered_dense::hash<T>{}(t2)).second);
+    }
+
+    // pair and tuple of the same types hash the same
+    using P = std::pair<std::uint64_t, std::string>;
+    using U = std::tuple<std::uint64_t, std::string>;
+    REQUIRE(ankerl::unordered_dense::hash<P>{}(P{1, "x"}) == ankerl::unordered_dense::hash<U>{}(U{1, "x"}));
+}
+
+TEST_CASE("tuple_hash_not_packable") {
+    static_assert(!ankerl::unordered_dense::detail::is_packable_v<frac>);
+
+    // the tuple uses hash<frac>, which gives equal fractions the same hash
+    using T = std::tuple<int, frac>;
+    auto set = ankerl::unordered_dense::set<T>();
+    set.emplace(1, frac{1, 2});
+    set.emplace(1, frac{2, 4});
+    REQUIRE(set.size() == 1U);
+    REQUIRE(set.contains(T{1, frac{3, 6}}));
+}
+
+TEST_CASE("tuple_hash_members") {
+    auto map = ankerl::unordered_dense::map<composite_key, int>();
+    for (std::uint32_t i = 0; i < 1000; ++i) {
+        map.try_emplace(composite_key{i, std::to_string(i), i * 3U}, static_cast<int>(i));
+    }
+    REQUIRE(map.size() == 1000U);
+    REQUIRE(map.at(composite_key{12, "12", 36}) == 12);
+    REQUIRE_FALSE(map.contains(composite_key{12, "12", 37}));
+
+    auto const k = composite_key{1, "a", 2};
+    REQUIRE(ankerl::unordered_dense::hash<composite_key>{}(k) ==
+            ankerl::unordered_dense::hash<std::tuple<std::uint32_t, std::string, std::uint64_t>>{}({1, "a", 2}));
+    static_assert(ankerl::unordered_dense::detail::is_detected_v<ankerl::unordered_dense::detail::detect_avalanching,
+                                                                 ankerl::unordered_dense::hash<composite_key>>);
+}
+
+TEST_CASE("tuple_hash_transparent") {
+    using composite_t = std::pair<std::string, int>;
+    using hash_t = ankerl::unordered_dense::hash<composite_t>;
+
+    auto const h = hash_t();
+    auto const str = std::string("hello");
+    REQUIRE(h(composite_t{str, 1}) == h(std::pair<std::string_view, int>{str, 1}));
+    REQUIRE(h(composite_t{str, 1}) == h(std::tuple<std::string_view, int>{str, 1}));
+    REQUIRE(h(composite_t{str, 1}) == h(std::pair<char const*, int>{"hello", 1}));
+
+    // only elements that give the same hash are accepted
+    using ankerl::unordered_dense::detail::is_tuple_hash_compatible;
+    static_assert(is_tuple_hash_compatible<composite_t, std::pair<std::string_view, int>>::value);
+    static_assert(!is_tuple_hash_compatible<composite_t, std::pair<std::string_view, long>>::value);
+    static_assert(!is_tuple_hash_compatible<composite_t, std::tuple<std::string_view>>::value);
+    static_assert(!is_tuple_hash_compatible<composite_t, std::string>::value);
+
+    auto map = ankerl::unordered_dense::map<composite_t, int, hash_t, ankerl::unordered_dense::tuple_equal>();
+    for (int i = 0; i < 100; ++i) {
+        map.try_emplace(composite_t{std::to_string(i), i}, i);
+    }
+
+    // lookups without creating a std::string
+    auto const query = std::pair<std::string_view, int>{"42", 42};
+    REQUIRE(map.contains(query));
+    REQUIRE(map.find(query)->second == 42);
+    REQUIRE(map.count(std::tuple<std::string_view, int>{"42", 42}) == 1U);
+    REQUIRE_FALSE(map.contains(std::pair<std::string_view, int>{"42", 43}));
+    REQUIRE(map.erase(query) == 1U);
+    REQUIRE_FALSE(map.contains(query));
+}
+
 // #include <absl/hash/hash.h>
 
 TEST_CASE("bench_tuple_hash" * doctest::test_suite("bench") * doctest::skip()) {